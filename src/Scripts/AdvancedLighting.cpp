@@ -1,7 +1,6 @@
 #pragma region Includes
 
 #include <iostream>
-#include <random>
 
 #include "../../vendor/glad/include/glad.h"
 #include "../../vendor/glfw/include/GLFW/glfw3.h"
@@ -18,6 +17,23 @@
 #include "Model.h"
 #include "Shader.h"
 #include "Camera.h"
+#include "ShaderWatcher.h"
+#include "IBLCache.h"
+#include "IBLBaker.h"
+#include "EnvironmentLibrary.h"
+#include "ThreadPool.h"
+#include "SphericalHarmonics.h"
+#include "Frustum.h"
+#include "PointShadowCache.h"
+#include "AmbientOcclusion.h"
+#include "Bloom.h"
+#include "ToneMapping.h"
+#include "TemporalAA.h"
+#include "DynamicResolution.h"
+#include "GpuProfiler.h"
+#include "CpuProfiler.h"
+#include "CameraPath.h"
+#include "Benchmark.h"
 
 using namespace std;
 using namespace glm;
@@ -31,10 +47,12 @@ unsigned const int SCR_WIDTH = 1280;
 ///<summary>Screen Height in Screen Coordinates.</summary>
 unsigned const int SCR_HEIGHT = 720;
 
-///<summary>Shadow Width in Screen Coordinates.</summary>
-unsigned const int SHADOW_WIDTH  = 1024;
-///<summary>Shadow Height in Screen Coordinates.</summary>
-unsigned const int SHADOW_HEIGHT = 1024;
+///<summary>Shadow Cubemap Face Sizes Of The Shadow Atlas Tiers, Largest First (deferredLighting.fs Has One Sampler Per Tier).</summary>
+const std::vector<unsigned int> SHADOW_TIER_SIZES = { 1024, 512, 256 };
+///<summary>Memory Budget Of The Shadow Atlas in Bytes.</summary>
+const size_t SHADOW_ATLAS_BUDGET = 128 * 1024 * 1024;
+///<summary>Depth Format Of The Shadow Maps, GL_DEPTH_COMPONENT16 Fits Twice The Shadow Maps in The Budget At Lower Precision.</summary>
+unsigned const int SHADOW_DEPTH_FORMAT = GL_DEPTH_COMPONENT24;
 
 ///<summary>Number of Samples For Multisampling.</summary>
 unsigned const int SAMPLES = 4;
@@ -48,6 +66,10 @@ const float CAM_FAR_DIST = 100.0f;
 int bufferWidth;
 ///<summary>Buffer height of the window incase the Screen Height is not in Screen Coordinates.</summary>
 int bufferHeight;
+///<summary>Width The 3D Passes Render At, The Buffer Width Scaled By The Dynamic Resolution.</summary>
+int renderWidth;
+///<summary>Height The 3D Passes Render At, The Buffer Height Scaled By The Dynamic Resolution.</summary>
+int renderHeight;
 
 ///<summary>Tells Us If We Are in Full Screen Mode Or Not.</summary>
 bool fullScreen = false;
@@ -77,11 +99,36 @@ bool firstMouse = true;
 /// <summary>True if Camera Zoom Changed This Frame.</summary>
 bool camZoomDirty = false;
 
+///<summary>Worker Threads For CPU Side Work Like The Spherical Harmonics Projection.</summary>
+ThreadPool threadPool;
+
 ///<summary>The Time Elapsed Since Last Frame Was Rendered.</summary>
 float deltaTime = 0.0f;
 ///<summary>The Time At Which Last Frame Was Rendered.</summary>
 float lastFrame = 0.0f;
 
+///<summary>Compile Time Features Of The Deferred Lighting Shader, Bit i Of A Variant Mask Defines lightingFeatureNames[i].</summary>
+const vector<string> lightingFeatureNames = { "PBR", "PHYSICAL_ATTENUATION", "SSAO", "AO_MULTI_BOUNCE", "BENT_NORMALS", "SH_IRRADIANCE", "ENVIRONMENT_CROSSFADE", "TEMPORAL_SAMPLING",
+											  "LIGHT0_SHADOWS", "LIGHT0_SOFT_SHADOWS", "LIGHT0_FAST_SOFT_SHADOWS", "LIGHT0_ESM_SHADOWS", "LIGHT0_BLINN", "LIGHT0_DEBUG_SHADOW",
+											  "LIGHT1_SHADOWS", "LIGHT1_SOFT_SHADOWS", "LIGHT1_FAST_SOFT_SHADOWS", "LIGHT1_ESM_SHADOWS", "LIGHT1_BLINN", "LIGHT1_DEBUG_SHADOW" };
+///<summary>Lighting Feature Bits Shared By All Lights.</summary>
+unsigned const int LIGHTING_PBR = 1 << 0;
+unsigned const int LIGHTING_PHYSICAL_ATTENUATION = 1 << 1;
+unsigned const int LIGHTING_SSAO = 1 << 2;
+unsigned const int LIGHTING_AO_MULTI_BOUNCE = 1 << 3;
+unsigned const int LIGHTING_BENT_NORMALS = 1 << 4;
+unsigned const int LIGHTING_SH_IRRADIANCE = 1 << 5;
+unsigned const int LIGHTING_ENVIRONMENT_CROSSFADE = 1 << 6;
+unsigned const int LIGHTING_TEMPORAL_SAMPLING = 1 << 7;
+///<summary>Per Light Feature Bits Of Light 0, Shifted By (Light Index * LIGHTING_LIGHT_FEATURE_COUNT) For The Other Lights.</summary>
+unsigned const int LIGHTING_LIGHT_SHADOWS = 1 << 8;
+unsigned const int LIGHTING_LIGHT_SOFT_SHADOWS = 1 << 9;
+unsigned const int LIGHTING_LIGHT_FAST_SOFT_SHADOWS = 1 << 10;
+unsigned const int LIGHTING_LIGHT_ESM_SHADOWS = 1 << 11;
+unsigned const int LIGHTING_LIGHT_BLINN = 1 << 12;
+unsigned const int LIGHTING_LIGHT_DEBUG_SHADOW = 1 << 13;
+unsigned const int LIGHTING_LIGHT_FEATURE_COUNT = 6;
+
 //RenderQuad() VAO & VBO.
 unsigned int quadVAO = 0;
 unsigned int quadVBO;
@@ -91,37 +138,24 @@ unsigned int cubeVBO;
 
 //HDR Render Buffer
 unsigned int renderFBO;
-unsigned int finalColorBufferTexture[2];
+unsigned int finalColorBufferTexture;
 unsigned int finalRBO;
 
 //Geometry Buffer
 unsigned int gBuffer;
-unsigned int gPosition, gNormal, gAlbedo, gEmission, gMetallicRoughness;
-unsigned int gDepth;
+unsigned int gNormal, gAlbedoMetallic, gEmissionRoughness;
+unsigned int gDepth;	//Sampled To Reconstruct Positions, No Position Target.
 
 //PBR Image Based Lighting
-bool pbrInitialized = false;	//True if PBR has been Initialized atleast once.
-unsigned int envCubemap;		//Enivornment Cubemap Generated From Equirectangular Map(HDR Map).
-unsigned int irradianceMap;		//Irradiance Cubemap
-unsigned int prefilterMap;		//Prefilter Cubemap
 unsigned int brdfLUTTexture;	//2D LUT Generated from the BRDF equations.
-unsigned int captureFBO;		//PBR FBO
-unsigned int captureRBO;		//PBR RBO
-
-//Screen Space Ambient Occlusion Buffer.
-unsigned int ssaoFBO, ssaoBlurFBO;
-unsigned int ssaoGrayscaleBuffer, ssaoGrayscaleBlurBuffer;
+unsigned int environmentSHUBO;	//Uniform Buffer Of The Environment's SH Irradiance Coefficients (Binding 1, The Matrices Block Is On 0).
 
-//Bloom Ping-Pong Buffers
-unsigned int bloomFBO[2];
-unsigned int bloomTexture[2];
 
 #pragma endregion
 
 #pragma region Prototypes
 
 unsigned int LoadTexture(char const* path, bool sRGB = false);
-unsigned int LoadHDRTexture(char const* path);
 unsigned int LoadCubemap(vector<string> path);
 void Window_Resize_Callback(GLFWwindow* window, int width, int height);
 void ProcessMouseInput(GLFWwindow* window, double xpos, double ypos);
@@ -130,7 +164,9 @@ void ProcessInput(GLFWwindow* window);
 void UpdateAllFramebuffersSize(int bufferWidth, int bufferHeight);
 void RenderQuad();
 void RenderCube();
-void SetupPBR(unsigned int hdrTexture);
+void InitializePBR(IBLBaker& baker);
+void UploadEnvironmentSH(const SH9& radianceSH);
+unsigned int PointLightFeatures(unsigned int lightIndex, bool shadows, unsigned int shadowType, bool blinn, bool debugShadow);
 
 #pragma endregion
 
@@ -138,50 +174,84 @@ void SetupPBR(unsigned int hdrTexture);
 
 #pragma region Main
 
-int main()
+int main(int argc, char** argv)
 {
 
 	#pragma region Initialization
 
-	//Initialize GLFW
-	glfwInit();
+	//With --trace [Path], The CPU Markers & GPU Passes Are Written As A Chrome Trace On Exit.
+	//With --record-camera Path, The Camera's Poses Are Saved On Exit As A Path The Benchmark Can Follow.
+	string tracePath;
+	string recordCameraPath;
+	for (int i = 1; i < argc; i++)
+	{
+		if (string(argv[i]) == "--trace")
+			tracePath = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : PROJECT_DIR"/trace.json";
+		else if (string(argv[i]) == "--record-camera" && i + 1 < argc)
+			recordCameraPath = argv[++i];
+	}
 
-	//Set GLFW Parameters
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	//With --benchmark, A Fixed Number Of Frames Are Rendered Offscreen Along A Camera Path & Their Timings Written To JSON.
+	BenchmarkSettings benchmarkSettings;
+	if (!Benchmark::ParseArguments(argc, argv, benchmarkSettings))
+		return -1;
+	bool benchmarking = benchmarkSettings.enabled;
+	Benchmark benchmark(benchmarkSettings);
 
-	//Cache Primary Monitor
-	primaryMonitor = glfwGetPrimaryMonitor();
+	CpuProfiler::SetThreadName("Main");
+	CpuProfiler::Begin("Startup");
 
-	//Store Monitor Info In Video Mode.
-	videoMode = glfwGetVideoMode(primaryMonitor);
+	GLFWwindow* window = NULL;
+	GLADloadproc glLoader = (GLADloadproc)glfwGetProcAddress;
+	if (benchmarking)
+	{
+		//Offscreen Context Without A Window, Its Default Framebuffer Has The Benchmark's Resolution.
+		if (!benchmark.CreateContext())
+			return -1;
+		glLoader = Benchmark::Loader();
+	}
+	else
+	{
+		//Initialize GLFW
+		glfwInit();
 
-	//Set Bit Depths & Refresh Rate From Out Current Monitor's Info.
-	glfwWindowHint(GLFW_RED_BITS, videoMode->redBits);
-	glfwWindowHint(GLFW_GREEN_BITS, videoMode->greenBits);
-	glfwWindowHint(GLFW_BLUE_BITS, videoMode->blueBits);
-	glfwWindowHint(GLFW_REFRESH_RATE, videoMode->refreshRate);
+		//Set GLFW Parameters
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-	//Create OpenGL Window
-	GLFWwindow* window = glfwCreateWindow(fullScreen ? videoMode->width : SCR_WIDTH,
-		fullScreen ? videoMode->height : SCR_HEIGHT,
-		"PBR-Example", fullScreen ? primaryMonitor : NULL, NULL);
+		//Cache Primary Monitor
+		primaryMonitor = glfwGetPrimaryMonitor();
 
-	// Window NullCheck
-	if (!window)
-	{
-		cout << "Failed To Create OpenGL Window!";
-		glfwTerminate();
-		return -1;
-	}
+		//Store Monitor Info In Video Mode.
+		videoMode = glfwGetVideoMode(primaryMonitor);
+
+		//Set Bit Depths & Refresh Rate From Out Current Monitor's Info.
+		glfwWindowHint(GLFW_RED_BITS, videoMode->redBits);
+		glfwWindowHint(GLFW_GREEN_BITS, videoMode->greenBits);
+		glfwWindowHint(GLFW_BLUE_BITS, videoMode->blueBits);
+		glfwWindowHint(GLFW_REFRESH_RATE, videoMode->refreshRate);
+
+		//Create OpenGL Window
+		window = glfwCreateWindow(fullScreen ? videoMode->width : SCR_WIDTH,
+			fullScreen ? videoMode->height : SCR_HEIGHT,
+			"PBR-Example", fullScreen ? primaryMonitor : NULL, NULL);
 
-	//Make This Window The Current Context Of OpenGL
-	glfwMakeContextCurrent(window);
+		// Window NullCheck
+		if (!window)
+		{
+			cout << "Failed To Create OpenGL Window!";
+			glfwTerminate();
+			return -1;
+		}
+
+		//Make This Window The Current Context Of OpenGL
+		glfwMakeContextCurrent(window);
+	}
 
 	//Initialize GLAD
 	//Because We Can Call gl Functions Only After GLAD is Initialized!
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	if (!gladLoadGLLoader(glLoader))
 	{
 		// GLAD Failed Initialization.
 		cout << "Failed To Initialize GLAD!";
@@ -189,6 +259,21 @@ int main()
 		return -1;
 	}
 
+	//Destroys The Window Once main Returns, After Everything Declared Below, Whose Destructors Still Delete GL Objects Of Its Context.
+	//The Benchmark's Context Is Declared Above & Outlives Them Too.
+	struct WindowCleanup
+	{
+		GLFWwindow* window;
+		~WindowCleanup()
+		{
+			if (window != NULL)
+			{
+				glfwDestroyWindow(window);
+				glfwTerminate();
+			}
+		}
+	} windowCleanup = { window };
+
 	// Enable Depth Testing & Face Culling.
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_CULL_FACE);
@@ -202,12 +287,22 @@ int main()
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
 	//Get The FrameBufferSize
-	glfwGetFramebufferSize(window, &bufferWidth, &bufferHeight);
+	if (benchmarking)
+	{
+		bufferWidth = benchmarkSettings.width;
+		bufferHeight = benchmarkSettings.height;
+	}
+	else
+	{
+		glfwGetFramebufferSize(window, &bufferWidth, &bufferHeight);
 
-	//Set The FrameBufferResizeCallback
-	glfwSetFramebufferSizeCallback(window, Window_Resize_Callback);
-	glfwSetCursorPosCallback(window, ProcessMouseInput);
-	glfwSetScrollCallback(window, ProcessScrollInput);
+		//Set The FrameBufferResizeCallback
+		glfwSetFramebufferSizeCallback(window, Window_Resize_Callback);
+		glfwSetCursorPosCallback(window, ProcessMouseInput);
+		glfwSetScrollCallback(window, ProcessScrollInput);
+	}
+	renderWidth = bufferWidth;
+	renderHeight = bufferHeight;
 
 	//Call glViewport To Set Viewport Transform Or The General Area where OpenGL will Render!
 	glViewport(0, 0, bufferWidth, bufferHeight);
@@ -221,8 +316,10 @@ int main()
 	ImGui::StyleColorsDark();
 
 	// Setup Platform/Renderer backends
+	//The Benchmark Has No Platform Backend, It Sets The Display Size & Frame Time Itself.
 	const char* glsl_version = "#version 420";
-	ImGui_ImplGlfw_InitForOpenGL(window, true);
+	if (!benchmarking)
+		ImGui_ImplGlfw_InitForOpenGL(window, true);
 	ImGui_ImplOpenGL3_Init(glsl_version);
 
 	#pragma region Vertices Data
@@ -758,43 +855,8 @@ int main()
 
 	#pragma region Shadow Framebuffers
 
-	// Generate Shadow Cubemaps For both Point Lights.
-	unsigned int shadowCubemap[2];
-	glGenTextures(2, shadowCubemap);
-	for (unsigned int i = 0; i < 2; ++i)
-	{
-		glBindTexture(GL_TEXTURE_CUBE_MAP, shadowCubemap[i]);
-		for (unsigned int j = 0; j < 6; ++j)
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + j, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-	}
-	// Unbind to make sure we don't make any changes by Mistake.
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-
-	// Generate Shadow FBO.
-	unsigned int shadowFBO[2];
-	glGenFramebuffers(2, shadowFBO);
-	glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO[0]);
-	// attach first cubemap.
-	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowCubemap[0], 0);
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-		std::cout << "Shadow 1 Framebuffer not complete!" << std::endl;
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO[1]);
-	// attach second cubemap.
-	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowCubemap[1], 0);
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-		std::cout << "Shadow 2 Framebuffer not complete!" << std::endl;
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	// Shadow Cubemaps For both Point Lights in The Shadow Atlas, Each With A Cached Layer Of The Static Casters.
+	PointShadowCache shadowCache(2, SHADOW_TIER_SIZES, SHADOW_ATLAS_BUDGET, SHADOW_DEPTH_FORMAT);
 
 	#pragma endregion
 
@@ -803,63 +865,48 @@ int main()
 	glGenFramebuffers(1, &gBuffer);
 	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 
-	// position color buffer
-	glGenTextures(1, &gPosition);
-	glBindTexture(GL_TEXTURE_2D, gPosition);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, bufferWidth, bufferHeight, 0, GL_RGB, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-
-	// normal color buffer
+	// normal color buffer, octahedral encoded
 	glGenTextures(1, &gNormal);
 	glBindTexture(GL_TEXTURE_2D, gNormal);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, bufferWidth, bufferHeight, 0, GL_RGB, GL_FLOAT, NULL);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16, bufferWidth, bufferHeight, 0, GL_RG, GL_UNSIGNED_SHORT, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gNormal, 0);
 
-	// Albedo color buffer
-	glGenTextures(1, &gAlbedo);
-	glBindTexture(GL_TEXTURE_2D, gAlbedo);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, bufferWidth, bufferHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	// Albedo & Metallic color buffer, sRGB encoded on write while GL_FRAMEBUFFER_SRGB is enabled
+	glGenTextures(1, &gAlbedoMetallic);
+	glBindTexture(GL_TEXTURE_2D, gAlbedoMetallic);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, bufferWidth, bufferHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedo, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gAlbedoMetallic, 0);
 
-	// Emission color buffer
-	glGenTextures(1, &gEmission);
-	glBindTexture(GL_TEXTURE_2D, gEmission);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, bufferWidth, bufferHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	// Emission & Roughness color buffer, emission range compressed to 8 bits
+	glGenTextures(1, &gEmissionRoughness);
+	glBindTexture(GL_TEXTURE_2D, gEmissionRoughness);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, bufferWidth, bufferHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, gEmission, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gEmissionRoughness, 0);
+
+	unsigned int colorAttachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, colorAttachments);
 
-	// Metallic Roughness color buffer
-	glGenTextures(1, &gMetallicRoughness);
-	glBindTexture(GL_TEXTURE_2D, gMetallicRoughness);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG, bufferWidth, bufferHeight, 0, GL_RG, GL_UNSIGNED_BYTE, NULL);
+	// depth buffer, sampled by the lighting & SSAO passes to reconstruct positions
+	glGenTextures(1, &gDepth);
+	glBindTexture(GL_TEXTURE_2D, gDepth);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, bufferWidth, bufferHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT4, GL_TEXTURE_2D, gMetallicRoughness, 0);
-
-	unsigned int colorAttachments[5] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4 };
-	glDrawBuffers(5, colorAttachments);
-
-	glGenRenderbuffers(1, &gDepth);
-	glBindRenderbuffer(GL_RENDERBUFFER, gDepth);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, bufferWidth, bufferHeight);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, gDepth);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gDepth, 0);
 	// finally check if framebuffer is complete
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 		cout << "Geometry buffer not complete!" << endl;
@@ -867,81 +914,24 @@ int main()
 
 	#pragma endregion
 
-	#pragma region SSAO Framebuffer
-
-	glGenFramebuffers(1, &ssaoFBO);  
-	glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
-	// SSAO Grayscale Buffer
-	glGenTextures(1, &ssaoGrayscaleBuffer);
-	glBindTexture(GL_TEXTURE_2D, ssaoGrayscaleBuffer);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, bufferWidth, bufferHeight, 0, GL_RED, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ssaoGrayscaleBuffer, 0);
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-		cout << "SSAO Framebuffer not complete!" << endl;
-	
-	// SSAO Grayscale Blur Buffer
-	glGenFramebuffers(1, &ssaoBlurFBO);
-	glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
-	glGenTextures(1, &ssaoGrayscaleBlurBuffer);
-	glBindTexture(GL_TEXTURE_2D, ssaoGrayscaleBlurBuffer);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, bufferWidth, bufferHeight, 0, GL_RED, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ssaoGrayscaleBlurBuffer, 0);
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-		cout << "SSAO Blur Framebuffer not complete!" << endl;
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	#pragma endregion
-
-	#pragma region Bloom Framebuffer
-
-	//Generate Bloom FBO.
-	glGenFramebuffers(2, bloomFBO);
-	glGenTextures(2, bloomTexture);
-	for (unsigned int i = 0; i < 2; ++i)
-	{
-		glBindFramebuffer(GL_FRAMEBUFFER, bloomFBO[i]);
-		glBindTexture(GL_TEXTURE_2D, bloomTexture[i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, bufferWidth, bufferHeight, 0, GL_RGBA, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // we clamp to the edge as the blur filter would otherwise sample repeated texture values!
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, bloomTexture[i], 0);
-		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-			std::cout << "Bloom " + to_string(i) + " Framebuffer not complete!" << std::endl;
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	}
-
-	#pragma endregion
-
 	#pragma region Final Render HDR Framebuffer
 
 	glGenFramebuffers(1, &renderFBO);
 	glBindFramebuffer(GL_FRAMEBUFFER, renderFBO);
-	// generate texture		
-	glGenTextures(2, finalColorBufferTexture);
-	for (unsigned int i = 0; i < 2; i++)
-	{
-		glBindTexture(GL_TEXTURE_2D, finalColorBufferTexture[i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, bufferWidth, bufferHeight, 0, GL_RGBA, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		// attach it to currently bound framebuffer object
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, finalColorBufferTexture[i], 0);
-	}
-	// Tell openGL to render to both color attachments.
-	unsigned int drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-	glDrawBuffers(2, drawBuffers);
+	// generate texture, the bloom pass reads the bright parts straight from it.
+	glGenTextures(1, &finalColorBufferTexture);
+	glBindTexture(GL_TEXTURE_2D, finalColorBufferTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, bufferWidth, bufferHeight, 0, GL_RGBA, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// attach it to currently bound framebuffer object
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, finalColorBufferTexture, 0);
 
 	glGenRenderbuffers(1, &finalRBO);
 	glBindRenderbuffer(GL_RENDERBUFFER, finalRBO);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, bufferWidth, bufferHeight);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, bufferWidth, bufferHeight);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, finalRBO);
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 		std::cout << "Render Framebuffer not complete!" << std::endl;
@@ -982,104 +972,60 @@ int main()
 
 	#pragma endregion
 
-	#pragma region SSAO Sample Kernel & Noise Texture Generation
-
-	// generate sample kernel
-	// ----------------------
-	std::uniform_real_distribution<GLfloat> randomFloats(0.0, 1.0); // generates random floats between 0.0 and 1.0
-	std::default_random_engine generator;
-	std::vector<glm::vec3> ssaoKernel;
-	for (unsigned int i = 0; i < 16; ++i)
-	{
-		glm::vec3 sample(randomFloats(generator) * 2.0 - 1.0, randomFloats(generator) * 2.0 - 1.0, randomFloats(generator));
-		sample = glm::normalize(sample);
-		sample *= randomFloats(generator);
-		float scale = float(i) / 16.0f;
-
-		// scale samples s.t. they're more aligned to center of kernel
-		scale = 0.1f + scale * scale * (1.0f - 0.1f);
-		sample *= scale;
-		ssaoKernel.push_back(sample);
-	}
-
-	// generate noise texture
-	// ----------------------
-	std::vector<glm::vec3> ssaoNoise;
-	for (unsigned int i = 0; i < 16; i++)
-	{
-		glm::vec3 noise(randomFloats(generator) * 2.0 - 1.0, randomFloats(generator) * 2.0 - 1.0, 0.0f); // rotate around z-axis (in tangent space)
-		ssaoNoise.push_back(noise);
-	}
-	unsigned int noiseTexture; 
-	glGenTextures(1, &noiseTexture);
-	glBindTexture(GL_TEXTURE_2D, noiseTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, 4, 4, 0, GL_RGB, GL_FLOAT, &ssaoNoise[0]);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	#pragma endregion
-
-	//Create Shaders.
+	//Create Shaders. Compilation is only submitted here, so the driver can compile all programs in parallel while we read
+	//models & textures from disk. Programs are checked as the driver finishes them, or when they're first used.
+	Shader::BeginAsyncCompile(glLoader);
 	Shader deferredCubeShader(PROJECT_DIR"/src/Shaders/deferredCube.vs", PROJECT_DIR"/src/Shaders/deferredCube.fs");
-	Shader shadowShader(PROJECT_DIR"/src/Shaders/shadow.vs", PROJECT_DIR"/src/Shaders/shadow.gs", PROJECT_DIR"/src/Shaders/shadow.fs");
+	Shader shadowShader(PROJECT_DIR"/src/Shaders/shadow.vs", PROJECT_DIR"/src/Shaders/shadow.fs");
 	Shader originShader(PROJECT_DIR"/src/Shaders/origin.vs", PROJECT_DIR"/src/Shaders/origin.gs", PROJECT_DIR"/src/Shaders/origin.fs");
 	Shader deferredBedShader(PROJECT_DIR"/src/Shaders/deferredBed.vs", PROJECT_DIR"/src/Shaders/deferredBed.fs");
 	Shader deferredLightingShader(PROJECT_DIR"/src/Shaders/deferredLighting.vs", PROJECT_DIR"/src/Shaders/deferredLighting.fs");
 	Shader glassShader(PROJECT_DIR"/src/Shaders/glass.vs", PROJECT_DIR"/src/Shaders/glass.fs");
 	Shader normalShader(PROJECT_DIR"/src/Shaders/bed_normal.vs", PROJECT_DIR"/src/Shaders/bed_normal.gs", PROJECT_DIR"/src/Shaders/bed_normal.fs");
-	Shader ssaoShader(PROJECT_DIR"/src/Shaders/deferredLighting.vs", PROJECT_DIR"/src/Shaders/ssao.fs");
-	Shader ssaoBlurShader(PROJECT_DIR"/src/Shaders/deferredLighting.vs", PROJECT_DIR"/src/Shaders/ssaoBlur.fs");
-	Shader blurShader(PROJECT_DIR"/src/Shaders/blur.vs", PROJECT_DIR"/src/Shaders/blur.fs");
 	Shader ppShader(PROJECT_DIR"/src/Shaders/postProcessing.vs", PROJECT_DIR"/src/Shaders/postProcessing.fs");
 	Shader skyboxShader(PROJECT_DIR"/src/Shaders/skybox.vs", PROJECT_DIR"/src/Shaders/skybox.fs");
+	IBLBaker iblBaker(IBLBakeSettings(), PROJECT_DIR"/src/Assets/EnvironmentMaps/Cache", RenderCube, RenderQuad);
+	AmbientOcclusion ambientOcclusion(bufferWidth, bufferHeight, RenderQuad);
+	Bloom bloomPass(bufferWidth, bufferHeight, RenderQuad);
+	ToneMappingLUT toneMappingLUT;
+	TemporalAA temporalAA(bufferWidth, bufferHeight, RenderQuad);
+	DynamicResolution dynamicResolution(RenderQuad);
+	GpuProfiler gpuProfiler(benchmarking ? std::max(benchmarkSettings.frames, 240u) : 240);
 
 	//Load Models
 	Model bed(PROJECT_DIR"/src/Assets/Models/bed.gltf");
 	Model glass(PROJECT_DIR"/src/Assets/Models/glass.gltf");
+	Shader::PollAsyncCompile();
 
 	//Load Images As Texture.
 	stbi_set_flip_vertically_on_load(true);
 
-	// Load the HDR environment maps
-	unsigned int hdrTextures[7] = { LoadHDRTexture(PROJECT_DIR"/src/Assets/EnvironmentMaps/1.hdr"), LoadHDRTexture(PROJECT_DIR"/src/Assets/EnvironmentMaps/2.hdr"),
-									LoadHDRTexture(PROJECT_DIR"/src/Assets/EnvironmentMaps/3.hdr"), LoadHDRTexture(PROJECT_DIR"/src/Assets/EnvironmentMaps/4.hdr"),
-									LoadHDRTexture(PROJECT_DIR"/src/Assets/EnvironmentMaps/5.hdr"), LoadHDRTexture(PROJECT_DIR"/src/Assets/EnvironmentMaps/6.hdr"),
-									LoadHDRTexture(PROJECT_DIR"/src/Assets/EnvironmentMaps/7.hdr") };
+	//The HDR Environment Maps Are Decoded On The Thread Pool When Selected, Their Baked Maps Stay Resident Up To A Limit.
+	vector<string> hdrPaths;
+	for (int i = 1; i <= 7; i++)
+		hdrPaths.push_back(PROJECT_DIR"/src/Assets/EnvironmentMaps/" + to_string(i) + ".hdr");
+	int residentEnvironments = 3;
+	EnvironmentLibrary environments(hdrPaths, IBLBakeSettings(), threadPool, residentEnvironments);
 
 	unsigned int cubeDiffuseTexture = LoadTexture(PROJECT_DIR"/src/Assets/Textures/bricks2.jpg", true);
 	unsigned int cubeNormalTexture = LoadTexture(PROJECT_DIR"/src/Assets/Textures/bricks2_normal.png");
 	unsigned int cubeDisplacementTexture = LoadTexture(PROJECT_DIR"/src/Assets/Textures/bricks2_disp.png");
+	Shader::PollAsyncCompile();
 
-	//Use Shader To Set Uniforms.
-	deferredLightingShader.use();
-	deferredLightingShader.setInt("gPosition", 0);
-	deferredLightingShader.setInt("gNormal", 1);
-	deferredLightingShader.setInt("gAlbedo", 2);
-	deferredLightingShader.setInt("gEmission", 3);
-	deferredLightingShader.setInt("gMetallicRoughness", 4);
-	deferredLightingShader.setInt("pointLight[0].shadowMap", 5);
-	deferredLightingShader.setInt("pointLight[1].shadowMap", 6);
-	deferredLightingShader.setInt("ambientOcclusionMap", 7);
-	deferredLightingShader.setInt("irradianceMap", 8);
-	deferredLightingShader.setInt("prefilterMap", 9);
-	deferredLightingShader.setInt("brdfLUT", 10);
+	//Recompile Shaders When Their Source Files Change.
+	ShaderWatcher shaderWatcher(PROJECT_DIR"/src/Shaders");
+
+	//Shaders Built As Variants Of Compile Time Features, The Samplers Of These Use Fixed Bindings.
+	deferredLightingShader.SetFeatures(lightingFeatureNames);
+	deferredBedShader.SetFeatures(MaterialFeatureNames());
+	glassShader.SetFeatures(MaterialFeatureNames());
 
+	//Use Shader To Set Uniforms.
 	deferredCubeShader.use();
 	deferredCubeShader.setInt("diffuse", 0);
 	deferredCubeShader.setInt("normal", 1);
 	deferredCubeShader.setInt("displacement", 2);
 
-	ssaoShader.use();
-	ssaoShader.setInt("gPosition", 0);
-	ssaoShader.setInt("gNormal", 1);
-	ssaoShader.setInt("texNoise", 2);
-
-	ssaoBlurShader.use();
-	ssaoBlurShader.setInt("ssaoInput", 0);
-
 	normalShader.use();
 	normalShader.setUInt("showFaceNormal", 0);
 	normalShader.setUInt("showVertexNormal", 0);
@@ -1087,10 +1033,8 @@ int main()
 	ppShader.use();
 	ppShader.setInt("screenTexture", 0);
 	ppShader.setInt("blurTexture", 1);
+	ppShader.setInt("toneMappingLUT", 2);
 	
-	blurShader.use();
-	blurShader.setInt("brightnessTexture", 0);
-
 	//Material & Lighting Data.
 	float ambientStrength  = 0.2f;
 	float specularStrength = 0.3f;
@@ -1100,8 +1044,35 @@ int main()
 	int environment = 0;
 	int prevEnvironment = 0;	//For PBR IBL Framework Dirty Check.
 
-	//Setup PBR Workflow Based on The First Environment Map.
-	SetupPBR(hdrTextures[environment]);
+	//Diffuse IBL From The SH Coefficients Instead Of The Convolved Irradiance Cubemap.
+	bool shIrradiance = true;
+	float environmentRotation = 0.0f;	//Yaw Of The Environment In Degrees.
+	float environmentIntensity = 1.0f;
+
+	//Environment Switches Are Baked A Few Faces Per Frame, Lighting Keeps The Shown Environment Until The New One Is Done & Then Fades To It.
+	float iblBakeBudget = 2.0f;				//GPU Milliseconds Per Frame Spent On Baking.
+	float environmentFadeDuration = 0.5f;	//Seconds.
+	float environmentBlend = 1.0f;			//0 - Faded Environment, 1 - Shown Environment.
+	int shownEnvironment = environment;
+	int fadedEnvironment = environment;
+	int bakingEnvironment = environment;
+	//Environment Library Slots Of The Maps Of The Shown, Faded & Baking Environments.
+	int shownSlot = -1;
+	int fadedSlot = -1;
+	int bakingSlot = -1;
+	bool bakePending = false;	//True While The Selected Environment Waits For Its Source To Be Decoded Before Baking.
+	bool bakingWithIrradiance = false;
+
+	//Setup PBR Workflow Based on The First Environment Map, There's Nothing To Show Yet So It's Decoded & Baked At Once.
+	InitializePBR(iblBaker);
+	environments.Select(environment, true);
+	environments.WaitForSelected();
+	shownSlot = fadedSlot = environments.AcquireMaps(environment, -1, -1);
+	iblBaker.Start(environments.SourceTexture(environment), environments.Path(environment), environments.Maps(shownSlot), !shIrradiance);
+	iblBaker.Finish();
+	environments.FinishMaps(shownSlot, iblBaker.Target());
+	environments.ReleaseSource(environment);
+	UploadEnvironmentSH(environments.SH(environment));
 
 	//Only Initialize PBR IBL Workflow Again When its Dirty.
 	bool pbrDirty = false;
@@ -1135,8 +1106,10 @@ int main()
 	float oS    = 1.0f;
 	bool showOrigin = false;
 	bool bloom = true;
-	int bloomAmount = 1;
-	int bloomBlurMethod = 0;
+	float bloomThreshold = 2.0f;
+	float bloomKnee = 0.5f;
+	float bloomRadius = 1.0f;
+	float bloomIntensity = 1.0f;
 	bool showFaceNormal = false;
 	bool showVertexNormal = false;
 	bool showLightInfo = false;
@@ -1148,10 +1121,19 @@ int main()
 	float softShadowOffsetLight2 = 0.004f;
 	float fsoftShadowFactorLight1 = 800.0f;
 	float fsoftShadowFactorLight2 = 800.0f;
+	float esmExponentLight1 = 80.0f;
+	float esmExponentLight2 = 80.0f;
+	int shadowFacesPerFrame = 4;
+	float shadowFullRefreshDistance = 0.05f;
 	uint shadowTypeLight1 = 2;
 	uint shadowTypeLight2 = 2;
+	//Exponential Shadows & The Shadow Debug View Read The Filtered Maps At Units 16 - 18 (see deferredLighting.fs), GL 4.2 Only Guarantees 16.
+	GLint fragmentTextureUnits = 16;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &fragmentTextureUnits);
+	const bool filteredShadowsSupported = fragmentTextureUnits >= 16 + 3;
+	const int shadowTypeCount = filteredShadowsSupported ? 4 : 3;
 	uint toneMapping = 9;
-	const char* shadowTypes[] = { "Hard", "Soft", "Fast Soft" };
+	const char* shadowTypes[] = { "Hard", "Soft", "Fast Soft", "Exponential" };
 	static const char* current_shadowTypeL1 = "Fast Soft";
 	static const char* current_shadowTypeL2 = "Fast Soft";
 	const char* toneMappings[] = { "Exposure", "Reinhard", "Reinhard 2", "Filmic", "ACES Filmic", "Lottes", "Uchimura", "Uncharted 2", "Unreal", "NONE" };
@@ -1163,6 +1145,15 @@ int main()
 	float ssaoRadius = 0.064f;
 	float ssaoBias = 0.01f;
 	float ssaoStrength = 4.0f;
+	//Horizon Based (GTAO) Settings.
+	const char* ssaoMethods[] = { "Hemisphere", "Horizon (GTAO)" };
+	static const char* current_ssaoMethod = "Horizon (GTAO)";
+	float gtaoRadius = 0.1f;
+	float gtaoStrength = 1.5f;
+	int gtaoSlices = 2;
+	int gtaoSteps = 4;
+	bool gtaoMultiBounce = true;
+	bool gtaoBentNormals = true;
 
 	//PBR Metallic Roughness Factors.
 	float bedMetallic[8] = {0.0f, 0.0f, 0.5f, 0.7f, 1.0f, 0.0f, 0.0f, 0.0f };
@@ -1170,20 +1161,39 @@ int main()
 	float cubeMetallic = 0.5f;
 	float cubeRoughness = 0.5f;
 
+	//Anti-Aliasing In The Post Processing Pass (FXAA) Or Over The Jittered Frames Accumulated By TAA.
+	const char* antiAliasingMethods[] = { "None", "FXAA", "TAA" };
+	static const char* current_antiAliasing = "FXAA";
+
 	//FXAA uniforms
-	bool fxaaOn = true;
 	bool showEdges = false;
 	float lumaThreshold = 0.5f;
 	float mulReduceReciprocal = 8.0f;
 	float minReduceReciprocal = 128.0f;
 	float maxSpan = 8.0f;
 
+	//TAA Settings.
+	float taaFeedback = 0.9f;
+	bool taaWasOn = false;	//The History Is Dropped When TAA Is Turned On.
+
+	//Dynamic Resolution Settings, The Scale Either Follows The GPU Frame Time Or Stays Fixed.
+	bool dynamicResolutionOn = false;
+	float targetFrameTime = 16.6f;			//GPU Milliseconds Per Frame The Scale Aims For.
+	float minResolutionScale = 0.5f;
+	float resolutionScale = 1.0f;
+	float upscaleSharpness = 0.5f;
+
+	//Result Of The Last Trace Export, 0 Before The First.
+	int traceExported = 0;
+
 	//Create Shadow Projection * View Matrices for both Point Lights.
 	float near_plane[] = { 0.161f, 0.051f };
 	float far_plane[] = { 5.0f, 5.0f };
 
-	bool shadowMapDirty = true;
-	float prevShadowMapDirtyIdentifier = cT[0] + cT[1] + cT[2] + cR + cS[0] + cS[1] + cS[2] + near_plane[0] + near_plane[1] + far_plane[0] + far_plane[1];
+	//Shadow Caster Transforms, The Bed Is Drawn Into The Cached Static Layer & The Cube On Top Of It.
+	CasterTransform bedShadowTransform;
+	CasterTransform cubeShadowTransform;
+	unsigned int shadowProgram = shadowShader.ID;
 
 	//Perform Perspective Projection for our Projection Matrix.
 	mat4 projection = perspective(radians(camera.Zoom), (float)bufferWidth / (float)bufferHeight, CAM_NEAR_DIST, CAM_FAR_DIST);
@@ -1195,111 +1205,235 @@ int main()
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 	glBindBufferRange(GL_UNIFORM_BUFFER, 0, matricesUBO, 0, sizeof(mat4));	
 
+	//Frame Counter For The TAA Jitter & Temporal Sampling Patterns, The Unjittered View Projection Of The Last Frame Reprojects The TAA History.
+	unsigned int frameIndex = 0;
+	mat4 previousViewProjection = mat4(1.0f);
+
+	//The Benchmark's Camera Follows A Recorded Path, Or Orbits The Scene If None Is Given.
+	CameraPath benchmarkCameraPath = CameraPath::Orbit(vec3(0.0f, 0.4f, 0.0f), 2.0f, 0.6f, 10.0f);
+	string benchmarkCameraPathName = "Orbit";
+	if (benchmarking && !benchmarkSettings.cameraPath.empty())
+	{
+		if (!benchmarkCameraPath.Load(benchmarkSettings.cameraPath))
+		{
+			cout << "Failed To Load The Camera Path " << benchmarkSettings.cameraPath << endl;
+			return -1;
+		}
+		benchmarkCameraPathName = benchmarkSettings.cameraPath;
+	}
+	CameraPath recordedCameraPath;
+
+	//Check The Programs Nothing Has Used Yet, So Compile Errors Show Up Before The First Frame.
+	Shader::WaitForAsyncCompile();
+
+	CpuProfiler::End();
+
 	#pragma endregion
 
 	#pragma region Render Loop
 
-	while (!glfwWindowShouldClose(window))
+	while (benchmarking ? benchmark.Running() : !glfwWindowShouldClose(window))
 	{
-		//Calculate Delta Time.
-		float currentFrame = (float)glfwGetTime();
+		CpuProfiler::Begin("Frame");
+		if (benchmarking)
+			benchmark.BeginFrame();
+
+		//Calculate Delta Time, The Benchmark's Clock Advances By A Fixed Step.
+		float currentFrame = benchmarking ? benchmark.Time() : (float)glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
-		//To Make Sure Inputs Are Being Read.
-		glfwPollEvents();
-		//Process Input.
-		ProcessInput(window);
+		CpuProfiler::Begin("Input");
+		if (benchmarking)
+		{
+			//Follow The Camera Path Instead Of Input.
+			float zoom = camera.Zoom;
+			benchmarkCameraPath.Apply(currentFrame, camera);
+			camZoomDirty |= camera.Zoom != zoom;
+		}
+		else
+		{
+			//To Make Sure Inputs Are Being Read.
+			glfwPollEvents();
+			//Process Input.
+			ProcessInput(window);
+		}
+		if (!recordCameraPath.empty())
+			recordedCameraPath.Record(currentFrame, camera);
+		CpuProfiler::End();
+
+		CpuProfiler::Begin("Frame Setup");
+
+		//Hot Reload Edited Shaders, The Old Programs Stay In Use Until The New Ones Have Linked.
+		for (const std::string& changedShader : shaderWatcher.PollChanged())
+			Shader::ReloadShadersUsing(changedShader);
+		Shader::UpdatePendingReloads();
+
+		//Read Back The GPU Times Of Passes A Few Frames Ago & Start Timing This Frame's.
+		gpuProfiler.BeginFrame();
+
+		//Time The Frame On The GPU & Size The 3D Passes For It, The Targets Are Only Reallocated When The Scale Steps.
+		if (dynamicResolutionOn)
+			dynamicResolution.SetTarget(targetFrameTime, minResolutionScale);
+		else
+			dynamicResolution.SetFixedScale(resolutionScale);
+		dynamicResolution.Update(bufferWidth, bufferHeight);
+		dynamicResolution.BeginTiming();
+		if ((int)dynamicResolution.Width() != renderWidth || (int)dynamicResolution.Height() != renderHeight)
+		{
+			renderWidth = dynamicResolution.Width();
+			renderHeight = dynamicResolution.Height();
+			UpdateAllFramebuffersSize(renderWidth, renderHeight);
+		}
 
 		//A Common 4x4 Matrix Used By Different Meshes to Render Accordingly in World Space.
 		mat4 model = mat4(1.0f);
 
-		//Initialize PBR Workflow Again If its Enabled & Dirty.
+		//The Irradiance Cubemap Is Only Baked When It's Used.
+		if (!shIrradiance && !environments.Maps(shownSlot).hasIrradiance && !iblBaker.Busy() && !bakePending)	pbrDirty = true;
+
+		//Switch To The Selected Environment If PBR is Enabled & Dirty, Right Away If Its Maps Are Resident, Else Once It's Decoded & Baked.
 		if (pbrDirty && pbrEnabled)
 		{
-			SetupPBR(hdrTextures[environment]);
+			//Finish Any Cross Fade, So The Faded Environment's Maps Are Free To Be Reused.
+			if (environmentBlend < 1.0f)
+			{
+				environmentBlend = 1.0f;
+				UploadEnvironmentSH(environments.SH(shownEnvironment));
+			}
+			fadedSlot = shownSlot;
+
+			int residentSlot = environments.FindMaps(environment, !shIrradiance);
+			bool alreadyBaking = iblBaker.Busy() && bakingEnvironment == environment && (shIrradiance || bakingWithIrradiance);
+			bakePending = residentSlot < 0 && !alreadyBaking;
+			environments.Select(environment, bakePending);
+			if (residentSlot >= 0 && residentSlot != shownSlot)
+			{
+				fadedEnvironment = shownEnvironment;
+				shownEnvironment = environment;
+				shownSlot = residentSlot;
+				environmentBlend = 0.0f;
+			}
 			pbrDirty = false;
 		}
 
+		//Upload Decoded Environments & Start The Pending Bake Once Its Source Is Ready, The Shown Environment Stays Until The Bake Is Done.
+		environments.Update();
+		if (bakePending && environments.SourceReady(environment))
+		{
+			environments.ReleaseSourcesExcept(environment);
+			bakingSlot = environments.AcquireMaps(environment, shownSlot, fadedSlot);
+			iblBaker.Start(environments.SourceTexture(environment), environments.Path(environment), environments.Maps(bakingSlot), !shIrradiance);
+			bakingEnvironment = environment;
+			bakingWithIrradiance = !shIrradiance;
+			bakePending = false;
+		}
+
+		//Spread The Bake Over Frames & Cross Fade Once The Whole Prefilter Chain Is Done. The Source Isn't Needed Anymore Then.
+		//A Bake Of An Environment That Was Selected Away From In The Meantime Just Stays Resident.
+		//Updated Every Frame, Also While Idle, So Finished Bakes Are Written To The Cache Once Their Readback Is Done.
+		if (iblBaker.Update(iblBakeBudget))
+		{
+			environments.FinishMaps(bakingSlot, iblBaker.Target());
+			environments.ReleaseSource(bakingEnvironment);
+			if (bakingEnvironment == environment && !bakePending)
+			{
+				fadedSlot = shownSlot;
+				shownSlot = bakingSlot;
+				fadedEnvironment = shownEnvironment;
+				shownEnvironment = bakingEnvironment;
+				environmentBlend = 0.0f;
+			}
+		}
+		if (environmentBlend < 1.0f)
+		{
+			environmentBlend = std::min(1.0f, environmentBlend + deltaTime / environmentFadeDuration);
+			UploadEnvironmentSH(LerpSH9(environments.SH(fadedEnvironment), environments.SH(shownEnvironment), environmentBlend));
+		}
+		environments.Touch(shownSlot);
+		const IBLMaps& shownIBL = environments.Maps(shownSlot);
+		const IBLMaps& fadedIBL = environments.Maps(fadedSlot);
+		bool environmentFading = environmentBlend < 1.0f;
+
+		CpuProfiler::End();
+
 		#pragma region Draw Shadow Cubemaps
+
+		CpuProfiler::Begin("Shadows");
+		gpuProfiler.Begin("Shadows");
 		
-		if (shadowMapDirty)
+		//Model Matrices For Cube & Bed.
+		mat4 cubeModel = mat4(1.0f);
+		cubeModel = translate(cubeModel, vec3(cT[0], cT[1], cT[2]));
+		cubeModel = rotate(cubeModel, radians(cR), vec3(0.0f, 1.0f, 0.0f));
+		cubeModel = scale(cubeModel, vec3(cS[0], cS[1], cS[2]));
+		cubeShadowTransform.Set(cubeModel);
+
+		mat4 bedModel = mat4(1.0f);
+		bedModel = translate(bedModel, vec3(bT[0], bT[1], bT[2]));
+		bedModel = rotate(bedModel, radians(bR), vec3(0.0f, 1.0f, 0.0f));
+		bedModel = scale(bedModel, vec3(bS[0], bS[1], bS[2]));
+		bedShadowTransform.Set(bedModel);
+
+		//A Reloaded Shadow Shader Invalidates Every Light.
+		if (shadowShader.ID != shadowProgram)
 		{
-			glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-			glDisable(GL_CULL_FACE);
+			shadowProgram = shadowShader.ID;
+			shadowCache.InvalidateAll();
+		}
 
-			for (unsigned int i = 0; i < 2; ++i)
+		//Only The Lights Reached By What Changed Are Re-rendered.
+		AABB cubeBounds = AABB(vec3(-0.5f), vec3(0.5f)).Transformed(cubeModel);
+		shadowCache.SetLight(0, make_vec3(l1P), near_plane[0], far_plane[0]);
+		shadowCache.SetLight(1, make_vec3(l2P), near_plane[1], far_plane[1]);
+		shadowCache.SetCasters(bedShadowTransform.Version(), bed.Bounds(bedModel), cubeShadowTransform.Version(), cubeBounds);
+		//Moving Lights Update A Few Faces Per Frame, Large Moves Refresh The Whole Cubemap.
+		shadowCache.SetTimeSlicing(shadowFacesPerFrame, shadowFullRefreshDistance);
+		//Exponential Shadows & The Shadow Debug View Read The Prefiltered Maps.
+		shadowCache.SetFiltered(0, shadowTypeLight1 == 3 || debugShadowForLight1, esmExponentLight1);
+		shadowCache.SetFiltered(1, shadowTypeLight2 == 3 || debugShadowForLight2, esmExponentLight2);
+		//Shadow Resolution Of Each Light Follows Its Size On Screen.
+		shadowCache.SetView(projection * camera.GetViewMatrix(), camera.Position, tan(radians(camera.Zoom) * 0.5f), (float)renderHeight);
+
+		glDisable(GL_CULL_FACE);
+		shadowCache.Update(shadowShader,
+			[&](const Frustum& frustum)
+			{
+				//Draw Bed Meshes From The Current Point Light Position.
+				return bed.SimpleDraw(shadowShader, bedModel, frustum);
+			},
+			[&](const Frustum& frustum)
 			{
-				//Bind The Correct Framebuffer.
-				glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO[i]);
-
-				//Clear Depth Buffer Before Rendering.
-				glClear(GL_DEPTH_BUFFER_BIT);
-
-				//Bind The Correct Cubemap.
-				glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowCubemap[i], 0);
-
-				//Set Shadow Projection * View Matrices for both Point Lights.
-				mat4 shadowProjection = perspective(glm::radians(90.0f), (float)SHADOW_WIDTH / (float)SHADOW_HEIGHT, near_plane[i], far_plane[i]);
-				vector<mat4> shadowTransforms;
-				vec3 lightPos = i == 0 ? make_vec3(l1P) : make_vec3(l2P);
-				shadowTransforms.push_back(shadowProjection * lookAt(lightPos, lightPos + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-				shadowTransforms.push_back(shadowProjection * lookAt(lightPos, lightPos + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-				shadowTransforms.push_back(shadowProjection * lookAt(lightPos, lightPos + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
-				shadowTransforms.push_back(shadowProjection * lookAt(lightPos, lightPos + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)));
-				shadowTransforms.push_back(shadowProjection * lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-				shadowTransforms.push_back(shadowProjection * lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f)));
-
-				//Generate Shadow Cubemap For Current Point Light.
-				shadowShader.use();
-				for (unsigned int j = 0; j < 6; ++j)
-					shadowShader.setMat4("shadowMatrices[" + std::to_string(j) + "]", shadowTransforms[j]);
-				shadowShader.setFloat("far_plane", far_plane[i]);
-				shadowShader.setVector3("lightPos", lightPos);
-
-				//Model Matrix For Cube.
-				glBindVertexArray(VAO[2]);
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, cubeDiffuseTexture);
-				//Model Matrix.
-				model = mat4(1.0f);
-				model = translate(model, vec3(cT[0], cT[1], cT[2]));
-				model = rotate(model, radians(cR), vec3(0.0f, 1.0f, 0.0f));
-				model = scale(model, vec3(cS[0], cS[1], cS[2]));
-				//Send The Model Matrix To The Shadow Shader.
-				shadowShader.setMat4("model", model);
 				//Draw Cube From The Current Point Light Position.
+				if (!frustum.Intersects(cubeBounds))
+					return 0u;
+				glBindVertexArray(VAO[0]);
+				shadowShader.setMat4("model", cubeModel);
 				glDrawArrays(GL_TRIANGLES, 0, 36);
+				return 1u;
+			});
+		glEnable(GL_CULL_FACE);
+		glBindVertexArray(0);
 
-				//Model Matrix For Bed.
-				model = mat4(1.0f);
-				model = translate(model, vec3(bT[0], bT[1], bT[2]));
-				model = rotate(model, radians(bR), vec3(0.0f, 1.0f, 0.0f));
-				model = scale(model, vec3(bS[0], bS[1], bS[2]));
-
-				//Draw Bed From The Current Point Light Position.
-				bed.SimpleDraw(shadowShader, model);
-			}
-
-			glEnable(GL_CULL_FACE);
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, 0);
-			glBindVertexArray(0);
-			glViewport(0, 0, bufferWidth, bufferHeight);
-
-			shadowMapDirty = false;
-		}
+		gpuProfiler.End();
+		CpuProfiler::End();
 
 		#pragma endregion
 
 		#pragma region Deferred Rendering - Geometry Pass
 
+		CpuProfiler::Begin("Geometry");
+		gpuProfiler.Begin("Geometry");
+
 		//Disable Blending.
 		glDisable(GL_BLEND);
 
 		// Bind gBuffer as Current Framebuffer & Draw all The Geomtry & Fill The Samplers.
 		glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+		glViewport(0, 0, renderWidth, renderHeight);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		//Albedo Is Written To An sRGB Target, Encoded On Write & Decoded On Read.
+		glEnable(GL_FRAMEBUFFER_SRGB);
 		//Get Camera View Matrix.
 		mat4 view = camera.GetViewMatrix();
 
@@ -1310,8 +1444,18 @@ int main()
 			camZoomDirty = false;
 		}
 
+		//TAA Jitters The Projection By A Sub-Pixel Offset Every Frame, Everything Rasterized Uses The Jittered Projection.
+		bool fxaaOn = current_antiAliasing == antiAliasingMethods[1];
+		bool taaOn = current_antiAliasing == antiAliasingMethods[2];
+		if (taaOn && !taaWasOn)
+			temporalAA.Reset();
+		taaWasOn = taaOn;
+		camera.SetJitter(frameIndex, taaOn);
+		mat4 renderProjection = camera.GetJitteredProjection(projection, (float)renderWidth, (float)renderHeight);
+
 		//This Matrix Stores The Combined Effort Of Clipping To Camera & Perspective Projection.
-		mat4 viewProjection = projection * view;
+		mat4 viewProjection = renderProjection * view;
+		mat4 unjitteredViewProjection = projection * view;
 
 		//Set Data for UBO.
 		glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
@@ -1326,13 +1470,12 @@ int main()
 		model = rotate(model, radians(bR), vec3(0.0f, 1.0f, 0.0f));
 		model = scale(model, vec3(bS[0], bS[1], bS[2]));
 		glFrontFace(GL_CW);
-		deferredBedShader.use();
-		deferredBedShader.setFloat("material.emissionStrength", emissionStrength);
-		//Change The Metallic & Roughness Factors Accordingly.
+		//Change The Metallic, Roughness & Emission Factors Accordingly.
 		for (int i = 0; i < 8; i++)
 		{
 			bed.meshes[i].material.metallicFactor = bedMetallic[i];
 			bed.meshes[i].material.roughnessFactor = bedRoughness[i];
+			bed.meshes[i].material.emissionStrength = emissionStrength;
 		}
 		bed.Draw(deferredBedShader, model);
 		glFrontFace(GL_CCW);
@@ -1372,158 +1515,169 @@ int main()
 
 		#pragma endregion
 
+		glDisable(GL_FRAMEBUFFER_SRGB);
+
+		gpuProfiler.End();
+		CpuProfiler::End();
+
 		#pragma endregion
 
 		#pragma region SSAO Pass
 
+		bool horizonSSAO = current_ssaoMethod == ssaoMethods[1];
 		if (ssao)
 		{
-			//Calculate SSAO.
-			glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
-			glClear(GL_COLOR_BUFFER_BIT);
-
-			ssaoShader.use();
-			// Send kernel + rotation 
-			for (unsigned int i = 0; i < 16; ++i)
-				ssaoShader.setVector3("samples[" + std::to_string(i) + "]", ssaoKernel[i]);
-			ssaoShader.setMat4("view", view);
-			ssaoShader.setMat4("projection", projection);
-			ssaoShader.setFloat("radius", ssaoRadius);
-			ssaoShader.setFloat("bias", ssaoBias);
-			ssaoShader.setFloat("strength", ssaoStrength);
-			ssaoShader.setVector2("noiseScale", vec2(bufferWidth, bufferHeight) * 0.25f);
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, gPosition);
-			glActiveTexture(GL_TEXTURE1);
-			glBindTexture(GL_TEXTURE_2D, gNormal);
-			glActiveTexture(GL_TEXTURE2);
-			glBindTexture(GL_TEXTURE_2D, noiseTexture);
-			RenderQuad();
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-			// Blur SSAO texture to remove noise
-			glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
-			glClear(GL_COLOR_BUFFER_BIT);
-			ssaoBlurShader.use();
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, ssaoGrayscaleBuffer);
-			RenderQuad();
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			//Half Resolution SSAO, Upsampled in The Lighting Pass.
+			ambientOcclusion.Resize(renderWidth, renderHeight);
+			ambientOcclusion.SetMethod(horizonSSAO ? AmbientOcclusion::Method::Horizon : AmbientOcclusion::Method::Hemisphere, gtaoSlices, gtaoSteps, gtaoBentNormals);
+			//With TAA The Sampling Pattern Moves On Every Frame & Fewer Samples Are Taken, The History Averages Them.
+			ambientOcclusion.SetTemporal(taaOn, frameIndex);
+			CpuProfiler::Begin("SSAO");
+			gpuProfiler.Begin("SSAO");
+			ambientOcclusion.Render(gDepth, gNormal, view, renderProjection, horizonSSAO ? gtaoRadius : ssaoRadius, ssaoBias, horizonSSAO ? gtaoStrength : ssaoStrength);
+			gpuProfiler.End();
+			CpuProfiler::End();
 		}
 
 		#pragma endregion
 
 		#pragma region Deferred Rendering - Lighting Pass
 
+		CpuProfiler::Begin("Lighting");
+		gpuProfiler.Begin("Lighting");
+
 		//Calculate Lighting Result Of gBuffer in HDR Render Buffer & Extract Fragment & Brightness Color.
 		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, renderFBO);
 
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		deferredLightingShader.use();
+		//Rotating The Lookup Direction Rotates The Environment, So Neither The Cubemaps Nor The SH Need Updating.
+		mat3 environmentRotationMatrix = mat3(rotate(mat4(1.0f), radians(environmentRotation), vec3(0.0f, 1.0f, 0.0f)));
+
+		//Select The Lighting Variant Matching The Current Settings.
+		//SH Irradiance Is Also Used While A Needed Irradiance Cubemap Isn't Baked Yet.
+		bool useSHIrradiance = shIrradiance || !shownIBL.hasIrradiance || (environmentFading && !fadedIBL.hasIrradiance);
+		unsigned int lightingFeatures = (pbrEnabled ? LIGHTING_PBR : 0) | (physicallyCorrectAttenuation ? LIGHTING_PHYSICAL_ATTENUATION : 0) | (ssao ? LIGHTING_SSAO : 0) |
+										(useSHIrradiance ? LIGHTING_SH_IRRADIANCE : 0) | (environmentFading ? LIGHTING_ENVIRONMENT_CROSSFADE : 0) |
+										(taaOn ? LIGHTING_TEMPORAL_SAMPLING : 0);
+		//Multi Bounce & Bent Normals Only Come With The Horizon Based SSAO.
+		if (ssao && horizonSSAO)
+			lightingFeatures |= (gtaoMultiBounce ? LIGHTING_AO_MULTI_BOUNCE : 0) | (gtaoBentNormals ? LIGHTING_BENT_NORMALS : 0);
+		lightingFeatures |= PointLightFeatures(0, shadowForLight1, shadowTypeLight1, l1b, debugShadowForLight1);
+		lightingFeatures |= PointLightFeatures(1, shadowForLight2, shadowTypeLight2, l2b, debugShadowForLight2);
+		Shader& lightingShader = deferredLightingShader.Variant(lightingFeatures);
+		lightingShader.use();
 
 		#pragma region Set Lighting Uniforms
 
-		deferredLightingShader.setVector3("pointLight[0].position", l1P[0], l1P[1], l1P[2]);		
-		deferredLightingShader.setVector3("pointLight[0].color",    l1C[0], l1C[1], l1C[2]);
-		deferredLightingShader.setFloat("pointLight[0].intensity", l1I);
-		deferredLightingShader.setInt("pointLight[0].blinn",        l1b);
-
-		deferredLightingShader.setVector3("pointLight[1].position",  l2P[0], l2P[1], l2P[2]);
-		deferredLightingShader.setVector3("pointLight[1].color",     l2C[0], l2C[1], l2C[2]);
-		deferredLightingShader.setFloat("pointLight[1].intensity", l2I);
-		deferredLightingShader.setInt    ("pointLight[1].blinn",     l2b);
-
-		deferredLightingShader.setInt    ("pointLight[0].shadows", shadowForLight1);
-		deferredLightingShader.setInt    ("pointLight[1].shadows", shadowForLight2);
-		deferredLightingShader.setInt	("pointLight[0].debugShadow", debugShadowForLight1);
-		deferredLightingShader.setInt	("pointLight[1].debugShadow", debugShadowForLight2);
-		deferredLightingShader.setUInt   ("pointLight[0].shadowType", shadowTypeLight1);
-		deferredLightingShader.setUInt   ("pointLight[1].shadowType", shadowTypeLight2);
-		deferredLightingShader.setFloat  ("pointLight[0].softShadowOffset", softShadowOffsetLight1);
-		deferredLightingShader.setFloat  ("pointLight[1].softShadowOffset", softShadowOffsetLight2);
-		deferredLightingShader.setFloat  ("pointLight[0].fsoftShadowFactor", fsoftShadowFactorLight1);
-		deferredLightingShader.setFloat  ("pointLight[1].fsoftShadowFactor", fsoftShadowFactorLight2);
-		deferredLightingShader.setFloat  ("pointLight[0].shadowFarPlane", far_plane[0]);
-		deferredLightingShader.setFloat  ("pointLight[1].shadowFarPlane", far_plane[1]);
-
-		deferredLightingShader.setFloat("pointLight[0].linear",    l1l);
-		deferredLightingShader.setFloat("pointLight[1].linear",    l2l);
-		deferredLightingShader.setFloat("pointLight[0].quadratic", l1q);
-		deferredLightingShader.setFloat("pointLight[1].quadratic", l2q);
-
-		deferredLightingShader.setVector3("viewPos", camera.Position);
-		deferredLightingShader.setInt("ssaoEnabled", ssao);
-		deferredLightingShader.setFloat("ambientStrength", ambientStrength);
-		deferredLightingShader.setFloat("specularStrength", specularStrength);
-
-		deferredLightingShader.setInt("pbrEnabled", pbrEnabled);
-		deferredLightingShader.setInt("physicallyCorrectAttenuation", physicallyCorrectAttenuation);
+		CpuProfiler::Begin("Lighting Uniforms");
+
+		lightingShader.setVector3("pointLight[0].position", l1P[0], l1P[1], l1P[2]);		
+		lightingShader.setVector3("pointLight[0].color",    l1C[0], l1C[1], l1C[2]);
+		lightingShader.setFloat("pointLight[0].intensity", l1I);
+
+		lightingShader.setVector3("pointLight[1].position",  l2P[0], l2P[1], l2P[2]);
+		lightingShader.setVector3("pointLight[1].color",     l2C[0], l2C[1], l2C[2]);
+		lightingShader.setFloat("pointLight[1].intensity", l2I);
+
+		lightingShader.setFloat  ("pointLight[0].softShadowOffset", softShadowOffsetLight1);
+		lightingShader.setFloat  ("pointLight[1].softShadowOffset", softShadowOffsetLight2);
+		lightingShader.setFloat  ("pointLight[0].fsoftShadowFactor", fsoftShadowFactorLight1);
+		lightingShader.setFloat  ("pointLight[1].fsoftShadowFactor", fsoftShadowFactorLight2);
+		lightingShader.setFloat  ("pointLight[0].shadowNearPlane", near_plane[0]);
+		lightingShader.setFloat  ("pointLight[1].shadowNearPlane", near_plane[1]);
+		lightingShader.setFloat  ("pointLight[0].shadowFarPlane", far_plane[0]);
+		lightingShader.setFloat  ("pointLight[1].shadowFarPlane", far_plane[1]);
+		lightingShader.setFloat  ("pointLight[0].esmExponent", esmExponentLight1);
+		lightingShader.setFloat  ("pointLight[1].esmExponent", esmExponentLight2);
+		lightingShader.setInt    ("pointLight[0].shadowTier", shadowCache.ShadowTier(0));
+		lightingShader.setInt    ("pointLight[1].shadowTier", shadowCache.ShadowTier(1));
+		lightingShader.setInt    ("pointLight[0].shadowLayer", shadowCache.ShadowLayer(0));
+		lightingShader.setInt    ("pointLight[1].shadowLayer", shadowCache.ShadowLayer(1));
+
+		lightingShader.setFloat("pointLight[0].linear",    l1l);
+		lightingShader.setFloat("pointLight[1].linear",    l2l);
+		lightingShader.setFloat("pointLight[0].quadratic", l1q);
+		lightingShader.setFloat("pointLight[1].quadratic", l2q);
+
+		lightingShader.setVector3("viewPos", camera.Position);
+		lightingShader.setMat4("inverseViewProjection", inverse(viewProjection));
+		lightingShader.setVector2("projectionDepth", projection[2][2], projection[3][2]);
+		lightingShader.setFloat("ambientStrength", ambientStrength);
+		lightingShader.setFloat("specularStrength", specularStrength);
+		lightingShader.setMat3("environmentRotation", environmentRotationMatrix);
+		lightingShader.setFloat("environmentIntensity", environmentIntensity);
+		lightingShader.setFloat("environmentBlend", environmentBlend);
+		lightingShader.setInt("frameIndex", frameIndex % 64);
+
+		CpuProfiler::End();
 
 		#pragma endregion
 
 		#pragma region Bind Textures
 
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, gPosition);
+		glBindTexture(GL_TEXTURE_2D, gDepth);
 		glActiveTexture(GL_TEXTURE1);
 		glBindTexture(GL_TEXTURE_2D, gNormal);
 		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, gAlbedo);
+		glBindTexture(GL_TEXTURE_2D, gAlbedoMetallic);
 		glActiveTexture(GL_TEXTURE3);
-		glBindTexture(GL_TEXTURE_2D, gEmission);
+		glBindTexture(GL_TEXTURE_2D, gEmissionRoughness);
 		glActiveTexture(GL_TEXTURE4);
-		glBindTexture(GL_TEXTURE_2D, gMetallicRoughness);
-		glActiveTexture(GL_TEXTURE5);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, shadowCubemap[0]);
-		glActiveTexture(GL_TEXTURE6);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, shadowCubemap[1]);
+		glBindTexture(GL_TEXTURE_2D, ambientOcclusion.BentNormalTexture());
 		glActiveTexture(GL_TEXTURE7);
-		glBindTexture(GL_TEXTURE_2D, ssaoGrayscaleBlurBuffer);
+		glBindTexture(GL_TEXTURE_2D, ambientOcclusion.Texture());
 		glActiveTexture(GL_TEXTURE8);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, shownIBL.irradianceMap);
 		glActiveTexture(GL_TEXTURE9);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, shownIBL.prefilterMap);
 		glActiveTexture(GL_TEXTURE10);
 		glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+		glActiveTexture(GL_TEXTURE11);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, fadedIBL.irradianceMap);
+		glActiveTexture(GL_TEXTURE12);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, fadedIBL.prefilterMap);
+		for (unsigned int tier = 0; tier < shadowCache.Atlas().TierCount(); tier++)
+		{
+			glActiveTexture(GL_TEXTURE13 + tier);
+			glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadowCache.Atlas().Texture(tier));
+			if (filteredShadowsSupported)
+			{
+				glActiveTexture(GL_TEXTURE16 + tier);
+				glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadowCache.Atlas().FilteredTexture(tier));
+			}
+		}
 
 		#pragma endregion
 
 		RenderQuad();
 
+		gpuProfiler.End();
+		CpuProfiler::End();
+
 		#pragma endregion
 
 		#pragma region Bloom Pass
 
-		bool horizontal = true;
 		if (bloom)
 		{
-			//Copy The Brightness Texture From renderFBO to bloomFBO.
-			glBindFramebuffer(GL_READ_FRAMEBUFFER, renderFBO);
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, bloomFBO[0]);
-
-			glReadBuffer(GL_COLOR_ATTACHMENT1);
-			glDrawBuffer(GL_COLOR_ATTACHMENT0);
-			glBlitFramebuffer(0, 0, bufferWidth, bufferHeight, 0, 0, bufferWidth, bufferHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-
-			blurShader.use();
-			blurShader.setInt("blurMethod", bloomBlurMethod);
-			for (int i = 0; i < 2 * bloomAmount; ++i)
-			{
-				//Bind Bloom FBO for Further Blurring of Brightness Texture.
-				glBindFramebuffer(GL_FRAMEBUFFER, bloomFBO[horizontal]);
-				blurShader.setInt("horizontal", horizontal);
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, bloomTexture[!horizontal]);
-				RenderQuad();
-				horizontal = !horizontal;
-			}
+			//Blur The Bright Parts Of The Lit Image Over Its Mip Chain.
+			bloomPass.Resize(renderWidth, renderHeight);
+			CpuProfiler::Begin("Bloom");
+			gpuProfiler.Begin("Bloom");
+			bloomPass.Render(finalColorBufferTexture, bloomThreshold, bloomKnee, bloomRadius);
+			gpuProfiler.End();
+			CpuProfiler::End();
 		}
 
 		#pragma endregion
 
 		#pragma region HDR Render/Transparency Pass
 
+		CpuProfiler::Begin("Transparency");
+		gpuProfiler.Begin("Transparency");
+
 		//Copy The Depth Buffer From gBuffer To HDR Render Buffer.
 		glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
 		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, renderFBO);
@@ -1531,7 +1685,7 @@ int main()
 		//Copy Depth.
 		glReadBuffer(GL_DEPTH_ATTACHMENT);
 		glDrawBuffer(GL_DEPTH_ATTACHMENT);
-		glBlitFramebuffer(0, 0, bufferWidth, bufferHeight, 0, 0, bufferWidth, bufferHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, renderWidth, renderHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 
 		//Draw with RenderFBO.
 		glBindFramebuffer(GL_FRAMEBUFFER, renderFBO);
@@ -1548,7 +1702,7 @@ int main()
 			model = scale(model, vec3(bS[0], bS[1], bS[2]));
 			normalShader.use();
 			normalShader.setMat4("view", view);
-			normalShader.setMat4("projection", projection);
+			normalShader.setMat4("projection", renderProjection);
 			normalShader.setUInt("showFaceNormal", showFaceNormal);
 			normalShader.setUInt("showVertexNormal", showVertexNormal);
 			bed.SimpleDraw(normalShader, model);
@@ -1564,7 +1718,7 @@ int main()
 			originShader.setMat4("view", view);
 			model = mat4(1.0f);
 			originShader.setMat4("originModel", model);
-			originShader.setMat4("projection", projection);
+			originShader.setMat4("projection", renderProjection);
 
 			//Bind Origin VAO.
 			glBindVertexArray(VAO[1]);
@@ -1597,11 +1751,16 @@ int main()
 		#pragma region Draw Skybox
 
 		glDepthFunc(GL_LEQUAL);
-		mat4 skyViewProjection = projection * mat4(mat3(view));
+		mat4 skyViewProjection = renderProjection * mat4(mat3(view));
 		skyboxShader.use();
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, shownIBL.envCubemap);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, fadedIBL.envCubemap);
 		skyboxShader.setMat4("viewProjection", skyViewProjection);
+		skyboxShader.setFloat("environmentBlend", environmentBlend);
+		skyboxShader.setMat3("environmentRotation", environmentRotationMatrix);
+		skyboxShader.setFloat("environmentIntensity", environmentIntensity);
 		RenderCube();
 		glDepthFunc(GL_LESS);
 
@@ -1618,7 +1777,6 @@ int main()
 		model = rotate(model, radians(bR), vec3(0.0f, 1.0f, 0.0f));
 		model = scale(model, vec3(bS[0], bS[1], bS[2]));
 		glFrontFace(GL_CW);
-		glassShader.use();
 		glass.Draw(glassShader, model);
 		glFrontFace(GL_CCW);
 
@@ -1627,25 +1785,55 @@ int main()
 
 		#pragma endregion
 
+		gpuProfiler.End();
+		CpuProfiler::End();
+
+		#pragma endregion
+
+		#pragma region Temporal Anti-Aliasing Pass
+
+		if (taaOn)
+		{
+			//Blend The Jittered Frame Into The History Reprojected By The Camera Motion Since The Last Frame.
+			temporalAA.Resize(renderWidth, renderHeight);
+			CpuProfiler::Begin("TAA");
+			gpuProfiler.Begin("TAA");
+			temporalAA.Render(finalColorBufferTexture, gDepth, unjitteredViewProjection, previousViewProjection, taaFeedback);
+			gpuProfiler.End();
+			CpuProfiler::End();
+		}
+		previousViewProjection = unjitteredViewProjection;
+		frameIndex++;
+
 		#pragma endregion
 
 		#pragma region Draw Screen Quad with Post Processing Shader
 
-		// now bind back to default framebuffer and draw a quad plane with the attached framebuffer color texture
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		CpuProfiler::Begin("Post Processing");
+		gpuProfiler.Begin("Post Processing");
+
+		// now bind back to default framebuffer and draw a quad plane with the attached framebuffer color texture,
+		// or to the upscaler's input at the render resolution while the resolution is scaled
+		glBindFramebuffer(GL_FRAMEBUFFER, dynamicResolution.Upscaling() ? dynamicResolution.Framebuffer() : 0);
+		glViewport(0, 0, renderWidth, renderHeight);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, finalColorBufferTexture[0]);	// use the color attachment texture as the texture of the quad plane
+		glBindTexture(GL_TEXTURE_2D, taaOn ? temporalAA.Texture() : finalColorBufferTexture);	// use the color attachment texture as the texture of the quad plane
 		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, bloomTexture[!horizontal]);
+		glBindTexture(GL_TEXTURE_2D, bloomPass.Texture());
+		//The Tone Mapping Table Is Only Baked Again When The Operator Or Exposure Change.
+		toneMappingLUT.Update(toneMapping, exposure);
+		glActiveTexture(GL_TEXTURE2);
+		glBindTexture(GL_TEXTURE_3D, toneMappingLUT.Texture());
 		ppShader.use();
 		ppShader.setMat4("view", view);
-		ppShader.setFloat("exposure", exposure);
-		ppShader.setUInt("toneMapping", toneMapping);
+		ppShader.setVector2("toneMappingRange", toneMappingLUT.LogRange());
 		ppShader.setUInt("bloom", bloom);
+		//The Bloom Texture Holds The Sum Of All Its Levels.
+		ppShader.setFloat("bloomIntensity", bloomIntensity / bloomPass.LevelCount());
 		ppShader.setBool("fxaaOn", fxaaOn);
 		ppShader.setBool("showEdges", showEdges);
-		ppShader.setVector2("texelStep", vec2(1.0f / (float)bufferWidth, 1.0f / (float)bufferHeight));
+		ppShader.setVector2("texelStep", vec2(1.0f / (float)renderWidth, 1.0f / (float)renderHeight));
 		ppShader.setFloat("lumaThreshold", lumaThreshold);
 		ppShader.setFloat("mulReduce", 1.0f / mulReduceReciprocal);
 		ppShader.setFloat("minReduce", 1.0f / minReduceReciprocal);
@@ -1655,12 +1843,30 @@ int main()
 
 		#pragma endregion
 
+		#pragma region Upscale Pass
+
+		//Upscale & Sharpen The Post Processed Image To The Window.
+		if (dynamicResolution.Upscaling())
+			dynamicResolution.Upscale(upscaleSharpness);
+		gpuProfiler.End();
+		CpuProfiler::End();
+		dynamicResolution.EndTiming();
+
+		#pragma endregion
+
 		#pragma region Draw ImGui
 
 		#pragma region Initialize Frame
 
+		CpuProfiler::Begin("ImGui");
 		ImGui_ImplOpenGL3_NewFrame();
-		ImGui_ImplGlfw_NewFrame();
+		if (benchmarking)
+		{
+			io.DisplaySize = ImVec2((float)bufferWidth, (float)bufferHeight);
+			io.DeltaTime = benchmark.DeltaTime();
+		}
+		else
+			ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
 
 		#pragma endregion
@@ -1669,6 +1875,30 @@ int main()
 
 		ImGui::Begin("FPS");
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+		ImGui::Text("Shadows: %u Lights, %u Faces, %u Casters Rendered, %u Faces Filtered, %u Faces Pending", shadowCache.LightsRendered(), shadowCache.FacesRendered(), shadowCache.CastersDrawn(),
+					shadowCache.FacesFiltered(), shadowCache.FacesPending());
+		ImGui::Text("Shadow Atlas: %.0f MiB", shadowCache.Atlas().Bytes() / (1024.0 * 1024.0));
+		for (unsigned int tier = 0; tier < shadowCache.Atlas().TierCount(); tier++)
+			ImGui::Text("  %u^2: %u / %u Slots In Use", shadowCache.Atlas().TierSize(tier), shadowCache.Atlas().TierSlotsInUse(tier), shadowCache.Atlas().TierSlots(tier));
+		ImGui::Text("Resolution: %d x %d (%.0f%%), GPU %.2f ms/frame", renderWidth, renderHeight, dynamicResolution.Scale() * 100.0f, dynamicResolution.GpuMilliseconds());
+		ImGui::End();
+
+		#pragma endregion
+
+		#pragma region GPU Profiler
+
+		//GPU Time Of Each Pass Over The Last Frames It Ran In. The Trace Has The CPU Markers Of Every Thread Next To The Last Frames Of The GPU Passes.
+		ImGui::Begin("GPU Profiler");
+		ImGui::Text("%-16s %8s %8s %8s %8s", "Pass (ms)", "Average", "p50", "p95", "p99");
+		for (const GpuProfiler::PassStats& pass : gpuProfiler.Stats())
+			ImGui::Text("%-16s %8.3f %8.3f %8.3f %8.3f", pass.name.c_str(), pass.average, pass.p50, pass.p95, pass.p99);
+		if (ImGui::Button("Export Trace"))
+			traceExported = CpuProfiler::ExportTrace(PROJECT_DIR"/trace.json", &gpuProfiler) ? 1 : -1;
+		if (traceExported != 0)
+		{
+			ImGui::SameLine();
+			ImGui::Text("%s", traceExported > 0 ? "Written To trace.json" : "Couldn't Write trace.json");
+		}
 		ImGui::End();
 
 		#pragma endregion
@@ -1679,6 +1909,17 @@ int main()
 		ImGui::SliderInt("Environment", &environment, 0, 6);
 		if (prevEnvironment != environment)	pbrDirty = true;
 		prevEnvironment = environment;
+		if (bakePending)
+			ImGui::Text("Loading Environment %d", environment);
+		if (iblBaker.Busy())
+			ImGui::Text("Baking Environment %d: %.0f%%", bakingEnvironment, iblBaker.Progress() * 100.0f);
+		if (ImGui::SliderInt("Resident Environments", &residentEnvironments, 2, environments.Count()))
+			environments.SetResidentLimit(residentEnvironments, shownSlot, environmentFading ? fadedSlot : -1);
+		ImGui::Text("Resident Environments: %u", environments.ResidentCount());
+		ImGui::SliderFloat("IBL Bake Budget (ms)", &iblBakeBudget, 0.5f, 16.0f);
+		ImGui::SliderFloat("Environment Fade (s)", &environmentFadeDuration, 0.05f, 3.0f);
+		ImGui::SliderFloat("Environment Rotation", &environmentRotation, 0.0f, 360.0f);
+		ImGui::SliderFloat("Environment Intensity", &environmentIntensity, 0.0f, 4.0f);
 		
 		ImGui::Text("Tone Mapping");
 		ImGui::SameLine(210.0f, -1.0f);
@@ -1704,20 +1945,67 @@ int main()
 
 		ImGui::NewLine();
 		ImGui::Checkbox("SSAO", &ssao);
-		ImGui::SliderFloat("SSAO Radius", &ssaoRadius, 0.0f, 0.2f);
-		ImGui::SliderFloat("SSAO Bias", &ssaoBias, 0.0f, 0.2f);
-		ImGui::SliderFloat("SSAO Strength", &ssaoStrength, 1.0f, 50.0f);
+		ImGui::Text("SSAO Method");
+		ImGui::SameLine(210.0f, -1.0f);
+		if (ImGui::BeginCombo("##SSAO Method", current_ssaoMethod, ImGuiComboFlags_NoArrowButton)) // The second parameter is the label previewed before opening the combo.
+		{
+			for (int n = 0; n < 2; n++)
+			{
+				bool is_selected = (current_ssaoMethod == ssaoMethods[n]); // You can store your selection however you want, outside or inside your objects
+				if (ImGui::Selectable(ssaoMethods[n], is_selected))
+					current_ssaoMethod = ssaoMethods[n];
+				if (is_selected)
+					ImGui::SetItemDefaultFocus();   // You may set the initial focus when opening the combo (scrolling + for keyboard navigation support)
+			}
+			ImGui::EndCombo();
+		}
+		if (current_ssaoMethod == ssaoMethods[1])
+		{
+			ImGui::SliderFloat("GTAO Radius", &gtaoRadius, 0.0f, 0.5f);
+			ImGui::SliderFloat("GTAO Strength", &gtaoStrength, 0.5f, 4.0f);
+			ImGui::SliderInt("GTAO Slices", &gtaoSlices, 1, 4);
+			ImGui::SliderInt("GTAO Steps Per Side", &gtaoSteps, 1, 8);
+			ImGui::Checkbox("GTAO Multi Bounce", &gtaoMultiBounce);
+			ImGui::Checkbox("GTAO Bent Normals", &gtaoBentNormals);
+		}
+		else
+		{
+			ImGui::SliderFloat("SSAO Radius", &ssaoRadius, 0.0f, 0.2f);
+			ImGui::SliderFloat("SSAO Bias", &ssaoBias, 0.0f, 0.2f);
+			ImGui::SliderFloat("SSAO Strength", &ssaoStrength, 1.0f, 50.0f);
+		}
+
+		ImGui::NewLine();
+		ImGui::SliderInt("Shadow Faces Per Frame", &shadowFacesPerFrame, 0, 12);
+		ImGui::SliderFloat("Shadow Full Refresh Distance", &shadowFullRefreshDistance, 0.0f, 0.5f);
 
 		ImGui::NewLine();
 		ImGui::Checkbox("Bloom", &bloom);
 		if (bloom)
 		{
-			ImGui::SliderInt("Bloom Amount", &bloomAmount, 0, 100);
-			ImGui::SliderInt("Blur Method", &bloomBlurMethod, 0, 1);
+			ImGui::SliderFloat("Bloom Threshold", &bloomThreshold, 0.0f, 5.0f);
+			ImGui::SliderFloat("Bloom Knee", &bloomKnee, 0.0f, 2.0f);
+			ImGui::SliderFloat("Bloom Radius", &bloomRadius, 0.5f, 3.0f);
+			ImGui::SliderFloat("Bloom Intensity", &bloomIntensity, 0.0f, 5.0f);
 		}
 		
 		ImGui::NewLine();
-		ImGui::Checkbox("FXAA", &fxaaOn);
+		ImGui::Text("Anti-Aliasing");
+		ImGui::SameLine(210.0f, -1.0f);
+		if (ImGui::BeginCombo("##Anti-Aliasing", current_antiAliasing, ImGuiComboFlags_NoArrowButton)) // The second parameter is the label previewed before opening the combo.
+		{
+			for (int n = 0; n < 3; n++)
+			{
+				bool is_selected = (current_antiAliasing == antiAliasingMethods[n]); // You can store your selection however you want, outside or inside your objects
+				if (ImGui::Selectable(antiAliasingMethods[n], is_selected))
+					current_antiAliasing = antiAliasingMethods[n];
+				if (is_selected)
+					ImGui::SetItemDefaultFocus();   // You may set the initial focus when opening the combo (scrolling + for keyboard navigation support)
+			}
+			ImGui::EndCombo();
+		}
+		if (taaOn)
+			ImGui::SliderFloat("TAA Feedback", &taaFeedback, 0.5f, 0.98f);
 		if (fxaaOn)
 		{	
 			ImGui::Checkbox("Show Edges", &showEdges);
@@ -1727,11 +2015,24 @@ int main()
 			ImGui::SliderFloat("Max Span", &maxSpan, 0.0f, 16.0f);
 		}
 
+		ImGui::NewLine();
+		ImGui::Checkbox("Dynamic Resolution", &dynamicResolutionOn);
+		if (dynamicResolutionOn)
+		{
+			ImGui::SliderFloat("Target Frame Time (ms)", &targetFrameTime, 4.0f, 50.0f);
+			ImGui::SliderFloat("Min Resolution Scale", &minResolutionScale, 0.25f, 1.0f);
+		}
+		else
+			ImGui::SliderFloat("Resolution Scale", &resolutionScale, 0.25f, 1.0f);
+		if (dynamicResolution.Upscaling())
+			ImGui::SliderFloat("Upscale Sharpness", &upscaleSharpness, 0.0f, 1.0f);
+
 		ImGui::NewLine();
 		ImGui::Checkbox("PBR Shading", &pbrEnabled);
 		if (pbrEnabled)
 		{
 			ImGui::Checkbox("Physically Correct Attenuation", &physicallyCorrectAttenuation);
+			ImGui::Checkbox("SH Irradiance", &shIrradiance);
 
 			ImGui::NewLine();
 			ImGui::SliderFloat("Bed Metallicness", &bedMetallic[0], 0.0f, 1.0f);
@@ -1814,13 +2115,14 @@ int main()
 
 		ImGui::NewLine();
 		ImGui::Checkbox("Cast Shadows", &shadowForLight1);
-		ImGui::Checkbox("Debug Shadows", &debugShadowForLight1);
+		if (filteredShadowsSupported)
+			ImGui::Checkbox("Debug Shadows", &debugShadowForLight1);
 
 		ImGui::Text("Shadow Type");
 		ImGui::SameLine(210.0f, -1.0f);
 		if (ImGui::BeginCombo("##Shadow Type", current_shadowTypeL1, ImGuiComboFlags_NoArrowButton)) // The second parameter is the label previewed before opening the combo.
 		{
-			for (int n = 0; n < 3; n++)
+			for (int n = 0; n < shadowTypeCount; n++)
 			{
 				bool is_selected = (current_shadowTypeL1 == shadowTypes[n]); // You can store your selection however you want, outside or inside your objects
 				if (ImGui::Selectable(shadowTypes[n], is_selected))
@@ -1831,7 +2133,12 @@ int main()
 			ImGui::EndCombo();
 		}
 
-		if (current_shadowTypeL1 == shadowTypes[2])
+		if (current_shadowTypeL1 == shadowTypes[3])
+		{
+			shadowTypeLight1 = 3;
+			ImGui::SliderFloat("Exponential Shadow Exponent", &esmExponentLight1, 10.0f, 300.0f);
+		}
+		else if (current_shadowTypeL1 == shadowTypes[2])
 		{
 			shadowTypeLight1 = 2;
 			ImGui::SliderFloat("Fast Soft Shadow Factor", &fsoftShadowFactorLight1, 50.0f, 5000.0f);
@@ -1869,13 +2176,14 @@ int main()
 
 		ImGui::NewLine();
 		ImGui::Checkbox("Cast Shadows", &shadowForLight2);
-		ImGui::Checkbox("Debug Shadows", &debugShadowForLight2);
+		if (filteredShadowsSupported)
+			ImGui::Checkbox("Debug Shadows", &debugShadowForLight2);
 
 		ImGui::Text("Shadow Type");
 		ImGui::SameLine(210.0f, -1.0f);
 		if (ImGui::BeginCombo("##Shadow Type", current_shadowTypeL2, ImGuiComboFlags_NoArrowButton)) // The second parameter is the label previewed before opening the combo.
 		{
-			for (int n = 0; n < 3; n++)
+			for (int n = 0; n < shadowTypeCount; n++)
 			{
 				bool is_selected = (current_shadowTypeL2 == shadowTypes[n]); // You can store your selection however you want, outside or inside your objects
 				if (ImGui::Selectable(shadowTypes[n], is_selected))
@@ -1886,7 +2194,12 @@ int main()
 			ImGui::EndCombo();
 		}
 
-		if (current_shadowTypeL2 == shadowTypes[2])
+		if (current_shadowTypeL2 == shadowTypes[3])
+		{
+			shadowTypeLight2 = 3;
+			ImGui::SliderFloat("Exponential Shadow Exponent", &esmExponentLight2, 10.0f, 300.0f);
+		}
+		else if (current_shadowTypeL2 == shadowTypes[2])
 		{
 			shadowTypeLight2 = 2;
 			ImGui::SliderFloat("Fast Soft Shadow Factor", &fsoftShadowFactorLight2, 50.0f, 5000.0f);
@@ -1918,39 +2231,64 @@ int main()
 		#pragma region Render 
 
 		ImGui::Render();
-		int display_w, display_h;
-		glfwGetFramebufferSize(window, &display_w, &display_h);
+		int display_w = bufferWidth, display_h = bufferHeight;
+		if (!benchmarking)
+			glfwGetFramebufferSize(window, &display_w, &display_h);
 		glViewport(0, 0, display_w, display_h);
+		gpuProfiler.Begin("ImGui");
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		gpuProfiler.End();
+		CpuProfiler::End();
 
 		#pragma endregion
 
 		#pragma endregion
 
-		#pragma region Shadowmap Dirty Check
-
-		float currentShadowMapDirtyIdentifier = cT[0] + cT[1] + cT[2] + cR + cS[0] + cS[1] + cS[2] + near_plane[0] + near_plane[1] + far_plane[0] + far_plane[1];
-		if (abs(currentShadowMapDirtyIdentifier - prevShadowMapDirtyIdentifier) > 0.0001f)
-			shadowMapDirty = true;
-		prevShadowMapDirtyIdentifier = currentShadowMapDirtyIdentifier;
-
-		#pragma endregion
+		//Swap Buffers, The Benchmark Waits For The Frame Instead.
+		CpuProfiler::Begin("SwapBuffers");
+		if (benchmarking)
+			benchmark.EndFrame(gpuProfiler);
+		else
+			glfwSwapBuffers(window);
+		CpuProfiler::End();
 
-		//Swap Buffers.
-		glfwSwapBuffers(window);
+		CpuProfiler::End();
 	}
 
 	#pragma endregion
 
 	#pragma region Cleanup & Termination
 
+	int exitCode = 0;
+	if (benchmarking && !benchmark.WriteResults(gpuProfiler, benchmarkCameraPathName))
+	{
+		cout << "Couldn't Write The Benchmark Results To " << benchmarkSettings.output << endl;
+		exitCode = -1;
+	}
+
+	if (!recordCameraPath.empty())
+	{
+		if (recordedCameraPath.Save(recordCameraPath))
+			cout << "Camera Path Written To " << recordCameraPath << endl;
+		else
+			cout << "Couldn't Write The Camera Path To " << recordCameraPath << endl;
+	}
+
+	if (!tracePath.empty())
+	{
+		if (CpuProfiler::ExportTrace(tracePath, &gpuProfiler))
+			cout << "Trace Written To " << tracePath << endl;
+		else
+			cout << "Couldn't Write The Trace To " << tracePath << endl;
+	}
+
 	ImGui_ImplOpenGL3_Shutdown();
-	ImGui_ImplGlfw_Shutdown();
+	if (!benchmarking)
+		ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
 
-	glfwDestroyWindow(window);
-	glfwTerminate();
-	return 0;
+	//The Window Is Destroyed By windowCleanup, After The Passes & Shadow Maps Above Have Deleted Their GL Objects.
+	return exitCode;
 
 	#pragma endregion
 
@@ -1968,11 +2306,9 @@ int main()
 /// <param name="height">New Window Height</param>
 void Window_Resize_Callback(GLFWwindow* window, int width, int height)
 {
-	//Get The Frame Buffer Size.
+	//Get The Frame Buffer Size, The Render Loop Resizes The Framebuffers To It Scaled By The Dynamic Resolution.
 	glfwGetFramebufferSize(window, &bufferWidth, &bufferHeight);
 
-	UpdateAllFramebuffersSize(bufferWidth, bufferHeight);
-
 	//Resize The Viewport.
 	glViewport(0, 0, bufferWidth, bufferHeight);
 }
@@ -2020,9 +2356,8 @@ void ProcessInput(GLFWwindow* window)
 			//Set To Windowed Mode.
 			// Non zero value for offsets to make sure that the title bar can render on windows.
 			glfwSetWindowMonitor(window, NULL, 20, 40, SCR_WIDTH, SCR_HEIGHT, GLFW_DONT_CARE);
-			//Get The Frame Buffer Size & Update Them.
+			//Get The Frame Buffer Size, The Render Loop Updates The Framebuffers.
 			glfwGetFramebufferSize(window, &bufferWidth, &bufferHeight);
-			UpdateAllFramebuffersSize(bufferWidth, bufferHeight);
 			fullScreen = false;
 			fullScreenDirty = true;
 		}
@@ -2030,9 +2365,8 @@ void ProcessInput(GLFWwindow* window)
 		{
 			//Set To Fullscreen Mode.
 			glfwSetWindowMonitor(window, primaryMonitor, 0, 0, videoMode->width, videoMode->height, videoMode->refreshRate);
-			//Get The Frame Buffer Size & Update Them.
+			//Get The Frame Buffer Size, The Render Loop Updates The Framebuffers.
 			glfwGetFramebufferSize(window, &bufferWidth, &bufferHeight);
-			UpdateAllFramebuffersSize(bufferWidth, bufferHeight);
 			fullScreen = true;
 			fullScreenDirty = true;
 		}
@@ -2132,6 +2466,8 @@ void ProcessScrollInput(GLFWwindow* window, double xoffset, double yoffset)
 /// <returns>Texture ID</returns>
 unsigned int LoadTexture(char const* path, bool sRGB)
 {
+	CpuProfiler::Scope profile("LoadTexture");
+
 	unsigned int textureID;
 	glGenTextures(1, &textureID);
 
@@ -2179,41 +2515,6 @@ unsigned int LoadTexture(char const* path, bool sRGB)
 
 #pragma endregion
 
-#pragma region Load HDR Texture
-
-/// <summary>
-/// Load A HDR Texture with all unclamped Floating Point Values.
-/// </summary>
-/// <param name="path">Path</param>
-/// <returns></returns>
-unsigned int LoadHDRTexture(char const* path)
-{
-	int width, height, nrComponents;
-	float* data = stbi_loadf(path, &width, &height, &nrComponents, 0);
-	unsigned int hdrTexture = 0;
-	if (data)
-	{
-		glGenTextures(1, &hdrTexture);
-		glBindTexture(GL_TEXTURE_2D, hdrTexture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data); // note how we specify the texture's data value to be float
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		stbi_image_free(data);
-	}
-	else
-	{
-		std::cout << "Failed to load HDR image." << std::endl;
-	}
-
-	return hdrTexture;
-}
-
-#pragma endregion
-
 #pragma region Load Cubemap
 
 /// <summary>
@@ -2223,6 +2524,8 @@ unsigned int LoadHDRTexture(char const* path)
 /// <returns>Texture ID</returns>
 unsigned int LoadCubemap(vector<string> path)
 {
+	CpuProfiler::Scope profile("LoadCubemap");
+
 	unsigned int textureID;
 	glGenTextures(1, &textureID);
 	glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
@@ -2269,19 +2572,13 @@ void UpdateAllFramebuffersSize(int bufferWidth, int bufferHeight)
 	#pragma region Resize HDR Render Buffer
 
 	glBindFramebuffer(GL_FRAMEBUFFER, renderFBO);
-	for (unsigned int i = 0; i < 2; i++)
-	{
-		glBindTexture(GL_TEXTURE_2D, finalColorBufferTexture[i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, bufferWidth, bufferHeight, 0, GL_RGBA, GL_FLOAT, NULL);
-		// attach it to currently bound framebuffer object
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, finalColorBufferTexture[i], 0);
-	}
+	glBindTexture(GL_TEXTURE_2D, finalColorBufferTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, bufferWidth, bufferHeight, 0, GL_RGBA, GL_FLOAT, NULL);
+	// attach it to currently bound framebuffer object
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, finalColorBufferTexture, 0);
 	glBindRenderbuffer(GL_RENDERBUFFER, finalRBO);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, bufferWidth, bufferHeight);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, bufferWidth, bufferHeight);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, finalRBO);
-	// tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
-	unsigned int attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-	glDrawBuffers(2, attachments);
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	#pragma endregion
@@ -2290,72 +2587,32 @@ void UpdateAllFramebuffersSize(int bufferWidth, int bufferHeight)
 
 	glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 
-	// position color buffer
-	glBindTexture(GL_TEXTURE_2D, gPosition);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, bufferWidth, bufferHeight, 0, GL_RGB, GL_FLOAT, NULL);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-
 	// normal color buffer
 	glBindTexture(GL_TEXTURE_2D, gNormal);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, bufferWidth, bufferHeight, 0, GL_RGB, GL_FLOAT, NULL);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
-
-	// Albedo color buffer
-	glBindTexture(GL_TEXTURE_2D, gAlbedo);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, bufferWidth, bufferHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedo, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16, bufferWidth, bufferHeight, 0, GL_RG, GL_UNSIGNED_SHORT, NULL);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gNormal, 0);
 
-	// Emission color buffer
-	glBindTexture(GL_TEXTURE_2D, gEmission);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, bufferWidth, bufferHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, gEmission, 0);
+	// Albedo & Metallic color buffer
+	glBindTexture(GL_TEXTURE_2D, gAlbedoMetallic);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, bufferWidth, bufferHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gAlbedoMetallic, 0);
 
-	// Metallic Roughness color buffer
-	glBindTexture(GL_TEXTURE_2D, gMetallicRoughness);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG, bufferWidth, bufferHeight, 0, GL_RG, GL_UNSIGNED_BYTE, NULL);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT4, GL_TEXTURE_2D, gMetallicRoughness, 0);
+	// Emission & Roughness color buffer
+	glBindTexture(GL_TEXTURE_2D, gEmissionRoughness);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, bufferWidth, bufferHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gEmissionRoughness, 0);
 
-	unsigned int colorAttachments[5] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4 };
-	glDrawBuffers(5, colorAttachments);
+	unsigned int colorAttachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(3, colorAttachments);
 
 	// gDepth Buffer
-	glBindRenderbuffer(GL_RENDERBUFFER, gDepth);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, bufferWidth, bufferHeight);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, gDepth);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	#pragma endregion
-
-	#pragma region Resize SSAO Buffer
-
-	glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
-	// SSAO Grayscale Buffer
-	glBindTexture(GL_TEXTURE_2D, ssaoGrayscaleBuffer);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, bufferWidth, bufferHeight, 0, GL_RED, GL_FLOAT, NULL);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ssaoGrayscaleBuffer, 0);
-
-	// SSAO Grayscale Blur Buffer
-	glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
-	glBindTexture(GL_TEXTURE_2D, ssaoGrayscaleBlurBuffer);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, bufferWidth, bufferHeight, 0, GL_RED, GL_FLOAT, NULL);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ssaoGrayscaleBlurBuffer, 0);
+	glBindTexture(GL_TEXTURE_2D, gDepth);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, bufferWidth, bufferHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gDepth, 0);
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
 	#pragma endregion
 
-	#pragma region Resize Bloom Buffer
-
-	for (unsigned int i = 0; i < 2; ++i)
-	{
-		glBindFramebuffer(GL_FRAMEBUFFER, bloomFBO[i]);
-		glBindTexture(GL_TEXTURE_2D, bloomTexture[i]);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, bufferWidth, bufferHeight, 0, GL_RGBA, GL_FLOAT, NULL);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, bloomTexture[i], 0);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	}
-
-	#pragma endregion
-
 }
 
 #pragma endregion
@@ -2473,205 +2730,74 @@ void RenderCube()
 #pragma region Setup PBR
 
 /// <summary>
-/// Initializes The EnvMap, irradianceMap, prefilterMap & bdrfLutTexture Based on the Given HDR Map.
+/// Allocates The SH Uniform Buffer & The BRDF LUT, Which Is Loaded From The IBL Cache Or Baked Once.
 /// </summary>
-/// <param name="hdrTexture"></param>
-void SetupPBR(unsigned int hdrTexture)
+/// <param name="baker">Baker Of The IBL Maps</param>
+void InitializePBR(IBLBaker& baker)
 {
-	// Setup framebuffer
-	// ----------------------
-	if(!pbrInitialized)
-	{
-		glGenFramebuffers(1, &captureFBO);
-		glGenRenderbuffers(1, &captureRBO);
-	}
-
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 1024, 1024);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
-
-	// Setup cubemap to render to and attach to framebuffer
-	// ---------------------------------------------------------
-	if(!pbrInitialized)	glGenTextures(1, &envCubemap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
-	if (!pbrInitialized)
-	{
-		for (unsigned int i = 0; i < 6; ++i)
-		{
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 1024, 1024, 0, GL_RGB, GL_FLOAT, nullptr);
-		}
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // enable pre-filter mipmap sampling (combatting visible dots artifact)
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	}
-	// pbr: set up projection and view matrices for capturing data onto the 6 cubemap face directions
-	// ----------------------------------------------------------------------------------------------
-	glm::mat4 captureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
-	glm::mat4 captureViews[] =
-	{
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-		glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f))
-	};
-
-	// pbr: convert HDR equirectangular environment map to cubemap equivalent
-	// ----------------------------------------------------------------------
-	Shader equirectangularToCubemapShader(PROJECT_DIR"/src/Shaders/cubemap.vs", PROJECT_DIR"/src/Shaders/equirectangular_to_cubemap.fs");
-	equirectangularToCubemapShader.use();
-	equirectangularToCubemapShader.setInt("equirectangularMap", 0);
-	equirectangularToCubemapShader.setMat4("projection", captureProjection);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, hdrTexture);
-
-	glViewport(0, 0, 1024, 1024); // don't forget to configure the viewport to the capture dimensions.
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-	for (unsigned int i = 0; i < 6; ++i)
-	{
-		equirectangularToCubemapShader.setMat4("view", captureViews[i]);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, envCubemap, 0);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		RenderCube();
-	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	CpuProfiler::Scope profile("InitializePBR");
 
-	// Then let OpenGL generate mipmaps from first mip face (combatting visible dots artifact)
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
-	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	const IBLBakeSettings settings;
 
-	// Create an irradiance cubemap, and re-scale capture FBO to irradiance scale.
-	// --------------------------------------------------------------------------------
-	if(!pbrInitialized)	glGenTextures(1, &irradianceMap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-	if (!pbrInitialized)
-	{
-		for (unsigned int i = 0; i < 6; ++i)
-		{
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 64, 64, 0, GL_RGB, GL_FLOAT, nullptr);
-		}
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glGenBuffers(1, &environmentSHUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, environmentSHUBO);
+	glBufferData(GL_UNIFORM_BUFFER, 9 * 4 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 1, environmentSHUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-	}
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 64, 64);
-
-	// pbr: solve diffuse integral by convolution to create an irradiance (cube)map.
-	// -----------------------------------------------------------------------------
-	Shader irradianceShader(PROJECT_DIR"/src/Shaders/cubemap.vs", PROJECT_DIR"/src/Shaders/irradiance_convolution.fs");
-	irradianceShader.use();
-	irradianceShader.setInt("environmentMap", 0);
-	irradianceShader.setMat4("projection", captureProjection);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
-
-	glViewport(0, 0, 64, 64); // don't forget to configure the viewport to the capture dimensions.
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-	for (unsigned int i = 0; i < 6; ++i)
-	{
-		irradianceShader.setMat4("view", captureViews[i]);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, irradianceMap, 0);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glGenTextures(1, &brdfLUTTexture);
+	// pre-allocate enough memory for the LUT texture.
+	glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, settings.brdfLUTSize, settings.brdfLUTSize, 0, GL_RG, GL_FLOAT, 0);
+	// be sure to set wrapping mode to GL_CLAMP_TO_EDGE
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-		RenderCube();
-	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	// Generate a 2D LUT from the BRDF equations used, it doesn't depend on the environment so it's only done once.
+	baker.BakeBRDFLUT(brdfLUTTexture);
+}
 
-	// Create a pre-filter cubemap, and re-scale capture FBO to pre-filter scale.
-	// --------------------------------------------------------------------------------
-	if(!pbrInitialized)	glGenTextures(1, &prefilterMap);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
-	if (!pbrInitialized)
-	{
-		for (unsigned int i = 0; i < 6; ++i)
-		{
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 256, 256, 0, GL_RGB, GL_FLOAT, nullptr);
-		}
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // be sure to set minification filter to mip_linear 
-		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	}
-	// Generate mipmaps for the cubemap so OpenGL automatically allocates the required memory.
-	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
-
-	// Run a quasi monte-carlo simulation on the environment lighting to create a prefilter (cube)map.
-	// ----------------------------------------------------------------------------------------------------
-	Shader prefilterShader(PROJECT_DIR"/src/Shaders/cubemap.vs", PROJECT_DIR"/src/Shaders/prefilter.fs");
-	prefilterShader.use();
-	prefilterShader.setInt("environmentMap", 0);
-	prefilterShader.setMat4("projection", captureProjection);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
-
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-	unsigned int maxMipLevels = 5;
-	for (unsigned int mip = 0; mip < maxMipLevels; ++mip)
-	{
-		// reisze framebuffer according to mip-level size.
-		unsigned int mipWidth = static_cast<unsigned int>(256 * std::pow(0.5, mip));
-		unsigned int mipHeight = static_cast<unsigned int>(256 * std::pow(0.5, mip));
-		glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
-		glViewport(0, 0, mipWidth, mipHeight);
-
-		float roughness = (float)mip / (float)(maxMipLevels - 1);
-		prefilterShader.setFloat("roughness", roughness);
-		for (unsigned int i = 0; i < 6; ++i)
-		{
-			prefilterShader.setMat4("view", captureViews[i]);
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, prefilterMap, mip);
+/// <summary>
+/// Uploads The Irradiance SH Coefficients Of An Environment To The Uniform Buffer Read By The SH_IRRADIANCE Lighting Variant.
+/// </summary>
+/// <param name="radianceSH">SH Projection Of The Environment's Radiance</param>
+void UploadEnvironmentSH(const SH9& radianceSH)
+{
+	float coefficients[9][4];
+	SH9ToIrradianceUniforms(radianceSH, coefficients);
+	glBindBuffer(GL_UNIFORM_BUFFER, environmentSHUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(coefficients), coefficients);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
 
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-			RenderCube();
-		}
-	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+#pragma endregion
 
-	// Generate a 2D LUT from the BRDF equations used.
-	// ----------------------------------------------------
-	if(!pbrInitialized)	glGenTextures(1, &brdfLUTTexture);
-	Shader brdfShader(PROJECT_DIR"/src/Shaders/brdf.vs", PROJECT_DIR"/src/Shaders/brdf.fs");
+#pragma region Shader Variants
 
-	// pre-allocate enough memory for the LUT texture.
-	glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
-	if (!pbrInitialized)
+/// <summary>
+/// Builds The Deferred Lighting Shader Feature Bits For One Point Light.
+/// </summary>
+/// <param name="lightIndex">Index Of The Point Light In The Shader</param>
+/// <param name="shadows">True If The Light Casts Shadows</param>
+/// <param name="shadowType">0 - Hard, 1 - Soft, 2 - Fast Soft, 3 - Exponential</param>
+/// <param name="blinn">True For Blinn-Phong, False For Phong</param>
+/// <param name="debugShadow">True To Output The Shadow Map Instead Of The Lit Color</param>
+/// <returns>Feature Mask Bits For Shader::Variant()</returns>
+unsigned int PointLightFeatures(unsigned int lightIndex, bool shadows, unsigned int shadowType, bool blinn, bool debugShadow)
+{
+	unsigned int features = 0;
+	if (shadows)
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, 1024, 1024, 0, GL_RG, GL_FLOAT, 0);
-		// be sure to set wrapping mode to GL_CLAMP_TO_EDGE
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		features |= LIGHTING_LIGHT_SHADOWS;
+		if (shadowType == 1) features |= LIGHTING_LIGHT_SOFT_SHADOWS;
+		if (shadowType == 2) features |= LIGHTING_LIGHT_FAST_SOFT_SHADOWS;
+		if (shadowType == 3) features |= LIGHTING_LIGHT_ESM_SHADOWS;
 	}
-
-	// then re-configure capture framebuffer object and render screen-space quad with BRDF shader.
-	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-	glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 1024, 1024);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUTTexture, 0);
-
-	glViewport(0, 0, 1024, 1024);
-	brdfShader.use();
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	RenderQuad();
-
-	//Reset Viewport Size.
-	glViewport(0, 0, bufferWidth, bufferHeight);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-	
-	//Set PBR Initialized as True.
-	pbrInitialized = true;
+	if (blinn) features |= LIGHTING_LIGHT_BLINN;
+	if (debugShadow) features |= LIGHTING_LIGHT_DEBUG_SHADOW;
+	return features << (lightIndex * LIGHTING_LIGHT_FEATURE_COUNT);
 }
 
 #pragma endregion
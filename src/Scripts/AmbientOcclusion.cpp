@@ -0,0 +1,317 @@
+#include "AmbientOcclusion.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// the occlusion & depth arrays hold 2x2 deinterleaved half resolution pixels.
+	const unsigned int LAYERS = 4;
+	// mip levels of the depth pyramid the horizon search reads.
+	const unsigned int PYRAMID_LEVELS = 5;
+	// hemisphere kernel samples & the samples taken per frame with temporal sampling.
+	const unsigned int KERNEL_SIZE = 16;
+	const unsigned int TEMPORAL_KERNEL_SIZE = 4;
+	// frames before the temporal sampling pattern repeats.
+	const unsigned int TEMPORAL_PERIOD = 64;
+
+	unsigned int HalfSize(unsigned int size)
+	{
+		return (size + 1) / 2;
+	}
+
+	unsigned int QuarterSize(unsigned int size)
+	{
+		return (HalfSize(size) + 1) / 2;
+	}
+
+	unsigned int CreateTexture(GLenum target, unsigned int width, unsigned int height, GLenum internalFormat, GLenum format, GLenum type)
+	{
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(target, texture);
+		if (target == GL_TEXTURE_2D_ARRAY)
+			glTexImage3D(target, 0, internalFormat, width, height, LAYERS, 0, format, type, NULL);
+		else
+			glTexImage2D(target, 0, internalFormat, width, height, 0, format, type, NULL);
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		return texture;
+	}
+}
+
+AmbientOcclusion::AmbientOcclusion(unsigned int width, unsigned int height, void (*renderQuad)())
+	: renderQuad(renderQuad),
+	downsampleShader(PROJECT_DIR"/src/Shaders/deferredLighting.vs", PROJECT_DIR"/src/Shaders/ssaoDownsample.fs"),
+	ssaoShader(PROJECT_DIR"/src/Shaders/deferredLighting.vs", PROJECT_DIR"/src/Shaders/ssao.fs"),
+	horizonShader(PROJECT_DIR"/src/Shaders/deferredLighting.vs", PROJECT_DIR"/src/Shaders/gtao.fs"),
+	pyramidShader(PROJECT_DIR"/src/Shaders/deferredLighting.vs", PROJECT_DIR"/src/Shaders/ssaoDepthPyramid.fs"),
+	blurShader(PROJECT_DIR"/src/Shaders/deferredLighting.vs", PROJECT_DIR"/src/Shaders/ssaoBlur.fs"),
+	width(width), height(height), method(Method::Hemisphere), slices(2), steps(4), bentNormals(false),
+	temporal(false), frame(0)
+{
+	horizonShader.SetFeatures({ "BENT_NORMALS" });
+	blurShader.SetFeatures({ "DEINTERLEAVED_INPUT", "BENT_NORMALS" });
+
+	// hemisphere sample kernel, samples scaled to be denser near the center.
+	std::uniform_real_distribution<GLfloat> randomFloats(0.0, 1.0);
+	std::default_random_engine generator;
+	for (unsigned int i = 0; i < KERNEL_SIZE; ++i)
+	{
+		glm::vec3 sample(randomFloats(generator) * 2.0 - 1.0, randomFloats(generator) * 2.0 - 1.0, randomFloats(generator));
+		sample = glm::normalize(sample);
+		sample *= randomFloats(generator);
+		float scale = float(i) / (float)KERNEL_SIZE;
+		scale = 0.1f + scale * scale * (1.0f - 0.1f);
+		kernel[i] = sample * scale;
+	}
+
+	// 4x4 kernel rotations around the tangent space z axis.
+	std::vector<glm::vec3> noise;
+	for (unsigned int i = 0; i < 16; i++)
+		noise.push_back(glm::vec3(randomFloats(generator) * 2.0 - 1.0, randomFloats(generator) * 2.0 - 1.0, 0.0f));
+	glGenTextures(1, &noiseTexture);
+	glBindTexture(GL_TEXTURE_2D, noiseTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, 4, 4, 0, GL_RGB, GL_FLOAT, &noise[0]);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &downsampleFBO);
+	glGenFramebuffers(1, &pyramidFBO);
+	glGenFramebuffers(1, &occlusionFBO);
+	glGenFramebuffers(1, &blurFBO);
+	glGenFramebuffers(1, &resultFBO);
+	CreateTargets();
+}
+
+AmbientOcclusion::~AmbientOcclusion()
+{
+	DeleteTargets();
+	glDeleteTextures(1, &noiseTexture);
+	const unsigned int framebuffers[] = { downsampleFBO, pyramidFBO, occlusionFBO, blurFBO, resultFBO };
+	glDeleteFramebuffers(5, framebuffers);
+}
+
+void AmbientOcclusion::Resize(unsigned int width, unsigned int height)
+{
+	if (width == this->width && height == this->height)
+		return;
+	this->width = width;
+	this->height = height;
+	DeleteTargets();
+	CreateTargets();
+}
+
+void AmbientOcclusion::SetMethod(Method method, unsigned int slices, unsigned int steps, bool bentNormals)
+{
+	this->method = method;
+	this->slices = slices;
+	this->steps = steps;
+	this->bentNormals = bentNormals;
+}
+
+void AmbientOcclusion::SetTemporal(bool temporal, unsigned int frame)
+{
+	this->temporal = temporal;
+	this->frame = frame;
+}
+
+void AmbientOcclusion::CreateTargets()
+{
+	depthArray = CreateTexture(GL_TEXTURE_2D_ARRAY, QuarterSize(width), QuarterSize(height), GL_R32F, GL_RED, GL_FLOAT);
+	normalArray = CreateTexture(GL_TEXTURE_2D_ARRAY, QuarterSize(width), QuarterSize(height), GL_RGBA16F, GL_RGBA, GL_FLOAT);
+	occlusionArray = CreateTexture(GL_TEXTURE_2D_ARRAY, QuarterSize(width), QuarterSize(height), GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+	bentNormalArray = CreateTexture(GL_TEXTURE_2D_ARRAY, QuarterSize(width), QuarterSize(height), GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+	blurTexture = CreateTexture(GL_TEXTURE_2D, HalfSize(width), HalfSize(height), GL_RGBA16F, GL_RGBA, GL_FLOAT);
+	resultTexture = CreateTexture(GL_TEXTURE_2D, HalfSize(width), HalfSize(height), GL_RG16F, GL_RG, GL_FLOAT);
+	blurBentTexture = CreateTexture(GL_TEXTURE_2D, HalfSize(width), HalfSize(height), GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+	resultBentTexture = CreateTexture(GL_TEXTURE_2D, HalfSize(width), HalfSize(height), GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+
+	// taps far from the pixel read coarser levels, the nearest one as the levels hold the closest depth.
+	depthPyramid = CreateTexture(GL_TEXTURE_2D, HalfSize(width), HalfSize(height), GL_R32F, GL_RED, GL_FLOAT);
+	for (unsigned int level = 1; level < PYRAMID_LEVELS; level++)
+		glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, std::max(HalfSize(width) >> level, 1u), std::max(HalfSize(height) >> level, 1u), 0, GL_RED, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, PYRAMID_LEVELS - 1);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// the downsample writes all depth & normal layers at once.
+	glBindFramebuffer(GL_FRAMEBUFFER, downsampleFBO);
+	GLenum drawBuffers[LAYERS * 2];
+	for (unsigned int layer = 0; layer < LAYERS; layer++)
+	{
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + layer, depthArray, 0, layer);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + LAYERS + layer, normalArray, 0, layer);
+		drawBuffers[layer] = GL_COLOR_ATTACHMENT0 + layer;
+		drawBuffers[LAYERS + layer] = GL_COLOR_ATTACHMENT0 + LAYERS + layer;
+	}
+	glDrawBuffers(LAYERS * 2, drawBuffers);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "SSAO Downsample Framebuffer not complete!" << std::endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, blurFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, blurTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, blurBentTexture, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, resultFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, resultTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, resultBentTexture, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "SSAO Blur Framebuffer not complete!" << std::endl;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void AmbientOcclusion::DeleteTargets()
+{
+	const unsigned int textures[] = { depthArray, normalArray, occlusionArray, bentNormalArray, blurTexture, resultTexture, blurBentTexture,
+		resultBentTexture, depthPyramid };
+	glDeleteTextures(9, textures);
+}
+
+void AmbientOcclusion::Render(unsigned int depthTexture, unsigned int normalTexture, const glm::mat4& view, const glm::mat4& projection,
+	float radius, float bias, float strength)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glm::vec2 fullResolution((float)width, (float)height);
+
+	// linear depth & view space normals of the closest of each 2x2 pixels, deinterleaved.
+	glBindFramebuffer(GL_FRAMEBUFFER, downsampleFBO);
+	glViewport(0, 0, QuarterSize(width), QuarterSize(height));
+	downsampleShader.use();
+	downsampleShader.setInt("gDepth", 0);
+	downsampleShader.setInt("gNormal", 1);
+	downsampleShader.setMat4("view", view);
+	downsampleShader.setMat4("projection", projection);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, depthTexture);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, normalTexture);
+	renderQuad();
+
+	// temporal sampling offsets the noise by the R2 sequence (Roberts 2018), which fills the unit square evenly over any run of frames.
+	unsigned int sequence = temporal ? frame % TEMPORAL_PERIOD : 0;
+	glm::vec2 noiseOffset = glm::fract((float)sequence * glm::vec2(0.7548776662f, 0.5698402910f));
+
+	bool horizon = method == Method::Horizon;
+	bool writeBentNormals = horizon && bentNormals;
+	if (horizon)
+		BuildPyramid();
+
+	// occlusion, one layer per draw so every tap of a draw reads the same quarter resolution layer (or the pyramid).
+	glBindFramebuffer(GL_FRAMEBUFFER, occlusionFBO);
+	glViewport(0, 0, QuarterSize(width), QuarterSize(height));
+	const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(writeBentNormals ? 2 : 1, drawBuffers);
+	Shader& occlusionShader = horizon ? horizonShader.Variant(writeBentNormals ? 1 : 0) : ssaoShader;
+	occlusionShader.use();
+	if (horizon)
+	{
+		occlusionShader.setInt("viewNormal", 0);
+		occlusionShader.setInt("depthPyramid", 1);
+		occlusionShader.setInt("texNoise", 2);
+		occlusionShader.setInt("sliceCount", slices);
+		occlusionShader.setInt("stepCount", steps);
+		occlusionShader.setMat4("projection", projection);
+		occlusionShader.setMat3("inverseView", glm::transpose(glm::mat3(view)));
+		occlusionShader.setVector2("fullResolution", fullResolution);
+		occlusionShader.setFloat("radius", radius);
+		occlusionShader.setFloat("strength", strength);
+		occlusionShader.setVector2("noiseOffset", noiseOffset);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, normalArray);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, depthPyramid);
+	}
+	else
+	{
+		occlusionShader.setInt("linearDepth", 0);
+		occlusionShader.setInt("viewNormal", 1);
+		occlusionShader.setInt("texNoise", 2);
+		for (unsigned int i = 0; i < KERNEL_SIZE; ++i)
+			occlusionShader.setVector3("samples[" + std::to_string(i) + "]", kernel[i]);
+		// the kernel grows with the sample index, so every 4th sample from a rotating start covers all distances each frame.
+		occlusionShader.setInt("kernelSize", temporal ? TEMPORAL_KERNEL_SIZE : KERNEL_SIZE);
+		occlusionShader.setInt("kernelOffset", sequence % (KERNEL_SIZE / TEMPORAL_KERNEL_SIZE));
+		occlusionShader.setFloat("rotation", noiseOffset.x);
+		occlusionShader.setMat4("projection", projection);
+		occlusionShader.setVector2("fullResolution", fullResolution);
+		occlusionShader.setFloat("radius", radius);
+		occlusionShader.setFloat("bias", bias);
+		occlusionShader.setFloat("strength", strength);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, normalArray);
+	}
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, noiseTexture);
+	for (unsigned int layer = 0; layer < LAYERS; layer++)
+	{
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, occlusionArray, 0, layer);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, bentNormalArray, 0, layer);
+		occlusionShader.setInt("layer", layer);
+		renderQuad();
+	}
+
+	// separable bilateral blur, the horizontal pass interleaves the layers again & passes on the normals & depth it weighted with.
+	glViewport(0, 0, HalfSize(width), HalfSize(height));
+	for (unsigned int pass = 0; pass < 2; pass++)
+	{
+		Shader& shader = blurShader.Variant((pass == 0 ? 1 : 0) | (writeBentNormals ? 2 : 0));
+		shader.use();
+		shader.setInt("occlusion", 0);
+		shader.setInt("viewNormal", 1);
+		shader.setInt("bentNormal", 2);
+		glBindFramebuffer(GL_FRAMEBUFFER, pass == 0 ? blurFBO : resultFBO);
+		glDrawBuffers(writeBentNormals ? 2 : 1, drawBuffers);
+		glActiveTexture(GL_TEXTURE0);
+		if (pass == 0)
+			glBindTexture(GL_TEXTURE_2D_ARRAY, occlusionArray);
+		else
+			glBindTexture(GL_TEXTURE_2D, blurTexture);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, normalArray);
+		glActiveTexture(GL_TEXTURE2);
+		if (pass == 0)
+			glBindTexture(GL_TEXTURE_2D_ARRAY, bentNormalArray);
+		else
+			glBindTexture(GL_TEXTURE_2D, blurBentTexture);
+		renderQuad();
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void AmbientOcclusion::BuildPyramid()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, pyramidFBO);
+	pyramidShader.use();
+	pyramidShader.setInt("deinterleavedDepth", 0);
+	pyramidShader.setInt("previousLevel", 1);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, depthPyramid);
+	for (unsigned int level = 0; level < PYRAMID_LEVELS; level++)
+	{
+		// only the level before is sampled while a level is drawn, so the pyramid isn't read & written at once.
+		if (level > 0)
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+		}
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, depthPyramid, level);
+		glViewport(0, 0, std::max(HalfSize(width) >> level, 1u), std::max(HalfSize(height) >> level, 1u));
+		pyramidShader.setInt("level", level);
+		renderQuad();
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, PYRAMID_LEVELS - 1);
+}
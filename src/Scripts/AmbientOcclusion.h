@@ -0,0 +1,98 @@
+#ifndef AMBIENT_OCCLUSION_H
+#define AMBIENT_OCCLUSION_H
+
+#include "../../vendor/glm/glm.hpp"
+
+#include "Shader.h"
+
+// Screen space ambient occlusion at half resolution. The G-buffer depth & normals are first downsampled into 2x2 deinterleaved
+// texture arrays, layer (x & 1) + 2 (y & 1) holding the half resolution pixels of that parity, so occlusion is computed one
+// quarter resolution layer per draw and neighbouring fragments' taps land on neighbouring texels. The occlusion is then blurred
+// with a separable depth & normal aware bilateral filter, which also puts the layers back together. The result keeps the linear
+// depth of each texel so the lighting pass can upsample it with a joint bilateral filter against the full resolution depth.
+// The occlusion is either sampled with a hemisphere kernel or found GTAO style from the horizons of a few screen space slices,
+// searched over a hierarchical linear depth pyramid.
+class AmbientOcclusion
+{
+public:
+	enum class Method
+	{
+		Hemisphere,		// 16 kernel samples in the normal oriented hemisphere (ssao.fs).
+		Horizon			// horizon search over the depth pyramid, integrated per slice against the normal's cosine (gtao.fs).
+	};
+
+	// 'width' & 'height' of the G-buffer.
+	AmbientOcclusion(unsigned int width, unsigned int height, void (*renderQuad)());
+	~AmbientOcclusion();
+	AmbientOcclusion(const AmbientOcclusion&) = delete;
+	AmbientOcclusion& operator=(const AmbientOcclusion&) = delete;
+
+	void Resize(unsigned int width, unsigned int height);
+	// Horizon search: 'slices' directions per pixel, 'steps' taps on each side of each. With 'bentNormals' the horizon method
+	// also keeps the average unoccluded direction (BentNormalTexture).
+	void SetMethod(Method method, unsigned int slices, unsigned int steps, bool bentNormals);
+	// With 'temporal' (TAA accumulates the lit image) the sampling pattern moves on with every 'frame' & the hemisphere method takes
+	// a quarter of its kernel per frame, the accumulated image converging on the whole kernel in every pattern position.
+	void SetTemporal(bool temporal, unsigned int frame);
+
+	// Occlusion of the G-buffer's 'depthTexture' (hardware depth of 'projection') & 'normalTexture' (octahedral world normals).
+	// 'radius' is in world units, the occlusion is raised to the power 'strength', the hemisphere method offsets depths by 'bias'.
+	// Restores the viewport, binds framebuffer 0.
+	void Render(unsigned int depthTexture, unsigned int normalTexture, const glm::mat4& view, const glm::mat4& projection,
+		float radius, float bias, float strength);
+
+	// GL_RG16F at half resolution: occlusion (1 unoccluded) & linear view depth.
+	unsigned int Texture() const { return resultTexture; }
+	// GL_RGBA8 at half resolution, world space bent normals * 0.5 + 0.5, matching Texture(). Only written by the horizon method with
+	// bent normals.
+	unsigned int BentNormalTexture() const { return resultBentTexture; }
+
+private:
+	void (*renderQuad)();
+
+	Shader downsampleShader;
+	Shader ssaoShader;
+	Shader horizonShader;	// variant 1 writes bent normals.
+	Shader pyramidShader;
+	Shader blurShader;		// variant bit 0 reads the deinterleaved occlusion, bit 1 blurs bent normals too.
+
+	unsigned int width;
+	unsigned int height;
+
+	Method method;
+	unsigned int slices;
+	unsigned int steps;
+	bool bentNormals;
+	bool temporal;
+	unsigned int frame;
+
+	// quarter resolution arrays of 4 layers: linear view depth, view space normals with the depth in alpha & occlusion.
+	unsigned int depthArray;
+	unsigned int normalArray;
+	unsigned int occlusionArray;
+	unsigned int bentNormalArray;
+	// half resolution: horizontally blurred occlusion with its depth & octahedral normal, final occlusion & depth & the bent
+	// normals of both.
+	unsigned int blurTexture;
+	unsigned int resultTexture;
+	unsigned int blurBentTexture;
+	unsigned int resultBentTexture;
+	// half resolution linear depth, each mip level the closest of 2x2 texels of the one before.
+	unsigned int depthPyramid;
+	unsigned int noiseTexture;
+
+	unsigned int downsampleFBO;
+	unsigned int pyramidFBO;
+	unsigned int occlusionFBO;
+	unsigned int blurFBO;
+	unsigned int resultFBO;
+
+	glm::vec3 kernel[16];
+
+	void CreateTargets();
+	void DeleteTargets();
+	// Fills the depth pyramid from the deinterleaved depth.
+	void BuildPyramid();
+};
+
+#endif
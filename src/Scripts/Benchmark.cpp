@@ -0,0 +1,231 @@
+#include "Benchmark.h"
+#include "GpuProfiler.h"
+
+#ifdef HEADLESS_EGL
+// no window system, the surfaceless platform doesn't need X11's headers.
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <json.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	// seconds the clock advances each frame.
+	const float FRAME_STEP = 1.0f / 60.0f;
+
+	// nearest rank percentile of 'sorted'.
+	float Percentile(const std::vector<float>& sorted, double p)
+	{
+		return sorted[std::min((size_t)std::ceil(p * sorted.size()), sorted.size()) - 1];
+	}
+
+	bool ParseCount(const char* text, unsigned int& count)
+	{
+		char* end = nullptr;
+		unsigned long value = std::strtoul(text, &end, 10);
+		if (end == text || *end != '\0')
+			return false;
+		count = (unsigned int)value;
+		return true;
+	}
+}
+
+bool Benchmark::ParseArguments(int argc, char** argv, BenchmarkSettings& settings)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (option == "--benchmark")
+			settings.enabled = true;
+		else if (option == "--frames" || option == "--warmup" || option == "--resolution" || option == "--camera-path" || option == "--output")
+		{
+			if (!hasValue)
+			{
+				std::cout << "Benchmark: " << option << " Needs A Value." << std::endl;
+				return false;
+			}
+			const char* value = argv[++i];
+			bool valid = true;
+			if (option == "--frames")
+				valid = ParseCount(value, settings.frames) && settings.frames > 0;
+			else if (option == "--warmup")
+				valid = ParseCount(value, settings.warmupFrames);
+			else if (option == "--resolution")
+				valid = std::sscanf(value, "%ux%u", &settings.width, &settings.height) == 2 && settings.width > 0 && settings.height > 0;
+			else if (option == "--camera-path")
+				settings.cameraPath = value;
+			else
+				settings.output = value;
+			if (!valid)
+			{
+				std::cout << "Benchmark: Invalid " << option << " " << value << std::endl;
+				return false;
+			}
+		}
+	}
+	if (settings.output.empty())
+		settings.output = PROJECT_DIR"/benchmark.json";
+	return true;
+}
+
+Benchmark::Benchmark(const BenchmarkSettings& settings)
+	: settings(settings), display(nullptr), surface(nullptr), context(nullptr), frame(0)
+{
+}
+
+Benchmark::~Benchmark()
+{
+#ifdef HEADLESS_EGL
+	if (display == nullptr)
+		return;
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (context != nullptr)
+		eglDestroyContext(display, context);
+	if (surface != nullptr)
+		eglDestroySurface(display, surface);
+	eglTerminate(display);
+#endif
+}
+
+bool Benchmark::CreateContext()
+{
+#ifdef HEADLESS_EGL
+	// the surfaceless platform if the EGL implementation has it, else the default display.
+	EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (clientExtensions != nullptr && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless") != nullptr && getPlatformDisplay != nullptr)
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (eglDisplay == EGL_NO_DISPLAY)
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr))
+	{
+		std::cout << "Benchmark: Failed To Initialize EGL!" << std::endl;
+		return false;
+	}
+	display = eglDisplay;
+
+	const EGLint configAttributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+										EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8, EGL_NONE };
+	EGLConfig config = nullptr;
+	EGLint configCount = 0;
+	if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << "Benchmark: No EGL Config With An OpenGL Pbuffer!" << std::endl;
+		return false;
+	}
+
+	const EGLint surfaceAttributes[] = { EGL_WIDTH, (EGLint)settings.width, EGL_HEIGHT, (EGLint)settings.height, EGL_NONE };
+	surface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttributes);
+	const EGLint contextAttributes[] = { EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 2,
+										 EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+	context = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+	if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT || !eglMakeCurrent(eglDisplay, surface, surface, context))
+	{
+		std::cout << "Benchmark: Failed To Create An OpenGL 4.2 Core Context!" << std::endl;
+		return false;
+	}
+	return true;
+#else
+	std::cout << "Benchmark: Not Supported, This Build Has No EGL!" << std::endl;
+	return false;
+#endif
+}
+
+GLADloadproc Benchmark::Loader()
+{
+#ifdef HEADLESS_EGL
+	return (GLADloadproc)eglGetProcAddress;
+#else
+	return nullptr;
+#endif
+}
+
+float Benchmark::Time() const
+{
+	return frame * FRAME_STEP;
+}
+
+float Benchmark::DeltaTime() const
+{
+	return FRAME_STEP;
+}
+
+void Benchmark::BeginFrame()
+{
+	frameStart = std::chrono::steady_clock::now();
+}
+
+void Benchmark::EndFrame(GpuProfiler& gpuProfiler)
+{
+	glFinish();
+	if (frame >= settings.warmupFrames)
+		frameMilliseconds.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+	frame++;
+	if (frame == settings.warmupFrames)
+		gpuProfiler.Reset();
+}
+
+bool Benchmark::WriteResults(GpuProfiler& gpuProfiler, const std::string& cameraPathName) const
+{
+	gpuProfiler.Flush();
+
+	nlohmann::json frameTime = nlohmann::json::object();
+	if (!frameMilliseconds.empty())
+	{
+		std::vector<float> sorted = frameMilliseconds;
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0.0;
+		for (float milliseconds : sorted)
+			sum += milliseconds;
+		frameTime = { { "mean", sum / sorted.size() }, { "p50", Percentile(sorted, 0.50) }, { "p95", Percentile(sorted, 0.95) },
+					  { "p99", Percentile(sorted, 0.99) }, { "min", sorted.front() }, { "max", sorted.back() } };
+	}
+
+	nlohmann::json gpuPasses = nlohmann::json::array();
+	for (const GpuProfiler::PassStats& pass : gpuProfiler.Stats())
+	{
+		gpuPasses.push_back({ { "name", pass.name }, { "mean", pass.average }, { "p50", pass.p50 }, { "p95", pass.p95 }, { "p99", pass.p99 },
+							  { "frames", pass.frames } });
+	}
+
+	const GLubyte* renderer = glGetString(GL_RENDERER);
+	const GLubyte* version = glGetString(GL_VERSION);
+	nlohmann::json root = {
+		{ "renderer", renderer != nullptr ? (const char*)renderer : "" },
+		{ "version", version != nullptr ? (const char*)version : "" },
+		{ "width", settings.width },
+		{ "height", settings.height },
+		{ "warmupFrames", settings.warmupFrames },
+		{ "frames", frameMilliseconds.size() },
+		{ "cameraPath", cameraPathName },
+		{ "frameTime", frameTime },
+		{ "gpuPasses", gpuPasses }
+	};
+
+	std::ofstream out(settings.output, std::ios::trunc);
+	if (!out)
+		return false;
+	out << root.dump(1, '\t');
+	if (!out.good())
+		return false;
+
+	if (!frameMilliseconds.empty())
+	{
+		std::cout << "Benchmark: " << frameMilliseconds.size() << " Frames At " << settings.width << " x " << settings.height << ", Mean "
+				  << frameTime["mean"].get<double>() << " ms, p95 " << frameTime["p95"].get<float>() << " ms, Written To " << settings.output << std::endl;
+	}
+	return true;
+}
@@ -0,0 +1,73 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "../../vendor/glad/include/glad.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+class GpuProfiler;
+
+// Options of a benchmark run, from the command line:
+// --benchmark [--frames N] [--warmup N] [--resolution WxH] [--camera-path recorded.json] [--output results.json]
+struct BenchmarkSettings
+{
+	bool enabled = false;
+	unsigned int width = 1280;
+	unsigned int height = 720;
+	unsigned int frames = 600;			// frames measured, after the warm-up.
+	unsigned int warmupFrames = 60;		// frames rendered first & left out, while lazily built shader variants & temporal history settle.
+	std::string cameraPath;				// recorded path the camera follows, a scripted orbit if empty.
+	std::string output;
+};
+
+// Renders a fixed number of frames at a fixed resolution on an offscreen EGL context, without a window or input, & writes the
+// frame time & GPU pass statistics as JSON so runs can be compared. Mesa's surfaceless platform is used where there is one, it
+// needs neither a display server nor a GPU & runs on llvmpipe. Each frame waits for the GPU before the next one starts, so a
+// frame's time is its CPU & GPU time together, & the clock advances by a fixed step so every run renders the same frames.
+class Benchmark
+{
+public:
+	// Reads the benchmark's options, others are left to the caller. Prints what's wrong & returns false on a malformed option.
+	static bool ParseArguments(int argc, char** argv, BenchmarkSettings& settings);
+
+	explicit Benchmark(const BenchmarkSettings& settings);
+	~Benchmark();
+	Benchmark(const Benchmark&) = delete;
+	Benchmark& operator=(const Benchmark&) = delete;
+
+	// Creates a GL 4.2 core context whose default framebuffer is a settings.width x settings.height pbuffer & makes it current.
+	// Prints why & returns false if that isn't possible, always so in builds without EGL.
+	bool CreateContext();
+	// Looks up the functions of the context for glad.
+	static GLADloadproc Loader();
+
+	// True until the warm-up & measured frames are rendered.
+	bool Running() const { return frame < settings.warmupFrames + settings.frames; }
+	// Seconds of the frame being rendered & the fixed step between frames.
+	float Time() const;
+	float DeltaTime() const;
+
+	// Brackets a frame, EndFrame waits for its GPU work. The GPU profiler's statistics restart once the warm-up is over.
+	void BeginFrame();
+	void EndFrame(GpuProfiler& gpuProfiler);
+
+	// Writes the statistics of the measured frames to settings.output, in milliseconds, 'cameraPathName' says which path the
+	// camera followed. Returns false if it couldn't be written.
+	bool WriteResults(GpuProfiler& gpuProfiler, const std::string& cameraPathName) const;
+
+private:
+	BenchmarkSettings settings;
+
+	// EGLDisplay, EGLSurface & EGLContext, EGL's headers stay out of the rest of the program.
+	void* display;
+	void* surface;
+	void* context;
+
+	unsigned int frame;
+	std::chrono::steady_clock::time_point frameStart;
+	std::vector<float> frameMilliseconds;
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "Bloom.h"
+
+#include <algorithm>
+
+namespace
+{
+	// levels below half resolution, fewer if the image gets smaller than MIN_LEVEL_SIZE.
+	const unsigned int MAX_LEVELS = 6;
+	const unsigned int MIN_LEVEL_SIZE = 4;
+}
+
+Bloom::Bloom(unsigned int width, unsigned int height, void (*renderQuad)())
+	: renderQuad(renderQuad),
+	downsampleShader(PROJECT_DIR"/src/Shaders/blur.vs", PROJECT_DIR"/src/Shaders/bloomDownsample.fs"),
+	upsampleShader(PROJECT_DIR"/src/Shaders/blur.vs", PROJECT_DIR"/src/Shaders/bloomUpsample.fs"),
+	width(width), height(height)
+{
+	downsampleShader.SetFeatures({ "PREFILTER" });
+	glGenFramebuffers(1, &framebuffer);
+	CreateTargets();
+}
+
+Bloom::~Bloom()
+{
+	DeleteTargets();
+	glDeleteFramebuffers(1, &framebuffer);
+}
+
+void Bloom::Resize(unsigned int width, unsigned int height)
+{
+	if (width == this->width && height == this->height)
+		return;
+	this->width = width;
+	this->height = height;
+	DeleteTargets();
+	CreateTargets();
+}
+
+unsigned int Bloom::LevelWidth(unsigned int level) const
+{
+	return std::max(width >> (level + 1), 1u);
+}
+
+unsigned int Bloom::LevelHeight(unsigned int level) const
+{
+	return std::max(height >> (level + 1), 1u);
+}
+
+void Bloom::CreateTargets()
+{
+	unsigned int count = 1;
+	while (count < MAX_LEVELS && std::min(LevelWidth(count), LevelHeight(count)) >= MIN_LEVEL_SIZE)
+		count++;
+
+	levels.resize(count);
+	glGenTextures(count, levels.data());
+	for (unsigned int level = 0; level < count; level++)
+	{
+		glBindTexture(GL_TEXTURE_2D, levels[level]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, LevelWidth(level), LevelHeight(level), 0, GL_RGB, GL_FLOAT, NULL);
+		// the filters take bilinear taps between texels.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Bloom::DeleteTargets()
+{
+	glDeleteTextures((GLsizei)levels.size(), levels.data());
+	levels.clear();
+}
+
+void Bloom::Render(unsigned int hdrTexture, float threshold, float knee, float radius)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	GLboolean blend = glIsEnabled(GL_BLEND);
+	GLint blendSource, blendDestination;
+	glGetIntegerv(GL_BLEND_SRC_RGB, &blendSource);
+	glGetIntegerv(GL_BLEND_DST_RGB, &blendDestination);
+	glDisable(GL_BLEND);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glActiveTexture(GL_TEXTURE0);
+	for (unsigned int level = 0; level < levels.size(); level++)
+	{
+		Shader& shader = downsampleShader.Variant(level == 0 ? 1 : 0);
+		shader.use();
+		shader.setInt("source", 0);
+		shader.setFloat("threshold", threshold);
+		shader.setFloat("knee", knee);
+		glBindTexture(GL_TEXTURE_2D, level == 0 ? hdrTexture : levels[level - 1]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, levels[level], 0);
+		glViewport(0, 0, LevelWidth(level), LevelHeight(level));
+		renderQuad();
+	}
+
+	// each level gets the blurred level below added, so the larger levels carry the wide blur of the smaller ones.
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+	upsampleShader.use();
+	upsampleShader.setInt("source", 0);
+	upsampleShader.setFloat("radius", radius);
+	for (unsigned int level = (unsigned int)levels.size() - 1; level > 0; level--)
+	{
+		glBindTexture(GL_TEXTURE_2D, levels[level]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, levels[level - 1], 0);
+		glViewport(0, 0, LevelWidth(level - 1), LevelHeight(level - 1));
+		renderQuad();
+	}
+
+	glBlendFunc(blendSource, blendDestination);
+	if (!blend)
+		glDisable(GL_BLEND);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
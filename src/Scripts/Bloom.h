@@ -0,0 +1,51 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include "../../vendor/glm/glm.hpp"
+
+#include "Shader.h"
+
+#include <vector>
+
+// Bloom over a mip chain of the HDR image. A 13 tap filter halves the image level by level, the first downsample also applies a
+// soft knee threshold & weighs its taps by their brightness so single bright pixels don't flicker. A 3x3 tent filter then
+// upsamples the levels back up, each added onto the next larger one. The cost only depends on the resolution, not the radius.
+class Bloom
+{
+public:
+	// 'width' & 'height' of the HDR image.
+	Bloom(unsigned int width, unsigned int height, void (*renderQuad)());
+	~Bloom();
+	Bloom(const Bloom&) = delete;
+	Bloom& operator=(const Bloom&) = delete;
+
+	void Resize(unsigned int width, unsigned int height);
+
+	// Blurs what's brighter than 'threshold' (luminance) in 'hdrTexture', fading in over 'knee' below it. 'radius' scales the
+	// upsample filter, in texels of each level. Restores the viewport, binds framebuffer 0.
+	void Render(unsigned int hdrTexture, float threshold, float knee, float radius);
+
+	// GL_R11F_G11F_B10F at half resolution, the sum of all levels' blurred brightness.
+	unsigned int Texture() const { return levels[0]; }
+	unsigned int LevelCount() const { return (unsigned int)levels.size(); }
+
+private:
+	void (*renderQuad)();
+
+	Shader downsampleShader;	// variant 1 applies the threshold.
+	Shader upsampleShader;
+
+	unsigned int width;
+	unsigned int height;
+
+	// half resolution & below, a texture per level so a level is never read while it's drawn.
+	std::vector<unsigned int> levels;
+	unsigned int framebuffer;
+
+	void CreateTargets();
+	void DeleteTargets();
+	unsigned int LevelWidth(unsigned int level) const;
+	unsigned int LevelHeight(unsigned int level) const;
+};
+
+#endif
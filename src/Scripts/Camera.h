@@ -46,9 +46,11 @@ public:
     float movementSpeedMultiplier;
     // If False, Then Camera Rotation Will Not Get Updated.
     bool updateRotation;
+    // sub-pixel offset of the projection in pixels, within (-0.5, 0.5), for temporal anti-aliasing
+    glm::vec2 Jitter;
 
     // constructor with vectors
-    Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MovementAcceleration(ACCELERATION), MouseSensitivity(SENSITIVITY), Zoom(ZOOM)
+    Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MovementAcceleration(ACCELERATION), MouseSensitivity(SENSITIVITY), Zoom(ZOOM), Jitter(0.0f)
     {
         Position = position;
         WorldUp = up;
@@ -59,7 +61,7 @@ public:
         updateCameraVectors();
     }
     // constructor with scalar values
-    Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MovementAcceleration(ACCELERATION), MouseSensitivity(SENSITIVITY), Zoom(ZOOM)
+    Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MovementAcceleration(ACCELERATION), MouseSensitivity(SENSITIVITY), Zoom(ZOOM), Jitter(0.0f)
     {
         Position = glm::vec3(posX, posY, posZ);
         WorldUp = glm::vec3(upX, upY, upZ);
@@ -75,6 +77,38 @@ public:
         return glm::lookAt(Position, Position + Front, Up);
     }
 
+    // places the camera at 'position', facing along the Euler Angles 'yaw' and 'pitch'
+    void SetPose(glm::vec3 position, float yaw, float pitch)
+    {
+        Position = position;
+        Yaw = yaw;
+        Pitch = pitch;
+        updateCameraVectors();
+    }
+
+    // sets the jitter of 'frame' from the Halton (2, 3) sequence, repeating every 'sequenceLength' frames, or clears it if not 'enabled'
+    void SetJitter(unsigned int frame, bool enabled, unsigned int sequenceLength = 8)
+    {
+        if (!enabled)
+        {
+            Jitter = glm::vec2(0.0f);
+            return;
+        }
+        // the sequence starts at index 1, index 0 of both bases is 0
+        unsigned int index = frame % sequenceLength + 1;
+        Jitter = glm::vec2(halton(index, 2), halton(index, 3)) - 0.5f;
+    }
+
+    // returns 'projection' offset by the jitter, for a viewport of 'width' x 'height' pixels
+    glm::mat4 GetJitteredProjection(const glm::mat4& projection, float width, float height) const
+    {
+        // ndc spans 2 over the viewport, the column scaling view z becomes a constant shift after the divide by w = -z
+        glm::mat4 jittered = projection;
+        jittered[2][0] -= Jitter.x * 2.0f / width;
+        jittered[2][1] -= Jitter.y * 2.0f / height;
+        return jittered;
+    }
+
     // processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
     void ProcessKeyboard(Camera_Movement direction, float deltaTime, float timeSinceInput)
     {
@@ -138,6 +172,20 @@ public:
     }
 
 private:
+    // radical inverse of 'index' in 'base', the Halton sequence in [0, 1)
+    static float halton(unsigned int index, unsigned int base)
+    {
+        float result = 0.0f;
+        float fraction = 1.0f;
+        while (index > 0)
+        {
+            fraction /= (float)base;
+            result += fraction * (float)(index % base);
+            index /= base;
+        }
+        return result;
+    }
+
     // calculates the front vector from the Camera's (updated) Euler Angles
     void updateCameraVectors()
     {
@@ -0,0 +1,111 @@
+#include "CameraPath.h"
+
+#include "../../vendor/glm/gtc/constants.hpp"
+
+#include <json.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+	// keys of the scripted orbit, close enough for the linear interpolation to stay on the circle.
+	const unsigned int ORBIT_KEYS = 64;
+}
+
+CameraPath CameraPath::Orbit(glm::vec3 center, float radius, float height, float duration, float zoom)
+{
+	CameraPath path;
+	float pitch = glm::degrees(std::atan2(-height, radius));
+	for (unsigned int key = 0; key <= ORBIT_KEYS; key++)
+	{
+		float angle = glm::two_pi<float>() * key / ORBIT_KEYS;
+		glm::vec3 position = center + glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle));
+		// facing the center is facing back along the angle. The yaw isn't wrapped, so neighbouring keys are never a turn apart.
+		path.keys.push_back({ duration * key / ORBIT_KEYS, position, glm::degrees(angle) + 180.0f, pitch, zoom });
+	}
+	return path;
+}
+
+bool CameraPath::Load(const std::string& path)
+{
+	std::ifstream in(path);
+	if (!in)
+		return false;
+	nlohmann::json root = nlohmann::json::parse(in, nullptr, false);
+	if (root.is_discarded())
+		return false;
+
+	std::vector<Key> loaded;
+	try
+	{
+		for (const nlohmann::json& key : root.at("keys"))
+		{
+			const nlohmann::json& position = key.at("position");
+			loaded.push_back({ key.at("time").get<float>(), glm::vec3(position.at(0).get<float>(), position.at(1).get<float>(), position.at(2).get<float>()),
+				key.at("yaw").get<float>(), key.at("pitch").get<float>(), key.value("zoom", ZOOM) });
+		}
+	}
+	catch (const nlohmann::json::exception&)
+	{
+		return false;
+	}
+	if (loaded.empty())
+		return false;
+	std::stable_sort(loaded.begin(), loaded.end(), [](const Key& a, const Key& b) { return a.time < b.time; });
+	keys = loaded;
+	return true;
+}
+
+bool CameraPath::Save(const std::string& path) const
+{
+	nlohmann::json keyArray = nlohmann::json::array();
+	for (const Key& key : keys)
+	{
+		keyArray.push_back({ { "time", key.time }, { "position", { key.position.x, key.position.y, key.position.z } },
+			{ "yaw", key.yaw }, { "pitch", key.pitch }, { "zoom", key.zoom } });
+	}
+	nlohmann::json root = { { "keys", keyArray } };
+
+	std::ofstream out(path, std::ios::trunc);
+	if (!out)
+		return false;
+	out << root.dump(1, '\t');
+	return out.good();
+}
+
+void CameraPath::Record(float time, const Camera& camera)
+{
+	if (keys.empty())
+		recordStart = time;
+	time -= recordStart;
+	if (!keys.empty() && time <= keys.back().time)
+		return;
+	keys.push_back({ time, camera.Position, camera.Yaw, camera.Pitch, camera.Zoom });
+}
+
+void CameraPath::Apply(float time, Camera& camera) const
+{
+	if (keys.empty())
+		return;
+	if (Duration() > 0.0f)
+		time = std::fmod(std::max(time, 0.0f), Duration());
+
+	// the first key past 'time', the pose is between it & the one before.
+	std::vector<Key>::const_iterator next = std::upper_bound(keys.begin(), keys.end(), time, [](float t, const Key& key) { return t < key.time; });
+	Key pose;
+	if (next == keys.begin())
+		pose = keys.front();
+	else if (next == keys.end())
+		pose = keys.back();
+	else
+	{
+		const Key& previous = *(next - 1);
+		float t = (time - previous.time) / (next->time - previous.time);
+		pose = { time, glm::mix(previous.position, next->position, t), glm::mix(previous.yaw, next->yaw, t), glm::mix(previous.pitch, next->pitch, t),
+			glm::mix(previous.zoom, next->zoom, t) };
+	}
+	camera.SetPose(pose.position, pose.yaw, pose.pitch);
+	camera.Zoom = pose.zoom;
+}
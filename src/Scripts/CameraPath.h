@@ -0,0 +1,47 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include "../../vendor/glm/glm.hpp"
+
+#include "Camera.h"
+
+#include <string>
+#include <vector>
+
+// Poses of the camera over time, recorded from the fly camera or scripted, & played back by the benchmark. Poses between keys
+// are interpolated linearly & the path loops past its last key. Saved as JSON:
+// { "keys": [ { "time": seconds, "position": [x, y, z], "yaw": degrees, "pitch": degrees, "zoom": degrees }, ... ] }
+class CameraPath
+{
+public:
+	struct Key
+	{
+		float time;
+		glm::vec3 position;
+		float yaw;
+		float pitch;
+		float zoom;
+	};
+
+	// A circle of 'radius' around 'center', 'height' above it & looking at it, once every 'duration' seconds.
+	static CameraPath Orbit(glm::vec3 center, float radius, float height, float duration, float zoom = ZOOM);
+
+	// Replaces the keys with the ones in 'path', returns false if it couldn't be read or has no keys.
+	bool Load(const std::string& path);
+	// Returns false if 'path' couldn't be written.
+	bool Save(const std::string& path) const;
+
+	// Appends the pose of 'camera' at 'time', which has to be past the last key's. The path starts at the first recorded time.
+	void Record(float time, const Camera& camera);
+	// Places 'camera' at the pose of 'time', leaves it as it is if the path is empty.
+	void Apply(float time, Camera& camera) const;
+
+	bool Empty() const { return keys.empty(); }
+	float Duration() const { return keys.empty() ? 0.0f : keys.back().time; }
+
+private:
+	std::vector<Key> keys;		// in order of time.
+	float recordStart = 0.0f;	// time of the first recorded pose.
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "CpuProfiler.h"
+#include "GpuProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	// markers kept per thread, a power of 2.
+	const uint64_t RING_SIZE = 1 << 15;
+	// the CPU's threads in the trace, the GPU profiler's track is a process of its own.
+	const int TRACE_PID = 1;
+
+	// written by the ring's thread & read by the export at the same time, so every field is atomic.
+	struct Marker
+	{
+		std::atomic<const char*> name;
+		std::atomic<int64_t> start;		// nanoseconds of the steady clock.
+		std::atomic<int64_t> duration;
+	};
+
+	struct OpenMarker
+	{
+		const char* name;
+		int64_t start;
+	};
+
+	struct ThreadRing
+	{
+		int id;
+		std::mutex nameMutex;
+		std::string name;
+		std::unique_ptr<Marker[]> markers{ new Marker[RING_SIZE] };
+		std::atomic<uint64_t> written{ 0 };
+		std::vector<OpenMarker> open;	// only touched by the ring's thread.
+	};
+
+	// rings outlive their threads so their markers can still be exported.
+	std::mutex ringsMutex;
+	std::vector<std::unique_ptr<ThreadRing>> rings;
+	std::atomic<bool> enabled{ true };
+
+	int64_t Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	ThreadRing& CurrentRing()
+	{
+		thread_local ThreadRing* ring = nullptr;
+		if (ring == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(ringsMutex);
+			rings.emplace_back(new ThreadRing());
+			ring = rings.back().get();
+			ring->id = (int)rings.size();
+			ring->name = "Thread " + std::to_string(ring->id);
+		}
+		return *ring;
+	}
+
+	// the ring's markers as complete ("X") events, copied while its thread may keep writing.
+	void AppendRing(ThreadRing& ring, nlohmann::json& events)
+	{
+		{
+			std::lock_guard<std::mutex> lock(ring.nameMutex);
+			events.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", TRACE_PID }, { "tid", ring.id }, { "args", { { "name", ring.name } } } });
+		}
+
+		struct Copy
+		{
+			const char* name;
+			int64_t start;
+			int64_t duration;
+		};
+		uint64_t written = ring.written.load(std::memory_order_acquire);
+		uint64_t first = written > RING_SIZE ? written - RING_SIZE : 0;
+		std::vector<Copy> copies;
+		copies.reserve((size_t)(written - first));
+		for (uint64_t index = first; index < written; index++)
+		{
+			const Marker& slot = ring.markers[index & (RING_SIZE - 1)];
+			copies.push_back({ slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed), slot.duration.load(std::memory_order_relaxed) });
+		}
+
+		// what the thread wrote over while the ring was copied may be torn, so may the slot of event 'writtenAfter' it could be
+		// writing right now, which holds event writtenAfter - RING_SIZE.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t writtenAfter = ring.written.load(std::memory_order_relaxed);
+		uint64_t firstIntact = writtenAfter + 1 > RING_SIZE ? writtenAfter + 1 - RING_SIZE : 0;
+		for (uint64_t index = std::max(first, firstIntact); index < written; index++)
+		{
+			const Copy& copy = copies[(size_t)(index - first)];
+			events.push_back({ { "name", copy.name }, { "cat", "cpu" }, { "ph", "X" }, { "ts", copy.start / 1.0e3 }, { "dur", copy.duration / 1.0e3 },
+				{ "pid", TRACE_PID }, { "tid", ring.id } });
+		}
+	}
+}
+
+void CpuProfiler::Begin(const char* name)
+{
+	ThreadRing& ring = CurrentRing();
+	// a null name keeps Begin & End paired while disabled.
+	ring.open.push_back({ enabled.load(std::memory_order_relaxed) ? name : nullptr, Now() });
+}
+
+void CpuProfiler::End()
+{
+	ThreadRing& ring = CurrentRing();
+	if (ring.open.empty())
+		return;
+	OpenMarker marker = ring.open.back();
+	ring.open.pop_back();
+	if (marker.name == nullptr)
+		return;
+
+	uint64_t index = ring.written.load(std::memory_order_relaxed);
+	Marker& slot = ring.markers[index & (RING_SIZE - 1)];
+	slot.name.store(marker.name, std::memory_order_relaxed);
+	slot.start.store(marker.start, std::memory_order_relaxed);
+	slot.duration.store(Now() - marker.start, std::memory_order_relaxed);
+	ring.written.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::SetThreadName(const std::string& name)
+{
+	ThreadRing& ring = CurrentRing();
+	std::lock_guard<std::mutex> lock(ring.nameMutex);
+	ring.name = name;
+}
+
+void CpuProfiler::SetEnabled(bool enabled)
+{
+	::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool CpuProfiler::ExportTrace(const std::string& path, const GpuProfiler* gpuProfiler)
+{
+	nlohmann::json events = nlohmann::json::array();
+	events.push_back({ { "name", "process_name" }, { "ph", "M" }, { "pid", TRACE_PID }, { "tid", 0 }, { "args", { { "name", "CPU" } } } });
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		for (const std::unique_ptr<ThreadRing>& ring : rings)
+			AppendRing(*ring, events);
+	}
+	if (gpuProfiler != nullptr)
+		gpuProfiler->AppendTraceEvents(events);
+	nlohmann::json root = { { "traceEvents", events }, { "displayTimeUnit", "ms" } };
+
+	std::ofstream out(path, std::ios::trunc);
+	if (!out)
+		return false;
+	out << root.dump();
+	return out.good();
+}
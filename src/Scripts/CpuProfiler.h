@@ -0,0 +1,40 @@
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <string>
+
+class GpuProfiler;
+
+// Scoped CPU timing markers, exported as a Chrome trace (chrome://tracing, ui.perfetto.dev). Each thread writes the markers it
+// closes into a ring of its own, so recording takes no lock & only the thread's first marker registers its ring. Rings keep
+// the last 32768 markers of their thread & are read without stopping the threads, markers overwritten while a ring is read
+// are dropped from the export. Timestamps are microseconds of the steady clock, the same as the GPU profiler's trace.
+// Marker names aren't copied, they have to outlive the export (string literals).
+class CpuProfiler
+{
+public:
+	// Times the enclosing block.
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name) { CpuProfiler::Begin(name); }
+		~Scope() { CpuProfiler::End(); }
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	// Opens & closes a marker on the calling thread, markers nest.
+	static void Begin(const char* name);
+	static void End();
+
+	// Names the calling thread's track, "Thread <n>" otherwise.
+	static void SetThreadName(const std::string& name);
+	// Markers aren't recorded while disabled, markers open when it's disabled are still closed.
+	static void SetEnabled(bool enabled);
+
+	// Writes every thread's markers to 'path', with the passes of 'gpuProfiler' on a track of their own if it's given. Returns
+	// false if the file couldn't be written.
+	static bool ExportTrace(const std::string& path, const GpuProfiler* gpuProfiler = nullptr);
+};
+
+#endif
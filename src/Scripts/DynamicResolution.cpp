@@ -0,0 +1,194 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// frames of timestamps in flight, a frame isn't timed while they're all still pending.
+	const size_t MAX_PENDING_TIMINGS = 4;
+	// the scale moves in steps of this, each step reallocates the render targets.
+	const float SCALE_STEP = 0.05f;
+	// the frames aim this far under the target, so frame to frame noise doesn't push them over it.
+	const float HEADROOM = 0.9f;
+	// the scale only goes up again once the frames take less than this of the aimed time.
+	const float LOWER_BAND = 0.8f;
+	// weight of a new timing in the running average.
+	const float TIMING_WEIGHT = 0.1f;
+	// timings averaged at a new scale before it's stepped again.
+	const unsigned int SETTLE_FRAMES = 8;
+
+	float QuantizeScale(float scale)
+	{
+		return std::round(scale / SCALE_STEP) * SCALE_STEP;
+	}
+}
+
+DynamicResolution::DynamicResolution(void (*renderQuad)())
+	: renderQuad(renderQuad),
+	upscaleShader(PROJECT_DIR"/src/Shaders/blur.vs", PROJECT_DIR"/src/Shaders/upscale.fs"),
+	dynamic(false), targetMilliseconds(16.6f), minScale(0.5f), scale(1.0f),
+	averageMilliseconds(0.0f), averagedFrames(0),
+	outputWidth(1), outputHeight(1), width(1), height(1),
+	framebuffer(0), texture(0), textureWidth(0), textureHeight(0),
+	timing(false)
+{
+}
+
+DynamicResolution::~DynamicResolution()
+{
+	for (const PendingTiming& pending : pendingTimings)
+	{
+		freeQueries.push_back(pending.begin);
+		freeQueries.push_back(pending.end);
+	}
+	if (!freeQueries.empty())
+		glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+	glDeleteTextures(1, &texture);
+	glDeleteFramebuffers(1, &framebuffer);
+}
+
+void DynamicResolution::SetFixedScale(float scale)
+{
+	dynamic = false;
+	SetScale(QuantizeScale(std::min(std::max(scale, SCALE_STEP), 1.0f)));
+}
+
+void DynamicResolution::SetTarget(float frameMilliseconds, float minScale)
+{
+	this->minScale = QuantizeScale(std::min(std::max(minScale, SCALE_STEP), 1.0f));
+	if (!dynamic || frameMilliseconds != targetMilliseconds)
+		averagedFrames = 0;
+	dynamic = true;
+	targetMilliseconds = frameMilliseconds;
+	SetScale(std::max(scale, this->minScale));
+}
+
+void DynamicResolution::SetScale(float scale)
+{
+	if (scale == this->scale)
+		return;
+	this->scale = scale;
+	// the average so far was taken at the old resolution.
+	averageMilliseconds = 0.0f;
+	averagedFrames = 0;
+}
+
+unsigned int DynamicResolution::NewQuery()
+{
+	if (freeQueries.empty())
+	{
+		unsigned int query;
+		glGenQueries(1, &query);
+		return query;
+	}
+	unsigned int query = freeQueries.back();
+	freeQueries.pop_back();
+	return query;
+}
+
+void DynamicResolution::BeginTiming()
+{
+	timing = pendingTimings.size() < MAX_PENDING_TIMINGS;
+	if (!timing)
+		return;
+	pendingTimings.push_back({ NewQuery(), NewQuery(), scale });
+	glQueryCounter(pendingTimings.back().begin, GL_TIMESTAMP);
+}
+
+void DynamicResolution::EndTiming()
+{
+	if (!timing)
+		return;
+	glQueryCounter(pendingTimings.back().end, GL_TIMESTAMP);
+	timing = false;
+}
+
+void DynamicResolution::CollectTimings()
+{
+	// queries complete in order, stop at the first one that isn't done. The frame being timed is never done.
+	size_t collected = 0;
+	for (; collected < pendingTimings.size() - (timing ? 1 : 0); collected++)
+	{
+		const PendingTiming& pending = pendingTimings[collected];
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(pending.end, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(pending.begin, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(pending.end, GL_QUERY_RESULT, &end);
+		freeQueries.push_back(pending.begin);
+		freeQueries.push_back(pending.end);
+		if (pending.scale != scale)
+			continue;
+
+		float milliseconds = (float)((end - begin) / 1.0e6);
+		averageMilliseconds = averagedFrames == 0 ? milliseconds : averageMilliseconds + (milliseconds - averageMilliseconds) * TIMING_WEIGHT;
+		averagedFrames++;
+	}
+	pendingTimings.erase(pendingTimings.begin(), pendingTimings.begin() + collected);
+}
+
+void DynamicResolution::StepScale()
+{
+	if (!dynamic || averagedFrames < SETTLE_FRAMES)
+		return;
+
+	float aim = targetMilliseconds * HEADROOM;
+	if (averageMilliseconds <= aim && averageMilliseconds >= aim * LOWER_BAND)
+		return;
+
+	// the passes' cost mostly follows their pixel count, the square of the scale.
+	float next = QuantizeScale(scale * std::sqrt(aim / std::max(averageMilliseconds, 1e-3f)));
+	if (averageMilliseconds > aim)
+		next = std::min(next, scale - SCALE_STEP);
+	SetScale(std::min(std::max(next, minScale), 1.0f));
+}
+
+void DynamicResolution::Update(unsigned int outputWidth, unsigned int outputHeight)
+{
+	CollectTimings();
+	StepScale();
+
+	this->outputWidth = std::max(outputWidth, 1u);
+	this->outputHeight = std::max(outputHeight, 1u);
+	width = std::max((unsigned int)std::lround(this->outputWidth * scale), 1u);
+	height = std::max((unsigned int)std::lround(this->outputHeight * scale), 1u);
+
+	if (!Upscaling() || (width == textureWidth && height == textureHeight))
+		return;
+
+	if (framebuffer == 0)
+	{
+		glGenFramebuffers(1, &framebuffer);
+		glGenTextures(1, &texture);
+	}
+	textureWidth = width;
+	textureHeight = height;
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	// only read with texelFetch.
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DynamicResolution::Upscale(float sharpness)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, outputWidth, outputHeight);
+
+	upscaleShader.use();
+	upscaleShader.setInt("image", 0);
+	upscaleShader.setFloat("sharpness", sharpness);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	renderQuad();
+}
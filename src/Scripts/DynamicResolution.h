@@ -0,0 +1,89 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include "../../vendor/glm/glm.hpp"
+
+#include "Shader.h"
+
+#include <vector>
+
+// Renders the 3D passes at a fraction of the window's resolution & upscales the post processed image to it. The fraction either
+// stays where it's set or follows the GPU time of the frames: each frame is bracketed by timestamp queries, read back a few
+// frames later so the CPU never waits on them, & the scale steps down while the frames take longer than the target & back up
+// once they've got room to spare. The upscaler sharpens as it upscales (AMD FidelityFX CAS's scaling mode).
+class DynamicResolution
+{
+public:
+	DynamicResolution(void (*renderQuad)());
+	~DynamicResolution();
+	DynamicResolution(const DynamicResolution&) = delete;
+	DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+	// Renders at 'scale' of the output resolution on each axis.
+	void SetFixedScale(float scale);
+	// Scales between 'minScale' & 1 to keep the GPU time of a frame within 'frameMilliseconds'.
+	void SetTarget(float frameMilliseconds, float minScale);
+
+	// Timestamps around the GPU work of a frame, EndTiming after the last pass that should count.
+	void BeginTiming();
+	void EndTiming();
+
+	// Collects the timings that are done, steps the scale if needed & sizes the render resolution for an output of 'outputWidth'
+	// by 'outputHeight'. Call once a frame before rendering.
+	void Update(unsigned int outputWidth, unsigned int outputHeight);
+
+	unsigned int Width() const { return width; }
+	unsigned int Height() const { return height; }
+	float Scale() const { return scale; }
+	// Running average of the GPU time of the frames at the current scale, 0 until the first one is read back.
+	float GpuMilliseconds() const { return averageMilliseconds; }
+	// True if the post processed image goes through the upscaler, while the scale is dynamic or below 1.
+	bool Upscaling() const { return dynamic || scale < 1.0f; }
+
+	// Framebuffer the post processing pass draws into while Upscaling(), Width() x Height() GL_RGBA8 in display encoding.
+	unsigned int Framebuffer() const { return framebuffer; }
+	// Upscales Framebuffer() to the output, 'sharpness' from 0 to 1. Binds framebuffer 0 & leaves the viewport at the output size.
+	void Upscale(float sharpness);
+
+private:
+	struct PendingTiming
+	{
+		unsigned int begin;
+		unsigned int end;
+		float scale;	// scale of the timed frame, timings of another scale are dropped.
+	};
+
+	void (*renderQuad)();
+
+	Shader upscaleShader;
+
+	bool dynamic;
+	float targetMilliseconds;
+	float minScale;
+	float scale;
+
+	float averageMilliseconds;
+	unsigned int averagedFrames;
+
+	unsigned int outputWidth;
+	unsigned int outputHeight;
+	unsigned int width;
+	unsigned int height;
+
+	// the upscaler's input, only allocated while upscaling.
+	unsigned int framebuffer;
+	unsigned int texture;
+	unsigned int textureWidth;
+	unsigned int textureHeight;
+
+	std::vector<PendingTiming> pendingTimings;
+	std::vector<unsigned int> freeQueries;
+	bool timing;
+
+	void CollectTimings();
+	void StepScale();
+	void SetScale(float scale);
+	unsigned int NewQuery();
+};
+
+#endif
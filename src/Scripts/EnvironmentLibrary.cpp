@@ -0,0 +1,244 @@
+#include "EnvironmentLibrary.h"
+
+#include "../../vendor/glad/include/glad.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+EnvironmentLibrary::EnvironmentLibrary(const std::vector<std::string>& paths, const IBLBakeSettings& settings, ThreadPool& pool, unsigned int residentLimit)
+	: settings(settings), pool(pool), environments(paths.size()), residentLimit(std::max(residentLimit, 2u)), useCounter(0), focus(-1), selected(-1)
+{
+	for (size_t i = 0; i < paths.size(); i++)
+		environments[i].path = paths[i];
+}
+
+EnvironmentLibrary::~EnvironmentLibrary()
+{
+	// The GL context may already be gone here, only the decodes are waited for.
+	for (Environment& environment : environments)
+		if (environment.decode.valid())
+			environment.decode.wait();
+}
+
+void EnvironmentLibrary::Select(int environment, bool needsSource)
+{
+	focus = environment;
+	selected = needsSource ? environment : -1;
+	int first = std::max(environment - 1, 0);
+	int last = std::min(environment + 1, Count() - 1);
+
+	// the selected environment first, the pool runs tasks in order.
+	if (needsSource)
+		StartDecode(environment);
+	for (int i = first; i <= last; i++)
+		if (i != environment)
+			StartDecode(i);
+
+	// prefetched pixels that are no longer next to the selection are dropped, decodes in flight are dropped when they finish.
+	for (int i = 0; i < Count(); i++)
+		if ((i < first || i > last) && !environments[i].decode.valid())
+			environments[i].image.reset();
+}
+
+void EnvironmentLibrary::StartDecode(int index)
+{
+	Environment& environment = environments[index];
+	if (environment.image || environment.uploaded)
+		return;
+
+	std::shared_ptr<DecodedImage> image = std::make_shared<DecodedImage>();
+	environment.image = image;
+	std::string path = environment.path;
+	ThreadPool& threadPool = pool;
+	environment.decode = pool.Submit([image, path, &threadPool]()
+	{
+		image->loaded = LoadRadianceHDR(path.c_str(), image->image, threadPool);
+		// the SH projection is done while the pixels are in memory anyway.
+		if (image->loaded)
+			image->sh = ProjectEquirectangularSH9(image->image.pixels.data(), image->image.width, image->image.height, 4, threadPool);
+	});
+}
+
+bool EnvironmentLibrary::Decoded(const Environment& environment) const
+{
+	return environment.decode.valid() && environment.decode.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void EnvironmentLibrary::Update()
+{
+	int first = std::max(focus - 1, 0);
+	int last = std::min(focus + 1, Count() - 1);
+	for (int i = 0; i < Count(); i++)
+	{
+		Environment& environment = environments[i];
+		if (!Decoded(environment))
+			continue;
+		environment.decode.get();
+		environment.sh = environment.image->sh;
+		if (i == selected)
+			Upload(environment);
+		else if (i < first || i > last)
+			environment.image.reset();
+	}
+
+	// a prefetched environment that got selected is uploaded right away.
+	if (selected >= 0 && !environments[selected].uploaded && environments[selected].image && !environments[selected].decode.valid())
+		Upload(environments[selected]);
+}
+
+void EnvironmentLibrary::WaitForSelected()
+{
+	if (selected < 0)
+		return;
+	if (environments[selected].decode.valid())
+		environments[selected].decode.wait();
+	Update();
+}
+
+void EnvironmentLibrary::Upload(Environment& environment)
+{
+	const DecodedImage& decoded = *environment.image;
+	if (decoded.loaded)
+	{
+		// already half floats, the driver only has to drop the alpha.
+		glGenTextures(1, &environment.sourceTexture);
+		glBindTexture(GL_TEXTURE_2D, environment.sourceTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, decoded.image.width, decoded.image.height, 0, GL_RGBA, GL_HALF_FLOAT, decoded.image.pixels.data());
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	else
+	{
+		std::cout << "Failed to load HDR image " << environment.path << std::endl;
+	}
+
+	// the pixels are only needed for the upload.
+	environment.image.reset();
+	environment.uploaded = true;
+}
+
+bool EnvironmentLibrary::SourceReady(int environment) const
+{
+	return environments[environment].uploaded;
+}
+
+void EnvironmentLibrary::ReleaseSource(int index)
+{
+	Environment& environment = environments[index];
+	if (environment.sourceTexture)
+		glDeleteTextures(1, &environment.sourceTexture);
+	environment.sourceTexture = 0;
+	environment.uploaded = false;
+}
+
+void EnvironmentLibrary::ReleaseSourcesExcept(int environment)
+{
+	for (int i = 0; i < Count(); i++)
+		if (i != environment && environments[i].uploaded)
+			ReleaseSource(i);
+}
+
+int EnvironmentLibrary::FindMaps(int environment, bool withIrradiance) const
+{
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		const MapSlot& slot = slots[i];
+		if (slot.environment == environment && slot.baked && (slot.maps.hasIrradiance || !withIrradiance))
+			return (int)i;
+	}
+	return -1;
+}
+
+int EnvironmentLibrary::AcquireMaps(int environment, int pinnedSlot, int otherPinnedSlot)
+{
+	const auto pinned = [&](size_t i) { return (int)i == pinnedSlot || (int)i == otherPinnedSlot; };
+
+	// the maps of a cancelled bake are free again, only one bake runs at a time.
+	for (MapSlot& slot : slots)
+		if (!slot.baked)
+			slot.environment = -1;
+
+	// a free allocated slot, else a new one while under the limit, else the least recently used unpinned slot.
+	int chosen = -1;
+	for (size_t i = 0; i < slots.size() && chosen < 0; i++)
+		if (!pinned(i) && slots[i].maps.envCubemap && slots[i].environment < 0)
+			chosen = (int)i;
+	if (chosen < 0 && ResidentCount() >= residentLimit)
+	{
+		for (size_t i = 0; i < slots.size(); i++)
+			if (!pinned(i) && slots[i].maps.envCubemap && (chosen < 0 || slots[i].lastUsed < slots[chosen].lastUsed))
+				chosen = (int)i;
+	}
+	if (chosen < 0)
+	{
+		for (size_t i = 0; i < slots.size() && chosen < 0; i++)
+			if (!slots[i].maps.envCubemap)
+				chosen = (int)i;
+		if (chosen < 0)
+		{
+			slots.emplace_back();
+			chosen = (int)slots.size() - 1;
+		}
+		slots[chosen].maps = CreateIBLMaps(settings);
+	}
+
+	MapSlot& slot = slots[chosen];
+	slot.environment = environment;
+	slot.baked = false;
+	Touch(chosen);
+	return chosen;
+}
+
+void EnvironmentLibrary::FinishMaps(int index, const IBLMaps& baked)
+{
+	MapSlot& slot = slots[index];
+	slot.maps.hasIrradiance = baked.hasIrradiance;
+	slot.baked = true;
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		if ((int)i != index && slots[i].environment == slot.environment)
+		{
+			slots[i].environment = -1;
+			slots[i].baked = false;
+		}
+	}
+	Touch(index);
+}
+
+void EnvironmentLibrary::SetResidentLimit(unsigned int limit, int pinnedSlot, int otherPinnedSlot)
+{
+	residentLimit = std::max(limit, 2u);
+	while (ResidentCount() > residentLimit)
+	{
+		// free slots go first, then the least recently used.
+		int victim = -1;
+		for (size_t i = 0; i < slots.size(); i++)
+		{
+			// maps being baked are never deleted.
+			bool baking = slots[i].environment >= 0 && !slots[i].baked;
+			if ((int)i == pinnedSlot || (int)i == otherPinnedSlot || !slots[i].maps.envCubemap || baking)
+				continue;
+			if (victim < 0 || (slots[i].environment < 0) > (slots[victim].environment < 0) ||
+				((slots[i].environment < 0) == (slots[victim].environment < 0) && slots[i].lastUsed < slots[victim].lastUsed))
+				victim = (int)i;
+		}
+		if (victim < 0)
+			break;
+		DeleteIBLMaps(slots[victim].maps);
+		slots[victim].environment = -1;
+		slots[victim].baked = false;
+	}
+}
+
+unsigned int EnvironmentLibrary::ResidentCount() const
+{
+	unsigned int count = 0;
+	for (const MapSlot& slot : slots)
+		if (slot.maps.envCubemap)
+			count++;
+	return count;
+}
@@ -0,0 +1,103 @@
+#ifndef ENVIRONMENT_LIBRARY_H
+#define ENVIRONMENT_LIBRARY_H
+
+#include "IBLBaker.h"
+#include "RadianceHDR.h"
+#include "SphericalHarmonics.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+// HDR environments loaded on demand. Selecting an environment decodes it (and prefetches its neighbours) on the thread pool,
+// only the selected one is uploaded as an equirectangular source texture for the IBL baker, and only until its bake is done.
+// Baked IBL maps are kept in a bounded set of slots, the least recently used environment's maps are evicted first.
+class EnvironmentLibrary
+{
+public:
+	EnvironmentLibrary(const std::vector<std::string>& paths, const IBLBakeSettings& settings, ThreadPool& pool, unsigned int residentLimit);
+	~EnvironmentLibrary();
+	EnvironmentLibrary(const EnvironmentLibrary&) = delete;
+	EnvironmentLibrary& operator=(const EnvironmentLibrary&) = delete;
+
+	int Count() const { return (int)environments.size(); }
+	const char* Path(int environment) const { return environments[environment].path.c_str(); }
+
+	// Starts decoding 'environment' & its neighbours if they aren't in memory, decoded neighbours of other environments are dropped.
+	// Pass false as needsSource when the environment's maps are resident, then only the neighbours are prefetched.
+	void Select(int environment, bool needsSource);
+	// Uploads the selected environment once it's decoded. Call once per frame on the GL thread.
+	void Update();
+	// Blocks until the selected environment is decoded & uploaded.
+	void WaitForSelected();
+
+	// True once the environment's source texture is uploaded (or failed to load, the texture is 0 then).
+	bool SourceReady(int environment) const;
+	unsigned int SourceTexture(int environment) const { return environments[environment].sourceTexture; }
+	// Deletes source textures that are no longer needed by a bake.
+	void ReleaseSource(int environment);
+	void ReleaseSourcesExcept(int environment);
+	// SH projection of the environment's radiance, zero until it has been decoded once.
+	const SH9& SH(int environment) const { return environments[environment].sh; }
+
+	// Slot holding the baked maps of an environment, -1 if they aren't resident.
+	int FindMaps(int environment, bool withIrradiance) const;
+	// Slot to bake 'environment' into, never a pinned slot (-1 pins nothing). Reuses a free slot, allocates one while under the
+	// resident limit or evicts the least recently used maps.
+	int AcquireMaps(int environment, int pinnedSlot, int otherPinnedSlot);
+	// Marks a slot's bake as done, 'baked' tells whether it has an irradiance map. Other maps of the environment become free.
+	void FinishMaps(int slot, const IBLMaps& baked);
+	const IBLMaps& Maps(int slot) const { return slots[slot].maps; }
+	// Marks a slot as used this frame for the LRU order.
+	void Touch(int slot) { slots[slot].lastUsed = ++useCounter; }
+
+	// Deletes unpinned maps until at most 'limit' (at least 2) slots are allocated.
+	void SetResidentLimit(unsigned int limit, int pinnedSlot, int otherPinnedSlot);
+	unsigned int ResidentLimit() const { return residentLimit; }
+	unsigned int ResidentCount() const;
+
+private:
+	// Half float pixels of a decoded HDR file, filled on a worker thread.
+	struct DecodedImage
+	{
+		bool loaded = false;
+		HalfImage image;
+		SH9 sh;
+	};
+
+	struct Environment
+	{
+		std::string path;
+		std::shared_ptr<DecodedImage> image;	// in memory while decoding or prefetched.
+		std::future<void> decode;				// valid while decoding.
+		unsigned int sourceTexture = 0;
+		bool uploaded = false;
+		SH9 sh;
+	};
+
+	struct MapSlot
+	{
+		IBLMaps maps;			// envCubemap is 0 while the slot isn't allocated.
+		int environment = -1;	// -1 if free.
+		bool baked = false;
+		uint64_t lastUsed = 0;
+	};
+
+	IBLBakeSettings settings;
+	ThreadPool& pool;
+	std::vector<Environment> environments;
+	std::vector<MapSlot> slots;
+	unsigned int residentLimit;
+	uint64_t useCounter;
+	int focus;		// environment whose neighbours are prefetched.
+	int selected;	// environment whose source is uploaded, -1 if none.
+
+	void StartDecode(int environment);
+	bool Decoded(const Environment& environment) const;
+	void Upload(Environment& environment);
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "../../vendor/glm/glm.hpp"
+
+#include <cmath>
+
+// Axis aligned bounding box.
+struct AABB
+{
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    AABB() = default;
+    AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+
+    // Grows the box to contain 'point'.
+    void Expand(const glm::vec3& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    // Box around this box transformed by 'matrix' (an affine transform), from the transformed center & extents.
+    AABB Transformed(const glm::mat4& matrix) const
+    {
+        glm::vec3 center = glm::vec3(matrix * glm::vec4((min + max) * 0.5f, 1.0f));
+        glm::vec3 extents = (max - min) * 0.5f;
+        glm::vec3 transformedExtents;
+        for (int row = 0; row < 3; row++)
+            transformedExtents[row] = std::fabs(matrix[0][row]) * extents.x + std::fabs(matrix[1][row]) * extents.y + std::fabs(matrix[2][row]) * extents.z;
+        return AABB(center - transformedExtents, center + transformedExtents);
+    }
+};
+
+// The 6 planes of a view projection's clip volume, normals pointing inside.
+class Frustum
+{
+public:
+    Frustum() = default;
+
+    // Planes extracted from the rows of 'viewProjection' (Gribb & Hartmann), for a GL clip space with -w <= z <= w.
+    explicit Frustum(const glm::mat4& viewProjection)
+    {
+        glm::vec4 rows[4];
+        for (int row = 0; row < 4; row++)
+            rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+
+        planes[0] = rows[3] + rows[0]; // left
+        planes[1] = rows[3] - rows[0]; // right
+        planes[2] = rows[3] + rows[1]; // bottom
+        planes[3] = rows[3] - rows[1]; // top
+        planes[4] = rows[3] + rows[2]; // near
+        planes[5] = rows[3] - rows[2]; // far
+        for (glm::vec4& plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    // False only if the box is completely outside one of the planes, boxes near the frustum's corners can pass while outside.
+    bool Intersects(const AABB& box) const
+    {
+        for (const glm::vec4& plane : planes)
+        {
+            // the corner furthest along the plane's normal.
+            glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x, plane.y >= 0.0f ? box.max.y : box.min.y, plane.z >= 0.0f ? box.max.z : box.min.z);
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    // False only if the sphere is completely outside one of the planes.
+    bool Intersects(const glm::vec3& center, float radius) const
+    {
+        for (const glm::vec4& plane : planes)
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+                return false;
+        return true;
+    }
+
+private:
+    glm::vec4 planes[6];
+};
+
+#endif
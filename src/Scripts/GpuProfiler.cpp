@@ -0,0 +1,228 @@
+#include "GpuProfiler.h"
+
+#include "../../vendor/glad/include/glad.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+	// frames of queries in flight, a frame isn't profiled while they're all still pending.
+	const size_t MAX_PENDING_FRAMES = 4;
+	// the GPU's track in the trace, a process of its own next to the CPU's threads.
+	const int TRACE_PID = 2;
+	const int TRACE_TID = 0;
+}
+
+GpuProfiler::GpuProfiler(unsigned int historyFrames, unsigned int traceFrames)
+	: historyFrames(std::max(historyFrames, 1u)), traceFrames(traceFrames), frame(0), profiling(false), depth(0)
+{
+	passes.push_back({ "Frame", std::vector<float>(this->historyFrames), 0, 0, 0.0f });
+	GLint64 gpuTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	syncGpuTime = gpuTime;
+	syncTime = std::chrono::steady_clock::now();
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for (const PendingFrame& pending : pendingFrames)
+	{
+		for (const Scope& scope : pending.scopes)
+		{
+			freeTimestampQueries.push_back(scope.startQuery);
+			freeElapsedQueries.push_back(scope.elapsedQuery);
+		}
+	}
+	if (!freeTimestampQueries.empty())
+		glDeleteQueries((GLsizei)freeTimestampQueries.size(), freeTimestampQueries.data());
+	if (!freeElapsedQueries.empty())
+		glDeleteQueries((GLsizei)freeElapsedQueries.size(), freeElapsedQueries.data());
+}
+
+unsigned int GpuProfiler::NewQuery(std::vector<unsigned int>& freeQueries)
+{
+	if (freeQueries.empty())
+	{
+		unsigned int query;
+		glGenQueries(1, &query);
+		return query;
+	}
+	unsigned int query = freeQueries.back();
+	freeQueries.pop_back();
+	return query;
+}
+
+unsigned int GpuProfiler::PassIndex(const char* name)
+{
+	for (unsigned int pass = 1; pass < passes.size(); pass++)
+	{
+		if (passes[pass].name == name)
+			return pass;
+	}
+	passes.push_back({ name, std::vector<float>(historyFrames), 0, 0, 0.0f });
+	return (unsigned int)passes.size() - 1;
+}
+
+void GpuProfiler::BeginFrame()
+{
+	Collect();
+	frame++;
+	depth = 0;
+	profiling = pendingFrames.size() < MAX_PENDING_FRAMES;
+	if (profiling)
+		pendingFrames.push_back({ frame, {} });
+}
+
+void GpuProfiler::Begin(const char* name)
+{
+	if (depth++ > 0 || !profiling)
+		return;
+	Scope scope = { PassIndex(name), NewQuery(freeTimestampQueries), NewQuery(freeElapsedQueries) };
+	glQueryCounter(scope.startQuery, GL_TIMESTAMP);
+	glBeginQuery(GL_TIME_ELAPSED, scope.elapsedQuery);
+	pendingFrames.back().scopes.push_back(scope);
+}
+
+void GpuProfiler::End()
+{
+	if (depth == 0 || --depth > 0 || !profiling)
+		return;
+	glEndQuery(GL_TIME_ELAPSED);
+}
+
+void GpuProfiler::Flush()
+{
+	glFinish();
+	Collect();
+}
+
+void GpuProfiler::Reset()
+{
+	Flush();
+	for (PassHistory& history : passes)
+	{
+		history.next = 0;
+		history.count = 0;
+		history.last = 0.0f;
+	}
+}
+
+void GpuProfiler::Record(unsigned int pass, float milliseconds)
+{
+	PassHistory& history = passes[pass];
+	history.milliseconds[history.next] = milliseconds;
+	history.next = (history.next + 1) % historyFrames;
+	history.count = std::min(history.count + 1, historyFrames);
+	history.last = milliseconds;
+}
+
+void GpuProfiler::Collect()
+{
+	// queries complete in order, stop at the first frame whose last query isn't done.
+	size_t collected = 0;
+	std::vector<float> frameMilliseconds;
+	double syncMicroseconds = std::chrono::duration<double, std::micro>(syncTime.time_since_epoch()).count();
+	for (; collected < pendingFrames.size(); collected++)
+	{
+		const PendingFrame& pending = pendingFrames[collected];
+		if (!pending.scopes.empty())
+		{
+			GLint available = GL_FALSE;
+			glGetQueryObjectiv(pending.scopes.back().elapsedQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				break;
+		}
+
+		// a pass may run more than once a frame, its time is the sum.
+		frameMilliseconds.assign(passes.size(), -1.0f);
+		float total = 0.0f;
+		for (const Scope& scope : pending.scopes)
+		{
+			GLuint64 start = 0, elapsed = 0;
+			glGetQueryObjectui64v(scope.startQuery, GL_QUERY_RESULT, &start);
+			glGetQueryObjectui64v(scope.elapsedQuery, GL_QUERY_RESULT, &elapsed);
+			freeTimestampQueries.push_back(scope.startQuery);
+			freeElapsedQueries.push_back(scope.elapsedQuery);
+
+			float milliseconds = (float)(elapsed / 1.0e6);
+			frameMilliseconds[scope.pass] = std::max(frameMilliseconds[scope.pass], 0.0f) + milliseconds;
+			total += milliseconds;
+			if (traceFrames > 0)
+				trace.push_back({ scope.pass, pending.frame, syncMicroseconds + ((long long)start - syncGpuTime) / 1.0e3, elapsed / 1.0e3 });
+		}
+		for (unsigned int pass = 1; pass < frameMilliseconds.size(); pass++)
+		{
+			if (frameMilliseconds[pass] >= 0.0f)
+				Record(pass, frameMilliseconds[pass]);
+		}
+		if (!pending.scopes.empty())
+			Record(0, total);
+	}
+	if (collected == 0)
+		return;
+
+	unsigned long long lastFrame = pendingFrames[collected - 1].frame;
+	pendingFrames.erase(pendingFrames.begin(), pendingFrames.begin() + collected);
+
+	// the trace only keeps the last traceFrames frames.
+	size_t expired = 0;
+	while (expired < trace.size() && trace[expired].frame + traceFrames <= lastFrame)
+		expired++;
+	trace.erase(trace.begin(), trace.begin() + expired);
+}
+
+GpuProfiler::PassStats GpuProfiler::ComputeStats(const PassHistory& history)
+{
+	PassStats stats = { history.name, 0.0f, 0.0f, 0.0f, 0.0f, history.last, history.count };
+	if (history.count == 0)
+		return stats;
+
+	// the ring is only full once historyFrames frames were recorded, before that the first 'count' entries are used.
+	std::vector<float> sorted(history.milliseconds.begin(), history.milliseconds.begin() + history.count);
+	std::sort(sorted.begin(), sorted.end());
+	double sum = 0.0;
+	for (float milliseconds : sorted)
+		sum += milliseconds;
+	stats.average = (float)(sum / sorted.size());
+	// nearest rank percentiles.
+	auto percentile = [&](double p) { return sorted[std::min((size_t)std::ceil(p * sorted.size()), sorted.size()) - 1]; };
+	stats.p50 = percentile(0.50);
+	stats.p95 = percentile(0.95);
+	stats.p99 = percentile(0.99);
+	return stats;
+}
+
+std::vector<GpuProfiler::PassStats> GpuProfiler::Stats() const
+{
+	std::vector<PassStats> stats;
+	for (unsigned int pass = 1; pass < passes.size(); pass++)
+		stats.push_back(ComputeStats(passes[pass]));
+	stats.push_back(ComputeStats(passes[0]));
+	return stats;
+}
+
+void GpuProfiler::AppendTraceEvents(nlohmann::json& events) const
+{
+	events.push_back({ { "name", "process_name" }, { "ph", "M" }, { "pid", TRACE_PID }, { "tid", TRACE_TID }, { "args", { { "name", "GPU" } } } });
+	events.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", TRACE_PID }, { "tid", TRACE_TID }, { "args", { { "name", "GL Queue" } } } });
+	for (const TraceEvent& event : trace)
+	{
+		events.push_back({ { "name", passes[event.pass].name }, { "cat", "gpu" }, { "ph", "X" }, { "ts", event.start }, { "dur", event.duration },
+			{ "pid", TRACE_PID }, { "tid", TRACE_TID }, { "args", { { "frame", event.frame } } } });
+	}
+}
+
+bool GpuProfiler::ExportTrace(const std::string& path) const
+{
+	nlohmann::json events = nlohmann::json::array();
+	AppendTraceEvents(events);
+	nlohmann::json root = { { "traceEvents", events }, { "displayTimeUnit", "ms" } };
+
+	std::ofstream out(path, std::ios::trunc);
+	if (!out)
+		return false;
+	out << root.dump();
+	return out.good();
+}
@@ -0,0 +1,109 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <json.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// GPU time of the passes of a frame from GL_TIME_ELAPSED queries, with a GL_TIMESTAMP where each pass starts for the trace. The
+// queries of the last few frames are kept in a ring & read back once they're done, so reading them never waits on the GPU, a
+// frame isn't profiled if the GPU is further behind than the ring. Each pass keeps the times of its last frames for running
+// averages & percentiles, the last frames' passes can be exported as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+// GL_TIME_ELAPSED queries can't nest, a scope begun inside another is folded into it & nothing else may time the GPU with
+// GL_TIME_ELAPSED inside a scope (the IBL baker's queries run outside of them).
+class GpuProfiler
+{
+public:
+	struct PassStats
+	{
+		std::string name;
+		float average;		// milliseconds, as are the percentiles.
+		float p50;
+		float p95;
+		float p99;
+		float last;
+		unsigned int frames;	// frames the statistics are over.
+	};
+
+	// Statistics are over the last 'historyFrames' frames a pass ran in, the trace covers the last 'traceFrames' frames.
+	GpuProfiler(unsigned int historyFrames = 240, unsigned int traceFrames = 120);
+	~GpuProfiler();
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	// Reads back the frames that are done & starts a new one, call before the first scope of each frame.
+	void BeginFrame();
+	// Times the GPU work submitted until End() as the pass 'name', which should stay the same from frame to frame.
+	void Begin(const char* name);
+	void End();
+
+	// Waits for the GPU & reads back every frame still in flight.
+	void Flush();
+	// Reads back the frames in flight & forgets the passes' times, the statistics start over from the next frame.
+	void Reset();
+
+	// Passes in the order they first ran, plus "Frame", the sum of the passes of each frame.
+	std::vector<PassStats> Stats() const;
+	// Appends the trace's complete ("X") events to a Chrome trace 'events' array, timestamps in microseconds of the steady clock.
+	void AppendTraceEvents(nlohmann::json& events) const;
+	// Writes the trace to 'path', returns false if it couldn't be written.
+	bool ExportTrace(const std::string& path) const;
+
+private:
+	struct Scope
+	{
+		unsigned int pass;
+		unsigned int startQuery;	// GL_TIMESTAMP
+		unsigned int elapsedQuery;	// GL_TIME_ELAPSED
+	};
+
+	struct PendingFrame
+	{
+		unsigned long long frame;
+		std::vector<Scope> scopes;
+	};
+
+	struct TraceEvent
+	{
+		unsigned int pass;
+		unsigned long long frame;
+		double start;		// microseconds of the steady clock.
+		double duration;
+	};
+
+	struct PassHistory
+	{
+		std::string name;
+		std::vector<float> milliseconds;	// ring of the last historyFrames frames.
+		unsigned int next;
+		unsigned int count;
+		float last;
+	};
+
+	unsigned int historyFrames;
+	unsigned int traceFrames;
+
+	std::vector<PassHistory> passes;	// the first one is "Frame".
+	std::vector<PendingFrame> pendingFrames;
+	// a query object keeps the target it was first used with, each target has its own.
+	std::vector<unsigned int> freeTimestampQueries;
+	std::vector<unsigned int> freeElapsedQueries;
+	std::vector<TraceEvent> trace;
+	unsigned long long frame;
+	bool profiling;		// false for a frame the ring was full at.
+	unsigned int depth;
+
+	// the GPU's GL_TIMESTAMP at 'syncTime', to place the GPU timestamps on the steady clock.
+	long long syncGpuTime;
+	std::chrono::steady_clock::time_point syncTime;
+
+	void Collect();
+	unsigned int PassIndex(const char* name);
+	void Record(unsigned int pass, float milliseconds);
+	static unsigned int NewQuery(std::vector<unsigned int>& freeQueries);
+	static PassStats ComputeStats(const PassHistory& history);
+};
+
+#endif
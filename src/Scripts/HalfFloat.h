@@ -0,0 +1,147 @@
+#ifndef HALF_FLOAT_H
+#define HALF_FLOAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__F16C__)
+#define HALF_FLOAT_USE_F16C 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HALF_FLOAT_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// IEEE half float conversions (round to nearest even), the format of GL_HALF_FLOAT uploads & the IBL cache files.
+
+inline uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+    if (magnitude >= 0x7F800000u)
+        return (uint16_t)(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));  // inf & nan.
+    if (magnitude >= 0x477FF000u)
+        return (uint16_t)(sign | 0x7C00u);  // rounds past 65504.
+    if (magnitude < 0x38800000u)
+    {
+        // half denormal (or 0).
+        if (magnitude < 0x33000000u)
+            return (uint16_t)sign;
+        uint32_t exponent = magnitude >> 23;
+        uint32_t mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+        uint32_t shift = 126 - exponent;
+        uint32_t result = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (result & 1u)))
+            result++;
+        return (uint16_t)(sign | result);
+    }
+
+    // rebias the exponent, a carry out of the mantissa bumps the exponent as it should.
+    uint32_t result = (magnitude - 0x38000000u) >> 13;
+    uint32_t remainder = magnitude & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (result & 1u)))
+        result++;
+    return (uint16_t)(sign | result);
+}
+
+inline float HalfToFloat(uint16_t value)
+{
+    uint32_t sign = (uint32_t)(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+    uint32_t bits;
+    if (exponent == 0x1Fu)
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    else if (exponent != 0)
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    else if (mantissa == 0)
+        bits = sign;
+    else
+    {
+        // denormal, normalize it.
+        exponent = 113;
+        while ((mantissa & 0x400u) == 0)
+        {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+#if defined(HALF_FLOAT_USE_F16C)
+// 4 floats to halves in the low 16 bits of each 32-bit lane.
+inline __m128i FloatToHalf4(__m128 value)
+{
+    return _mm_cvtepu16_epi32(_mm_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT));
+}
+#elif defined(HALF_FLOAT_USE_SSE2)
+// 4 floats to halves in the low 16 bits of each 32-bit lane, same rounding as FloatToHalf
+// (after Fabian Giesen's float_to_half_fast3_rtne).
+inline __m128i FloatToHalf4(__m128 value)
+{
+    const __m128i infinityOrNaNLimit = _mm_set1_epi32((127 + 16) << 23);   // everything from here up is inf or nan.
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);            // smallest float that's a normal half.
+    const __m128i denormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23)); // exponent rebias & rounding.
+
+    __m128 sign = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u)));
+    __m128 absolute = _mm_xor_ps(value, sign);
+    __m128i bits = _mm_castps_si128(absolute);
+
+    __m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+    __m128i isFinite = _mm_cmpgt_epi32(infinityOrNaNLimit, bits);
+    __m128i special = _mm_or_si128(_mm_and_si128(isNaN, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+
+    // denormal results: the float adder does the rounding.
+    __m128i isDenormal = _mm_cmpgt_epi32(minNormal, bits);
+    __m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(denormalMagic))), denormalMagic);
+
+    // normal results: round half to even by biasing up when the kept mantissa is odd.
+    __m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+    __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, normalBias), odd), 13);
+
+    __m128i finite = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+    __m128i result = _mm_or_si128(_mm_and_si128(isFinite, finite), _mm_andnot_si128(isFinite, special));
+    return _mm_or_si128(result, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+}
+#endif
+
+// Converts 'count' floats to halves.
+inline void FloatsToHalfs(const float* values, uint16_t* halfs, size_t count)
+{
+    size_t i = 0;
+#if defined(HALF_FLOAT_USE_F16C)
+    for (; i + 4 <= count; i += 4)
+        _mm_storel_epi64((__m128i*)(halfs + i), _mm_cvtps_ph(_mm_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(HALF_FLOAT_USE_SSE2)
+    for (; i + 4 <= count; i += 4)
+    {
+        // the lanes are at most 0xFFFF, shift them into signed range so the saturating pack keeps them intact.
+        __m128i lanes = _mm_sub_epi32(FloatToHalf4(_mm_loadu_ps(values + i)), _mm_set1_epi32(0x8000));
+        __m128i packed = _mm_add_epi16(_mm_packs_epi32(lanes, lanes), _mm_set1_epi16((short)0x8000));
+        _mm_storel_epi64((__m128i*)(halfs + i), packed);
+    }
+#endif
+    for (; i < count; i++)
+        halfs[i] = FloatToHalf(values[i]);
+}
+
+inline std::vector<uint16_t> FloatsToHalfs(const std::vector<float>& values)
+{
+    std::vector<uint16_t> halfs(values.size());
+    FloatsToHalfs(values.data(), halfs.data(), values.size());
+    return halfs;
+}
+
+#endif
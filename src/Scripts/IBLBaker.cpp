@@ -0,0 +1,471 @@
+#include "IBLBaker.h"
+
+#include "../../vendor/glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	// Pixels rendered per step by the sampling heavy passes (irradiance & prefilter), larger faces are split into bands of rows.
+	const unsigned int BAND_PIXELS = 128 * 128;
+
+	// Weight of a new timing in the running cost estimate of its step kind.
+	const double TIMING_WEIGHT = 0.25;
+
+	void SetupCubemap(unsigned int texture, unsigned int size, GLint minFilter)
+	{
+		glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+		for (unsigned int i = 0; i < 6; ++i)
+		{
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, size, size, 0, GL_RGB, GL_FLOAT, nullptr);
+		}
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, minFilter);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+}
+
+IBLMaps CreateIBLMaps(const IBLBakeSettings& settings)
+{
+	IBLMaps maps;
+
+	glGenTextures(1, &maps.envCubemap);
+	SetupCubemap(maps.envCubemap, settings.environmentSize, GL_LINEAR_MIPMAP_LINEAR); // enable pre-filter mipmap sampling (combatting visible dots artifact)
+	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+
+	glGenTextures(1, &maps.irradianceMap);
+	SetupCubemap(maps.irradianceMap, settings.irradianceSize, GL_LINEAR);
+
+	glGenTextures(1, &maps.prefilterMap);
+	SetupCubemap(maps.prefilterMap, settings.prefilterSize, GL_LINEAR_MIPMAP_LINEAR); // be sure to set minification filter to mip_linear
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, settings.prefilterMipLevels - 1);
+	// Generate mipmaps for the cubemap so OpenGL automatically allocates the required memory.
+	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	return maps;
+}
+
+void DeleteIBLMaps(IBLMaps& maps)
+{
+	const unsigned int textures[] = { maps.envCubemap, maps.irradianceMap, maps.prefilterMap };
+	glDeleteTextures(3, textures);
+	maps = IBLMaps();
+}
+
+IBLBaker::IBLBaker(const IBLBakeSettings& settings, const std::string& cacheDirectory, void (*renderCube)(), void (*renderQuad)())
+	: settings(settings), cacheDirectory(cacheDirectory), renderCube(renderCube), renderQuad(renderQuad),
+	  equirectangularToCubemapShader(PROJECT_DIR"/src/Shaders/cubemap.vs", PROJECT_DIR"/src/Shaders/equirectangular_to_cubemap.fs"),
+	  irradianceShader(PROJECT_DIR"/src/Shaders/cubemap.vs", PROJECT_DIR"/src/Shaders/irradiance_convolution.fs"),
+	  prefilterShader(PROJECT_DIR"/src/Shaders/cubemap.vs", PROJECT_DIR"/src/Shaders/prefilter.fs"),
+	  brdfShader(PROJECT_DIR"/src/Shaders/brdf.vs", PROJECT_DIR"/src/Shaders/brdf.fs"),
+	  active(false), hdrTexture(0), withIrradianceMap(false), uploadingCache(false), totalSteps(0),
+	  prefilterSampleCounts(PrefilterSampleCounts(settings)),
+	  millisecondsPerPixel(STEP_PREFILTER + settings.prefilterMipLevels, -1.0),
+	  readbackFence(nullptr), readbackData(nullptr), readbackKey(0), readbackWithIrradiance(false), readbackSize(0)
+{
+	glGenFramebuffers(1, &captureFBO);
+	glGenBuffers(1, &readbackBuffer);
+
+	// projection and view matrices for capturing data onto the 6 cubemap face directions
+	captureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
+	captureViews[0] = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+	captureViews[1] = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+	captureViews[2] = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f));
+	captureViews[3] = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f));
+	captureViews[4] = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+	captureViews[5] = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+}
+
+IBLBaker::~IBLBaker()
+{
+	if (cacheRead.valid())
+		cacheRead.wait();
+	for (std::future<CacheFile>& staleRead : staleCacheReads)
+		staleRead.wait();
+	// the last bake's readback is written out, so the cache has it on the next run.
+	FinishCacheWrite(true);
+
+	for (const PendingTiming& timing : pendingTimings)
+		freeQueries.push_back(timing.query);
+	if (!freeQueries.empty())
+		glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+	glDeleteBuffers(1, &readbackBuffer);
+	glDeleteFramebuffers(1, &captureFBO);
+}
+
+void IBLBaker::BakeBRDFLUT(unsigned int brdfLUTTexture)
+{
+	std::string brdfCachePath = BRDFLUTCachePath(cacheDirectory, settings);
+	if (LoadBRDFLUTCache(brdfCachePath, settings, brdfLUTTexture))
+		return;
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	// render screen-space quad with BRDF shader into the LUT.
+	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUTTexture, 0);
+	glViewport(0, 0, settings.brdfLUTSize, settings.brdfLUTSize);
+	brdfShader.use();
+	glClear(GL_COLOR_BUFFER_BIT);
+	renderQuad();
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	SaveBRDFLUTCache(brdfCachePath, settings, brdfLUTTexture);
+}
+
+void IBLBaker::Start(unsigned int hdrTexture, const char* hdrPath, const IBLMaps& target, bool withIrradianceMap)
+{
+	this->hdrTexture = hdrTexture;
+	this->target = target;
+	this->target.hasIrradiance = false;
+	this->withIrradianceMap = withIrradianceMap;
+	steps.clear();
+	totalSteps = 0;
+	cacheFile = CacheFile();
+	uploadingCache = false;
+	active = true;
+	// a read still running for the previous bake would block here if it were replaced, it's dropped once it's done.
+	DropFinishedCacheReads();
+	if (cacheRead.valid())
+		staleCacheReads.push_back(std::move(cacheRead));
+
+	// Hashing the HDR file & reading the cache happen on a worker, the steps are queued once it's done.
+	std::string path = hdrPath;
+	std::string directory = cacheDirectory;
+	IBLBakeSettings bakeSettings = settings;
+	cacheRead = std::async(std::launch::async, [path, directory, bakeSettings]()
+	{
+		CacheFile file;
+		//An Unreadable HDR File Has No Meaningful Key, Bake It Without Caching.
+		file.cacheable = HashFile(path.c_str()) != 0;
+		if (!file.cacheable)
+			return file;
+		file.key = IBLCacheKey(path.c_str(), bakeSettings);
+		file.path = IBLCachePath(directory, file.key);
+		file.valid = ReadIBLCacheFile(file.path, file.key, bakeSettings, file.data, file.withIrradiance);
+		return file;
+	});
+}
+
+void IBLBaker::DropFinishedCacheReads()
+{
+	staleCacheReads.erase(std::remove_if(staleCacheReads.begin(), staleCacheReads.end(), [](const std::future<CacheFile>& staleRead)
+		{ return staleRead.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }), staleCacheReads.end());
+}
+
+bool IBLBaker::Update(float budgetMilliseconds)
+{
+	return Run(budgetMilliseconds, false);
+}
+
+bool IBLBaker::Finish()
+{
+	return Run(0.0f, true);
+}
+
+float IBLBaker::Progress() const
+{
+	if (!active)
+		return 1.0f;
+	if (totalSteps == 0)
+		return 0.0f;
+	return 1.0f - (float)steps.size() / (float)totalSteps;
+}
+
+bool IBLBaker::Run(float budgetMilliseconds, bool all)
+{
+	CollectTimings(false);
+	FinishCacheWrite(false);
+	DropFinishedCacheReads();
+	if (!active)
+		return false;
+
+	if (cacheRead.valid())
+	{
+		if (!all && cacheRead.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return false;
+		cacheFile = cacheRead.get();
+		// a cache file without the irradiance map can't be used when it's needed.
+		uploadingCache = cacheFile.valid && (cacheFile.withIrradiance || !withIrradianceMap);
+		if (uploadingCache)
+			QueueUploadSteps();
+		else
+			QueueBakeSteps();
+	}
+
+	GLint viewport[4], drawFramebuffer, readFramebuffer, unpackAlignment;
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+	GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+	GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+
+	// every face pixel is covered by exactly one cube face, so no depth buffer is needed.
+	glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_SCISSOR_TEST);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// Steps of unmeasured kinds are only run as the first step of a call, so one unknown cost can't blow the budget twice.
+	double spentMilliseconds = 0.0;
+	bool ranStep = false;
+	while (!steps.empty())
+	{
+		const Step& step = steps.front();
+		double estimate = EstimateMilliseconds(step);
+		if (ranStep && !all && (estimate < 0.0 || spentMilliseconds + estimate > budgetMilliseconds))
+			break;
+
+		unsigned int query;
+		if (freeQueries.empty())
+		{
+			glGenQueries(1, &query);
+		}
+		else
+		{
+			query = freeQueries.back();
+			freeQueries.pop_back();
+		}
+
+		std::chrono::steady_clock::time_point cpuStart = std::chrono::steady_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		RunStep(step);
+		glEndQuery(GL_TIME_ELAPSED);
+		double cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cpuStart).count();
+
+		pendingTimings.push_back({ query, step.kind, step.size * step.rows, cpuMilliseconds });
+		spentMilliseconds += std::max(estimate, 0.0);
+		ranStep = true;
+		steps.pop_front();
+	}
+
+	glDisable(GL_SCISSOR_TEST);
+	if (depthTest) glEnable(GL_DEPTH_TEST);
+	if (cullFace) glEnable(GL_CULL_FACE);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	if (!steps.empty())
+		return false;
+
+	// Done, store a fresh bake so switching back to this environment is just an upload.
+	active = false;
+	target.hasIrradiance = withIrradianceMap;
+	if (cacheFile.cacheable && !uploadingCache)
+		StartCacheWrite(cacheFile.path, cacheFile.key);
+	cacheFile = CacheFile();
+	return true;
+}
+
+void IBLBaker::QueueUploadSteps()
+{
+	cacheLayout = IBLCacheLayout(settings, cacheFile.withIrradiance);
+	for (size_t i = 0; i < cacheLayout.size(); i++)
+	{
+		const IBLCacheLevel& level = cacheLayout[i];
+		if (level.map == IBL_IRRADIANCE_MAP && !withIrradianceMap)
+			continue;
+		steps.push_back({ STEP_UPLOAD, level.face, level.mip, level.size, 0, level.size, i });
+	}
+	steps.push_back({ STEP_ENVIRONMENT_MIPMAPS, 0, 0, settings.environmentSize, 0, settings.environmentSize, 0 });
+	totalSteps = steps.size();
+}
+
+void IBLBaker::QueueBakeSteps()
+{
+	// convert HDR equirectangular environment map to cubemap equivalent & let OpenGL generate its mipmaps.
+	QueueFaceSteps(STEP_EQUIRECTANGULAR, 0, settings.environmentSize);
+	steps.push_back({ STEP_ENVIRONMENT_MIPMAPS, 0, 0, settings.environmentSize, 0, settings.environmentSize, 0 });
+
+	// solve diffuse integral by convolution to create an irradiance (cube)map.
+	if (withIrradianceMap)
+		QueueFaceSteps(STEP_IRRADIANCE, 0, settings.irradianceSize);
+
+	// run a quasi monte-carlo simulation on the environment lighting to create a prefilter (cube)map.
+	for (unsigned int mip = 0; mip < settings.prefilterMipLevels; mip++)
+		QueueFaceSteps(STEP_PREFILTER + mip, mip, settings.prefilterSize >> mip);
+
+	totalSteps = steps.size();
+}
+
+void IBLBaker::QueueFaceSteps(unsigned int kind, unsigned int mip, unsigned int size)
+{
+	// the equirectangular conversion is one texture fetch per pixel, it's always done a face at a time.
+	unsigned int rows = kind == STEP_EQUIRECTANGULAR ? size : std::max(1u, std::min(size, BAND_PIXELS / size));
+	for (unsigned int face = 0; face < 6; face++)
+		for (unsigned int firstRow = 0; firstRow < size; firstRow += rows)
+			steps.push_back({ kind, face, mip, size, firstRow, std::min(rows, size - firstRow), 0 });
+}
+
+void IBLBaker::RunStep(const Step& step)
+{
+	if (step.kind == STEP_UPLOAD)
+	{
+		const IBLCacheLevel& level = cacheLayout[step.level];
+		const unsigned int textures[] = { target.envCubemap, target.irradianceMap, target.prefilterMap };
+		glBindTexture(GL_TEXTURE_CUBE_MAP, textures[level.map]);
+		glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + level.face, level.mip, 0, 0, level.size, level.size, GL_RGB, GL_HALF_FLOAT, cacheFile.data.data() + level.offset);
+		return;
+	}
+	if (step.kind == STEP_ENVIRONMENT_MIPMAPS)
+	{
+		// mipmaps from first mip face (combatting visible dots artifact), the prefilter steps sample them.
+		glBindTexture(GL_TEXTURE_CUBE_MAP, target.envCubemap);
+		glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+		return;
+	}
+
+	Shader* shader;
+	unsigned int texture;
+	glActiveTexture(GL_TEXTURE0);
+	if (step.kind == STEP_EQUIRECTANGULAR)
+	{
+		shader = &equirectangularToCubemapShader;
+		texture = target.envCubemap;
+		shader->use();
+		shader->setInt("equirectangularMap", 0);
+		glBindTexture(GL_TEXTURE_2D, hdrTexture);
+	}
+	else
+	{
+		shader = step.kind == STEP_IRRADIANCE ? &irradianceShader : &prefilterShader;
+		texture = step.kind == STEP_IRRADIANCE ? target.irradianceMap : target.prefilterMap;
+		shader->use();
+		shader->setInt("environmentMap", 0);
+		if (step.kind != STEP_IRRADIANCE)
+		{
+			shader->setFloat("roughness", (float)step.mip / (float)(settings.prefilterMipLevels - 1));
+			shader->setFloat("environmentResolution", (float)settings.environmentSize);
+			shader->setInt("mip", step.mip);
+			for (unsigned int mip = 0; mip < std::min((uint32_t)prefilterSampleCounts.size(), PREFILTER_MAX_MIP_LEVELS); mip++)
+				shader->setUInt("sampleCounts[" + std::to_string(mip) + "]", prefilterSampleCounts[mip]);
+		}
+		glBindTexture(GL_TEXTURE_CUBE_MAP, target.envCubemap);
+	}
+	shader->setMat4("projection", captureProjection);
+	shader->setMat4("view", captureViews[step.face]);
+
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + step.face, texture, step.mip);
+	glViewport(0, 0, step.size, step.size);
+	glScissor(0, step.firstRow, step.size, step.rows);
+	glClear(GL_COLOR_BUFFER_BIT);
+	renderCube();
+}
+
+double IBLBaker::EstimateMilliseconds(const Step& step) const
+{
+	double perPixel = millisecondsPerPixel[step.kind];
+	return perPixel < 0.0 ? -1.0 : perPixel * step.size * step.rows;
+}
+
+void IBLBaker::CollectTimings(bool wait)
+{
+	// queries complete in order, stop at the first one that isn't done.
+	size_t collected = 0;
+	for (; collected < pendingTimings.size(); collected++)
+	{
+		const PendingTiming& timing = pendingTimings[collected];
+		GLint available = GL_TRUE;
+		if (!wait)
+			glGetQueryObjectiv(timing.query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(timing.query, GL_QUERY_RESULT, &nanoseconds);
+		freeQueries.push_back(timing.query);
+
+		// uploads are mostly driver time on the CPU, renders mostly GPU time.
+		double milliseconds = std::max(nanoseconds / 1.0e6, timing.cpuMilliseconds);
+		double perPixel = milliseconds / std::max(1u, timing.pixels);
+		double& estimate = millisecondsPerPixel[timing.kind];
+		estimate = estimate < 0.0 ? perPixel : estimate + (perPixel - estimate) * TIMING_WEIGHT;
+	}
+	pendingTimings.erase(pendingTimings.begin(), pendingTimings.begin() + collected);
+}
+
+void IBLBaker::StartCacheWrite(const std::string& path, uint64_t key)
+{
+	// one readback at a time.
+	FinishCacheWrite(true);
+
+	std::vector<IBLCacheLevel> layout = IBLCacheLayout(settings, withIrradianceMap);
+	readbackSize = IBLCacheDataSize(layout);
+	readbackPath = path;
+	readbackKey = key;
+	readbackWithIrradiance = withIrradianceMap;
+
+	// copy the maps into a pixel pack buffer, the copy runs on the GPU after the bake & the CPU picks it up once the fence is signaled.
+	GLint packAlignment;
+	glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readbackBuffer);
+	glBufferData(GL_PIXEL_PACK_BUFFER, readbackSize * sizeof(uint16_t), nullptr, GL_STREAM_READ);
+
+	const unsigned int textures[] = { target.envCubemap, target.irradianceMap, target.prefilterMap };
+	for (const IBLCacheLevel& level : layout)
+	{
+		glBindTexture(GL_TEXTURE_CUBE_MAP, textures[level.map]);
+		glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + level.face, level.mip, GL_RGB, GL_HALF_FLOAT, (void*)(level.offset * sizeof(uint16_t)));
+	}
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+	readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void IBLBaker::FinishCacheWrite(bool wait)
+{
+	// the worker writes straight from the mapped buffer, unmap it once it's done.
+	if (readbackData)
+	{
+		if (!wait && cacheWrite.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return;
+		cacheWrite.get();
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readbackBuffer);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		glBufferData(GL_PIXEL_PACK_BUFFER, 0, nullptr, GL_STREAM_READ);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		readbackData = nullptr;
+	}
+
+	if (!readbackFence)
+		return;
+	GLenum status = glClientWaitSync(readbackFence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+	if (status == GL_TIMEOUT_EXPIRED)
+		return;
+	glDeleteSync(readbackFence);
+	readbackFence = nullptr;
+	if (status == GL_WAIT_FAILED)
+		return;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readbackBuffer);
+	readbackData = (const uint16_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readbackSize * sizeof(uint16_t), GL_MAP_READ_BIT);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	if (!readbackData)
+		return;
+
+	std::string path = readbackPath;
+	uint64_t key = readbackKey;
+	IBLBakeSettings bakeSettings = settings;
+	const uint16_t* data = readbackData;
+	size_t count = readbackSize;
+	bool withIrradiance = readbackWithIrradiance;
+	cacheWrite = std::async(std::launch::async, [path, key, bakeSettings, data, count, withIrradiance]()
+	{
+		return WriteIBLCacheFile(path, key, bakeSettings, data, count, withIrradiance);
+	});
+	if (wait)
+		FinishCacheWrite(true);
+}
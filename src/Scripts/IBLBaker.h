@@ -0,0 +1,155 @@
+#ifndef IBL_BAKER_H
+#define IBL_BAKER_H
+
+#include "../../vendor/glm/glm.hpp"
+
+#include "IBLCache.h"
+#include "Shader.h"
+
+#include <deque>
+#include <future>
+#include <string>
+#include <vector>
+
+// Textures of one baked environment.
+struct IBLMaps
+{
+	unsigned int envCubemap = 0;
+	unsigned int irradianceMap = 0;
+	unsigned int prefilterMap = 0;
+	bool hasIrradiance = false;	// False when the irradiance map wasn't baked for this environment (irradiance from spherical harmonics).
+};
+
+// Allocates the cubemaps of one environment at the sizes of 'settings'.
+IBLMaps CreateIBLMaps(const IBLBakeSettings& settings);
+// Deletes the cubemaps of 'maps' and zeroes them.
+void DeleteIBLMaps(IBLMaps& maps);
+
+// Bakes the IBL maps of an environment a few cubemap faces (or bands of a face) at a time, so a bake can be spread over
+// many frames. Each frame runs as many steps as fit in a GPU time budget, estimated per kind of step from timer queries.
+// Finished bakes are written to the IBL cache asynchronously, cached bakes are read on a worker thread and uploaded in steps.
+class IBLBaker
+{
+public:
+	IBLBaker(const IBLBakeSettings& settings, const std::string& cacheDirectory, void (*renderCube)(), void (*renderQuad)());
+	// Waits for a pending cache write to be done, so needs the GL context like the constructor.
+	~IBLBaker();
+	IBLBaker(const IBLBaker&) = delete;
+	IBLBaker& operator=(const IBLBaker&) = delete;
+
+	// Loads the BRDF LUT from the cache or renders it, all at once.
+	void BakeBRDFLUT(unsigned int brdfLUTTexture);
+
+	// Starts baking an environment into 'target', cancelling any bake in progress.
+	void Start(unsigned int hdrTexture, const char* hdrPath, const IBLMaps& target, bool withIrradianceMap);
+	// Runs bake steps until their estimated GPU time reaches the budget, at least one per call.
+	// Returns true in the call that completes the bake. Restores the viewport, framebuffer & capabilities it changes.
+	// Call it every frame, also while not busy: it hands the readback of a finished bake to the cache write once it's done.
+	bool Update(float budgetMilliseconds);
+	// Runs all remaining steps, returns true if a bake was completed.
+	bool Finish();
+
+	bool Busy() const { return active; }
+	// Fraction of the current bake that is done.
+	float Progress() const;
+	// Maps of the current (or last) bake.
+	const IBLMaps& Target() const { return target; }
+
+private:
+	// A kind of step, steps of one kind cost the same per pixel. Prefilter steps of mip m are STEP_PREFILTER + m.
+	enum StepKind
+	{
+		STEP_UPLOAD,
+		STEP_EQUIRECTANGULAR,
+		STEP_ENVIRONMENT_MIPMAPS,
+		STEP_IRRADIANCE,
+		STEP_PREFILTER
+	};
+
+	struct Step
+	{
+		unsigned int kind;
+		unsigned int face;
+		unsigned int mip;
+		unsigned int size;
+		unsigned int firstRow;	// band of the face rendered by this step.
+		unsigned int rows;
+		size_t level;			// index into the cache layout for STEP_UPLOAD.
+	};
+
+	// Cache key & contents of a cache file, read on a worker thread.
+	struct CacheFile
+	{
+		bool cacheable = false;	// false if the HDR file couldn't be hashed.
+		uint64_t key = 0;
+		std::string path;
+		bool valid = false;
+		bool withIrradiance = false;
+		std::vector<uint16_t> data;
+	};
+
+	// Timer query of a step whose result hasn't been read yet.
+	struct PendingTiming
+	{
+		unsigned int query;
+		unsigned int kind;
+		unsigned int pixels;
+		double cpuMilliseconds;
+	};
+
+	IBLBakeSettings settings;
+	std::string cacheDirectory;
+	void (*renderCube)();
+	void (*renderQuad)();
+
+	Shader equirectangularToCubemapShader;
+	Shader irradianceShader;
+	Shader prefilterShader;
+	Shader brdfShader;
+	unsigned int captureFBO;
+	glm::mat4 captureProjection;
+	glm::mat4 captureViews[6];
+
+	// current bake.
+	bool active;
+	IBLMaps target;
+	unsigned int hdrTexture;
+	bool withIrradianceMap;
+	std::future<CacheFile> cacheRead;
+	// reads of bakes started over before they were done, dropped once they finish so replacing them never waits.
+	std::vector<std::future<CacheFile>> staleCacheReads;
+	CacheFile cacheFile;
+	bool uploadingCache;	// true if the steps upload the cache file instead of baking.
+	std::vector<IBLCacheLevel> cacheLayout;
+	std::deque<Step> steps;
+	size_t totalSteps;
+	std::vector<uint32_t> prefilterSampleCounts;	// GGX samples per texel of each prefilter mip.
+
+	// measured cost per pixel of each step kind, negative until measured.
+	std::vector<double> millisecondsPerPixel;
+	std::vector<PendingTiming> pendingTimings;
+	std::vector<unsigned int> freeQueries;
+
+	// asynchronous cache write of the last finished bake.
+	unsigned int readbackBuffer;
+	GLsync readbackFence;
+	const uint16_t* readbackData;	// mapped readback buffer while the worker writes it out.
+	std::string readbackPath;
+	uint64_t readbackKey;
+	bool readbackWithIrradiance;
+	size_t readbackSize;
+	std::future<bool> cacheWrite;
+
+	bool Run(float budgetMilliseconds, bool all);
+	void DropFinishedCacheReads();
+	void QueueUploadSteps();
+	void QueueBakeSteps();
+	void QueueFaceSteps(unsigned int kind, unsigned int mip, unsigned int size);
+	void RunStep(const Step& step);
+	double EstimateMilliseconds(const Step& step) const;
+	void CollectTimings(bool wait);
+	void StartCacheWrite(const std::string& path, uint64_t key);
+	void FinishCacheWrite(bool wait);
+};
+
+#endif
@@ -0,0 +1,580 @@
+#include "IBLBakerCPU.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IBL_CPU_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	const float PI = 3.14159265359f;
+
+	// Rows of a face level baked per task.
+	const unsigned int BAND_ROWS = 16;
+
+	// Face level band baked by one task.
+	struct Band
+	{
+		unsigned int face;
+		unsigned int mip;
+		unsigned int firstRow;
+		unsigned int rows;
+	};
+
+	// Splits the given mips of a cubemap into bands, biggest levels first so the tail of the job has the small tasks.
+	std::vector<Band> FaceBands(unsigned int size, unsigned int firstMip, unsigned int mipLevels)
+	{
+		std::vector<Band> bands;
+		for (unsigned int mip = firstMip; mip < mipLevels; mip++)
+		{
+			unsigned int levelSize = std::max(size >> mip, 1u);
+			for (unsigned int face = 0; face < 6; face++)
+				for (unsigned int row = 0; row < levelSize; row += BAND_ROWS)
+					bands.push_back({ face, mip, row, std::min(BAND_ROWS, levelSize - row) });
+		}
+		return bands;
+	}
+
+	void RunBands(const std::vector<Band>& bands, ThreadPool& pool, const std::function<void(const Band&)>& bake)
+	{
+		pool.ParallelFor(bands.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+				bake(bands[i]);
+		});
+	}
+
+	// Face & face coordinates (0 - 1) of a direction, as in the cube map face selection table of the GL spec.
+	inline void DirectionToFace(float x, float y, float z, unsigned int& face, float& s, float& t)
+	{
+		float ax = std::fabs(x), ay = std::fabs(y), az = std::fabs(z);
+		float sc, tc, ma;
+		if (ax >= ay && ax >= az)
+		{
+			face = x >= 0.0f ? 0 : 1;
+			sc = x >= 0.0f ? -z : z;
+			tc = -y;
+			ma = ax;
+		}
+		else if (ay >= az)
+		{
+			face = y >= 0.0f ? 2 : 3;
+			sc = x;
+			tc = y >= 0.0f ? z : -z;
+			ma = ay;
+		}
+		else
+		{
+			face = z >= 0.0f ? 4 : 5;
+			sc = z >= 0.0f ? x : -x;
+			tc = -y;
+			ma = az;
+		}
+		s = 0.5f * (sc / ma + 1.0f);
+		t = 0.5f * (tc / ma + 1.0f);
+	}
+
+	// Directions sampled around a texel's normal, in its tangent space, 4 to a block so they can be transformed with SSE.
+	// Padding entries have a weight of 0.
+	struct SampleTable
+	{
+		std::vector<float> x, y, z, weight, lod;
+
+		void Add(float sx, float sy, float sz, float sampleWeight, float sampleLod)
+		{
+			x.push_back(sx);
+			y.push_back(sy);
+			z.push_back(sz);
+			weight.push_back(sampleWeight);
+			lod.push_back(sampleLod);
+		}
+		void Pad()
+		{
+			while (x.size() % 4 != 0)
+				Add(0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+		}
+		size_t Size() const { return x.size(); }
+	};
+
+	// Weighted sum of environment samples of the table rotated into the frame (tangent, bitangent, normal), and the sum of weights.
+	void AccumulateSamples(const CubemapImage& environment, const SampleTable& table, const float tangent[3], const float bitangent[3],
+		const float normal[3], float rgb[3], float& totalWeight)
+	{
+		rgb[0] = rgb[1] = rgb[2] = 0.0f;
+		totalWeight = 0.0f;
+
+		float directions[3][4];
+		for (size_t i = 0; i < table.Size(); i += 4)
+		{
+#ifdef IBL_CPU_USE_SSE
+			__m128 sx = _mm_loadu_ps(&table.x[i]);
+			__m128 sy = _mm_loadu_ps(&table.y[i]);
+			__m128 sz = _mm_loadu_ps(&table.z[i]);
+			for (int axis = 0; axis < 3; axis++)
+			{
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, _mm_set1_ps(tangent[axis])), _mm_mul_ps(sy, _mm_set1_ps(bitangent[axis]))),
+					_mm_mul_ps(sz, _mm_set1_ps(normal[axis])));
+				_mm_storeu_ps(directions[axis], d);
+			}
+#else
+			for (int lane = 0; lane < 4; lane++)
+				for (int axis = 0; axis < 3; axis++)
+					directions[axis][lane] = table.x[i + lane] * tangent[axis] + table.y[i + lane] * bitangent[axis] + table.z[i + lane] * normal[axis];
+#endif
+			for (int lane = 0; lane < 4; lane++)
+			{
+				float weight = table.weight[i + lane];
+				if (weight <= 0.0f)
+					continue;
+				float sample[3];
+				environment.Sample(directions[0][lane], directions[1][lane], directions[2][lane], table.lod[i + lane], sample);
+				rgb[0] += sample[0] * weight;
+				rgb[1] += sample[1] * weight;
+				rgb[2] += sample[2] * weight;
+				totalWeight += weight;
+			}
+		}
+	}
+
+	inline void Normalize(float v[3])
+	{
+		float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		if (length > 0.0f)
+		{
+			v[0] /= length;
+			v[1] /= length;
+			v[2] /= length;
+		}
+	}
+
+	inline void Cross(const float a[3], const float b[3], float out[3])
+	{
+		out[0] = a[1] * b[2] - a[2] * b[1];
+		out[1] = a[2] * b[0] - a[0] * b[2];
+		out[2] = a[0] * b[1] - a[1] * b[0];
+	}
+
+	// Hammersley point i of n, as in the bake shaders.
+	inline void Hammersley(uint32_t i, uint32_t n, float& u, float& v)
+	{
+		uint32_t bits = i;
+		bits = (bits << 16u) | (bits >> 16u);
+		bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+		bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+		bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+		bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+		u = float(i) / float(n);
+		v = float(bits) * 2.3283064365386963e-10f;
+	}
+
+	// GGX distributed half vector (cos & sin of theta, cos & sin of phi) around +Z for a Hammersley point.
+	inline void ImportanceSampleGGX(float u, float v, float roughness, float& cosTheta, float& sinTheta, float& cosPhi, float& sinPhi)
+	{
+		float a = roughness * roughness;
+		float phi = 2.0f * PI * u;
+		cosTheta = std::sqrt((1.0f - v) / (1.0f + (a * a - 1.0f) * v));
+		sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+		cosPhi = std::cos(phi);
+		sinPhi = std::sin(phi);
+	}
+
+	const uint32_t GGX_SAMPLE_COUNT = 1024;
+}
+
+CubemapImage::CubemapImage(unsigned int size, unsigned int mipLevels) : size(size), mipLevels(mipLevels)
+{
+	size_t total = 0;
+	for (unsigned int mip = 0; mip < mipLevels; mip++)
+	{
+		unsigned int levelSize = std::max(size >> mip, 1u);
+		for (unsigned int face = 0; face < 6; face++)
+		{
+			offsets.push_back(total);
+			total += (size_t)levelSize * levelSize * 3;
+		}
+	}
+	data.resize(total);
+}
+
+void CubemapImage::TexelDirection(unsigned int face, unsigned int size, int column, int row, float direction[3])
+{
+	float sc = 2.0f * (column + 0.5f) / size - 1.0f;
+	float tc = 2.0f * (row + 0.5f) / size - 1.0f;
+	switch (face)
+	{
+	case 0: direction[0] = 1.0f; direction[1] = -tc; direction[2] = -sc; break;
+	case 1: direction[0] = -1.0f; direction[1] = -tc; direction[2] = sc; break;
+	case 2: direction[0] = sc; direction[1] = 1.0f; direction[2] = tc; break;
+	case 3: direction[0] = sc; direction[1] = -1.0f; direction[2] = -tc; break;
+	case 4: direction[0] = sc; direction[1] = -tc; direction[2] = 1.0f; break;
+	default: direction[0] = -sc; direction[1] = -tc; direction[2] = -1.0f; break;
+	}
+}
+
+const float* CubemapImage::Texel(unsigned int face, unsigned int mip, int column, int row) const
+{
+	int levelSize = (int)Size(mip);
+	if (column < 0 || row < 0 || column >= levelSize || row >= levelSize)
+	{
+		// seamless filtering: texels past an edge are fetched from the neighbouring face.
+		float direction[3];
+		TexelDirection(face, levelSize, column, row, direction);
+		float s, t;
+		DirectionToFace(direction[0], direction[1], direction[2], face, s, t);
+		column = std::min(std::max((int)(s * levelSize), 0), levelSize - 1);
+		row = std::min(std::max((int)(t * levelSize), 0), levelSize - 1);
+	}
+	return Face(face, mip) + ((size_t)row * levelSize + column) * 3;
+}
+
+void CubemapImage::SampleLevel(unsigned int face, unsigned int mip, float s, float t, float rgb[3]) const
+{
+	int levelSize = (int)Size(mip);
+	float u = s * levelSize - 0.5f;
+	float v = t * levelSize - 0.5f;
+	int column = (int)std::floor(u);
+	int row = (int)std::floor(v);
+	float fu = u - column;
+	float fv = v - row;
+
+	const float* t00 = Texel(face, mip, column, row);
+	const float* t10 = Texel(face, mip, column + 1, row);
+	const float* t01 = Texel(face, mip, column, row + 1);
+	const float* t11 = Texel(face, mip, column + 1, row + 1);
+	for (int c = 0; c < 3; c++)
+	{
+		float bottom = t00[c] + (t10[c] - t00[c]) * fu;
+		float top = t01[c] + (t11[c] - t01[c]) * fu;
+		rgb[c] = bottom + (top - bottom) * fv;
+	}
+}
+
+void CubemapImage::Sample(float x, float y, float z, float lod, float rgb[3]) const
+{
+	unsigned int face;
+	float s, t;
+	DirectionToFace(x, y, z, face, s, t);
+
+	lod = std::min(std::max(lod, 0.0f), (float)(mipLevels - 1));
+	unsigned int mip = (unsigned int)lod;
+	float fraction = lod - mip;
+	SampleLevel(face, mip, s, t, rgb);
+	if (fraction > 0.0f && mip + 1 < mipLevels)
+	{
+		float next[3];
+		SampleLevel(face, mip + 1, s, t, next);
+		for (int c = 0; c < 3; c++)
+			rgb[c] += (next[c] - rgb[c]) * fraction;
+	}
+}
+
+void CubemapImage::GenerateMipmaps(ThreadPool& pool)
+{
+	// each level depends on the one above, so the levels run one after another with the faces & rows of each in parallel.
+	for (unsigned int mip = 1; mip < mipLevels; mip++)
+	{
+		unsigned int levelSize = Size(mip);
+		unsigned int parentSize = Size(mip - 1);
+		RunBands(FaceBands(size, mip, mip + 1), pool, [&](const Band& band)
+		{
+			const float* parent = Face(band.face, mip - 1);
+			float* level = Face(band.face, mip);
+			for (unsigned int row = band.firstRow; row < band.firstRow + band.rows; row++)
+			{
+				for (unsigned int column = 0; column < levelSize; column++)
+				{
+					const float* a = parent + ((size_t)(2 * row) * parentSize + 2 * column) * 3;
+					const float* b = a + (size_t)parentSize * 3;
+					float* out = level + ((size_t)row * levelSize + column) * 3;
+					for (int c = 0; c < 3; c++)
+						out[c] = 0.25f * (a[c] + a[c + 3] + b[c] + b[c + 3]);
+				}
+			}
+		});
+	}
+}
+
+void ProjectEquirectangularToCubemap(const EquirectangularImage& source, CubemapImage& cubemap, ThreadPool& pool)
+{
+	const unsigned int size = cubemap.Size();
+	RunBands(FaceBands(size, 0, 1), pool, [&](const Band& band)
+	{
+		float* face = cubemap.Face(band.face, 0);
+		for (unsigned int row = band.firstRow; row < band.firstRow + band.rows; row++)
+		{
+			for (unsigned int column = 0; column < size; column++)
+			{
+				float direction[3];
+				CubemapImage::TexelDirection(band.face, size, column, row, direction);
+				Normalize(direction);
+
+				// same constants as SampleSphericalMap, bilinear with GL_CLAMP_TO_EDGE.
+				float u = (std::atan2(direction[2], direction[0]) * 0.1591f + 0.5f) * source.width - 0.5f;
+				float v = (std::asin(direction[1]) * 0.3183f + 0.5f) * source.height - 0.5f;
+				int x0 = (int)std::floor(u), y0 = (int)std::floor(v);
+				float fu = u - x0, fv = v - y0;
+				int x1 = std::min(std::max(x0 + 1, 0), source.width - 1), y1 = std::min(std::max(y0 + 1, 0), source.height - 1);
+				x0 = std::min(std::max(x0, 0), source.width - 1);
+				y0 = std::min(std::max(y0, 0), source.height - 1);
+
+				const float* p00 = source.pixels + ((size_t)y0 * source.width + x0) * source.channels;
+				const float* p10 = source.pixels + ((size_t)y0 * source.width + x1) * source.channels;
+				const float* p01 = source.pixels + ((size_t)y1 * source.width + x0) * source.channels;
+				const float* p11 = source.pixels + ((size_t)y1 * source.width + x1) * source.channels;
+				float* out = face + ((size_t)row * size + column) * 3;
+				for (int c = 0; c < 3; c++)
+				{
+					float bottom = p00[c] + (p10[c] - p00[c]) * fu;
+					float top = p01[c] + (p11[c] - p01[c]) * fu;
+					out[c] = bottom + (top - bottom) * fv;
+				}
+			}
+		}
+	});
+}
+
+void ConvolveIrradiance(const CubemapImage& environment, CubemapImage& irradiance, ThreadPool& pool)
+{
+	// texture() picks the environment mip from the screen space derivatives of the sample direction, which change by about one
+	// irradiance texel per pixel.
+	const float lod = std::max(std::log2((float)environment.Size() / irradiance.Size()), 0.0f);
+
+	// same float loops as the shader, so the sample directions & count match.
+	SampleTable table;
+	const float sampleDelta = 0.025f;
+	for (float phi = 0.0f; phi < 2.0f * PI; phi += sampleDelta)
+		for (float theta = 0.0f; theta < 0.5f * PI; theta += sampleDelta)
+			table.Add(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta), std::cos(theta) * std::sin(theta), lod);
+	const float sampleCount = (float)table.Size();
+	table.Pad();
+
+	const unsigned int size = irradiance.Size();
+	RunBands(FaceBands(size, 0, 1), pool, [&](const Band& band)
+	{
+		float* face = irradiance.Face(band.face, 0);
+		for (unsigned int row = band.firstRow; row < band.firstRow + band.rows; row++)
+		{
+			for (unsigned int column = 0; column < size; column++)
+			{
+				float normal[3], right[3], up[3] = { 0.0f, 1.0f, 0.0f };
+				CubemapImage::TexelDirection(band.face, size, column, row, normal);
+				Normalize(normal);
+				Cross(up, normal, right);
+				Normalize(right);
+				Cross(normal, right, up);
+				Normalize(up);
+
+				float sum[3], totalWeight;
+				AccumulateSamples(environment, table, right, up, normal, sum, totalWeight);
+				float* out = face + ((size_t)row * size + column) * 3;
+				for (int c = 0; c < 3; c++)
+					out[c] = PI * sum[c] / sampleCount;
+			}
+		}
+	});
+}
+
+void PrefilterGGX(const CubemapImage& environment, CubemapImage& prefilter, const std::vector<uint32_t>& sampleCounts, ThreadPool& pool)
+{
+	const unsigned int mipLevels = prefilter.MipLevels();
+
+	// with V = N the sample directions, weights & mips only depend on the roughness, so they're tabulated once per mip.
+	std::vector<SampleTable> tables(mipLevels);
+	for (unsigned int mip = 0; mip < mipLevels; mip++)
+	{
+		float roughness = mipLevels > 1 ? (float)mip / (float)(mipLevels - 1) : 0.0f;
+		float a = roughness * roughness;
+		float a2 = a * a;
+		const uint32_t sampleCount = sampleCounts[mip];
+		for (uint32_t i = 0; i < sampleCount; i++)
+		{
+			float u, v, cosTheta, sinTheta, cosPhi, sinPhi;
+			Hammersley(i, sampleCount, u, v);
+			ImportanceSampleGGX(u, v, roughness, cosTheta, sinTheta, cosPhi, sinPhi);
+
+			// L = reflect(-N, H) in tangent space.
+			float NdotL = 2.0f * cosTheta * cosTheta - 1.0f;
+			if (NdotL <= 0.0f)
+				continue;
+
+			// pdf = D * NdotH / (4 * HdotV), HdotV = NdotH.
+			float denom = cosTheta * cosTheta * (a2 - 1.0f) + 1.0f;
+			float D = a2 / (PI * denom * denom);
+			float pdf = D / 4.0f + 0.0001f;
+
+			// environment mip whose texels have the solid angle of the sample.
+			const float resolution = (float)environment.Size();
+			float saTexel = 4.0f * PI / (6.0f * resolution * resolution);
+			float saSample = 1.0f / ((float)sampleCount * pdf + 0.0001f);
+			float lod = roughness == 0.0f ? 0.0f : 0.5f * std::log2(saSample / saTexel);
+
+			tables[mip].Add(2.0f * cosTheta * sinTheta * cosPhi, 2.0f * cosTheta * sinTheta * sinPhi, NdotL, NdotL, lod);
+
+			// roughness 0 reflects N itself on every sample, one gives the same average.
+			if (roughness == 0.0f)
+				break;
+		}
+		tables[mip].Pad();
+	}
+
+	const unsigned int size = prefilter.Size();
+	RunBands(FaceBands(size, 0, mipLevels), pool, [&](const Band& band)
+	{
+		unsigned int levelSize = std::max(size >> band.mip, 1u);
+		float* face = prefilter.Face(band.face, band.mip);
+		for (unsigned int row = band.firstRow; row < band.firstRow + band.rows; row++)
+		{
+			for (unsigned int column = 0; column < levelSize; column++)
+			{
+				float normal[3], tangent[3], bitangent[3];
+				CubemapImage::TexelDirection(band.face, levelSize, column, row, normal);
+				Normalize(normal);
+				const float up[3] = { std::fabs(normal[2]) < 0.999f ? 0.0f : 1.0f, 0.0f, std::fabs(normal[2]) < 0.999f ? 1.0f : 0.0f };
+				Cross(up, normal, tangent);
+				Normalize(tangent);
+				Cross(normal, tangent, bitangent);
+
+				float sum[3], totalWeight;
+				AccumulateSamples(environment, tables[band.mip], tangent, bitangent, normal, sum, totalWeight);
+				float* out = face + ((size_t)row * levelSize + column) * 3;
+				for (int c = 0; c < 3; c++)
+					out[c] = totalWeight > 0.0f ? sum[c] / totalWeight : 0.0f;
+			}
+		}
+	});
+}
+
+std::vector<float> IntegrateBRDFLUT(unsigned int size, ThreadPool& pool)
+{
+	std::vector<float> lut((size_t)size * size * 2);
+	pool.ParallelFor(size, BAND_ROWS, [&](size_t begin, size_t end)
+	{
+		for (size_t row = begin; row < end; row++)
+		{
+			float roughness = (row + 0.5f) / size;
+			float k = roughness * roughness / 2.0f;
+
+			// the half vectors only depend on the row's roughness. ImportanceSampleGGX's frame around N = +Z maps
+			// tangent space (x, y, z) to (y, -x, z). V = (sqrt(1 - NdotV^2), 0, NdotV) has no y, so H.y isn't kept.
+			float hx[GGX_SAMPLE_COUNT], hz[GGX_SAMPLE_COUNT];
+			for (uint32_t i = 0; i < GGX_SAMPLE_COUNT; i++)
+			{
+				float u, v, cosTheta, sinTheta, cosPhi, sinPhi;
+				Hammersley(i, GGX_SAMPLE_COUNT, u, v);
+				ImportanceSampleGGX(u, v, roughness, cosTheta, sinTheta, cosPhi, sinPhi);
+				hx[i] = sinPhi * sinTheta;
+				hz[i] = cosTheta;
+			}
+
+			float* out = lut.data() + row * size * 2;
+			unsigned int column = 0;
+#ifdef IBL_CPU_USE_SSE
+			// 4 NdotV values per iteration, one SSE lane each. V.y is 0 so H.y never matters.
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 two = _mm_set1_ps(2.0f);
+			const __m128 vk = _mm_set1_ps(k);
+			const __m128 oneMinusK = _mm_set1_ps(1.0f - k);
+			for (; column + 4 <= size; column += 4)
+			{
+				__m128 NdotV = _mm_setr_ps((column + 0.5f) / size, (column + 1.5f) / size, (column + 2.5f) / size, (column + 3.5f) / size);
+				__m128 vx = _mm_sqrt_ps(_mm_sub_ps(one, _mm_mul_ps(NdotV, NdotV)));
+				__m128 ggxV = _mm_div_ps(NdotV, _mm_add_ps(_mm_mul_ps(NdotV, oneMinusK), vk));
+				__m128 A = zero, B = zero;
+				for (uint32_t i = 0; i < GGX_SAMPLE_COUNT; i++)
+				{
+					__m128 Hx = _mm_set1_ps(hx[i]);
+					__m128 Hz = _mm_set1_ps(hz[i]);
+					__m128 VdotH = _mm_add_ps(_mm_mul_ps(vx, Hx), _mm_mul_ps(NdotV, Hz));
+					__m128 NdotL = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(two, VdotH), Hz), NdotV);
+					__m128 mask = _mm_cmpgt_ps(NdotL, zero);
+					VdotH = _mm_max_ps(VdotH, zero);
+					NdotL = _mm_max_ps(NdotL, zero);
+
+					__m128 ggxL = _mm_div_ps(NdotL, _mm_add_ps(_mm_mul_ps(NdotL, oneMinusK), vk));
+					__m128 gVis = _mm_div_ps(_mm_mul_ps(_mm_mul_ps(ggxL, ggxV), VdotH), _mm_mul_ps(_mm_max_ps(Hz, zero), NdotV));
+					__m128 f = _mm_sub_ps(one, VdotH);
+					__m128 f2 = _mm_mul_ps(f, f);
+					__m128 Fc = _mm_mul_ps(_mm_mul_ps(f2, f2), f);
+					gVis = _mm_and_ps(gVis, mask);
+					A = _mm_add_ps(A, _mm_mul_ps(_mm_sub_ps(one, Fc), gVis));
+					B = _mm_add_ps(B, _mm_mul_ps(Fc, gVis));
+				}
+				float a[4], b[4];
+				_mm_storeu_ps(a, A);
+				_mm_storeu_ps(b, B);
+				for (int lane = 0; lane < 4; lane++)
+				{
+					out[(column + lane) * 2] = a[lane] / GGX_SAMPLE_COUNT;
+					out[(column + lane) * 2 + 1] = b[lane] / GGX_SAMPLE_COUNT;
+				}
+			}
+#endif
+			// remaining columns (or all of them without SSE).
+			for (; column < size; column++)
+			{
+				float NdotV = (column + 0.5f) / size;
+				float vx = std::sqrt(1.0f - NdotV * NdotV);
+				float ggxV = NdotV / (NdotV * (1.0f - k) + k);
+				float A = 0.0f, B = 0.0f;
+				for (uint32_t i = 0; i < GGX_SAMPLE_COUNT; i++)
+				{
+					float VdotH = vx * hx[i] + NdotV * hz[i];
+					float NdotL = 2.0f * VdotH * hz[i] - NdotV;
+					if (NdotL <= 0.0f)
+						continue;
+					VdotH = std::max(VdotH, 0.0f);
+					float ggxL = NdotL / (NdotL * (1.0f - k) + k);
+					float gVis = ggxL * ggxV * VdotH / (std::max(hz[i], 0.0f) * NdotV);
+					float Fc = std::pow(1.0f - VdotH, 5.0f);
+					A += (1.0f - Fc) * gVis;
+					B += Fc * gVis;
+				}
+				out[column * 2] = A / GGX_SAMPLE_COUNT;
+				out[column * 2 + 1] = B / GGX_SAMPLE_COUNT;
+			}
+		}
+	});
+	return lut;
+}
+
+CubemapImage BakeEnvironmentCubemap(const EquirectangularImage& source, const IBLBakeSettings& settings, ThreadPool& pool)
+{
+	// full mip chain like glGenerateMipmap, the prefilter & irradiance passes sample the lower mips.
+	unsigned int environmentMips = 1;
+	while ((settings.environmentSize >> environmentMips) > 0)
+		environmentMips++;
+
+	CubemapImage environment(settings.environmentSize, environmentMips);
+	ProjectEquirectangularToCubemap(source, environment, pool);
+	environment.GenerateMipmaps(pool);
+	return environment;
+}
+
+std::vector<uint16_t> BakeIBLCPU(const EquirectangularImage& source, const IBLBakeSettings& settings, bool withIrradiance, ThreadPool& pool)
+{
+	CubemapImage environment = BakeEnvironmentCubemap(source, settings, pool);
+
+	CubemapImage irradiance(withIrradiance ? settings.irradianceSize : 0, withIrradiance ? 1 : 0);
+	if (withIrradiance)
+		ConvolveIrradiance(environment, irradiance, pool);
+
+	CubemapImage prefilter(settings.prefilterSize, settings.prefilterMipLevels);
+	PrefilterGGX(environment, prefilter, PrefilterSampleCounts(settings), pool);
+
+	std::vector<IBLCacheLevel> layout = IBLCacheLayout(settings, withIrradiance);
+	std::vector<uint16_t> data(IBLCacheDataSize(layout));
+	const CubemapImage* maps[] = { &environment, &irradiance, &prefilter };
+	pool.ParallelFor(layout.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const IBLCacheLevel& level = layout[i];
+			FloatsToHalfs(maps[level.map]->Face(level.face, level.mip), data.data() + level.offset, (size_t)level.size * level.size * 3);
+		}
+	});
+	return data;
+}
@@ -0,0 +1,67 @@
+#ifndef IBL_BAKER_CPU_H
+#define IBL_BAKER_CPU_H
+
+#include "HalfFloat.h"
+#include "IBLCache.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+// CPU implementation of the IBL bake shaders, for baking cache files on machines without a GPU.
+// Every function mirrors one shader (named in its comment) closely enough to match the GPU bake within half float precision
+// in flat regions; faces, mips & bands of rows are spread across the thread pool.
+
+// RGB float cubemap with a mip chain. Faces are in GL order (+X, -X, +Y, -Y, +Z, -Z), rows bottom to top like glTexImage2D.
+class CubemapImage
+{
+public:
+	CubemapImage(unsigned int size = 0, unsigned int mipLevels = 1);
+
+	unsigned int Size(unsigned int mip = 0) const { return size >> mip; }
+	unsigned int MipLevels() const { return mipLevels; }
+	float* Face(unsigned int face, unsigned int mip) { return data.data() + offsets[mip * 6 + face]; }
+	const float* Face(unsigned int face, unsigned int mip) const { return data.data() + offsets[mip * 6 + face]; }
+
+	// textureLod() with GL_LINEAR_MIPMAP_LINEAR & GL_TEXTURE_CUBE_MAP_SEAMLESS: bilinear across face edges, linear between mips.
+	void Sample(float x, float y, float z, float lod, float rgb[3]) const;
+	// Fills every level below 0 with 2x2 box filtered copies of the level above, like glGenerateMipmap.
+	void GenerateMipmaps(ThreadPool& pool);
+
+	// Direction through the center of a texel of a face of the given size.
+	static void TexelDirection(unsigned int face, unsigned int size, int column, int row, float direction[3]);
+
+private:
+	unsigned int size;
+	unsigned int mipLevels;
+	std::vector<size_t> offsets;
+	std::vector<float> data;
+
+	const float* Texel(unsigned int face, unsigned int mip, int column, int row) const;
+	void SampleLevel(unsigned int face, unsigned int mip, float s, float t, float rgb[3]) const;
+};
+
+// Equirectangular map as returned by stbi_loadf with flipping enabled, 'channels' floats per pixel.
+struct EquirectangularImage
+{
+	const float* pixels;
+	int width;
+	int height;
+	int channels;
+};
+
+// equirectangular_to_cubemap.fs, fills level 0 of 'cubemap'.
+void ProjectEquirectangularToCubemap(const EquirectangularImage& source, CubemapImage& cubemap, ThreadPool& pool);
+// irradiance_convolution.fs. The GPU's implicit LOD for the environment is approximated by the size ratio of the two cubemaps.
+void ConvolveIrradiance(const CubemapImage& environment, CubemapImage& irradiance, ThreadPool& pool);
+// prefilter.fs, mip m of 'prefilter' is filtered with roughness m / (mips - 1) & sampleCounts[m] samples per texel.
+void PrefilterGGX(const CubemapImage& environment, CubemapImage& prefilter, const std::vector<uint32_t>& sampleCounts, ThreadPool& pool);
+// brdf.fs, returns size * size RG pairs, rows bottom (roughness 0) to top.
+std::vector<float> IntegrateBRDFLUT(unsigned int size, ThreadPool& pool);
+
+// Environment cubemap of settings.environmentSize with its full mip chain, as sampled by the irradiance & prefilter passes.
+CubemapImage BakeEnvironmentCubemap(const EquirectangularImage& source, const IBLBakeSettings& settings, ThreadPool& pool);
+// Whole bake of an environment, returned in the layout of IBLCacheLayout(settings, withIrradiance) for WriteIBLCacheFile.
+std::vector<uint16_t> BakeIBLCPU(const EquirectangularImage& source, const IBLBakeSettings& settings, bool withIrradiance, ThreadPool& pool);
+
+#endif
@@ -0,0 +1,345 @@
+#include "IBLCache.h"
+
+#include "../../vendor/glad/include/glad.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	const char IBL_CACHE_MAGIC[4] = { 'I', 'B', 'L', 'C' };
+	const char BRDF_CACHE_MAGIC[4] = { 'B', 'R', 'D', 'F' };
+
+	// CacheHeader::flags
+	const uint32_t IBL_CACHE_HAS_IRRADIANCE = 1 << 0;
+
+	const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+	const uint64_t FNV_PRIME = 1099511628211ull;
+
+	// Fixed size header in front of every cache file.
+	struct CacheHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t key;
+		IBLBakeSettings settings;
+		uint32_t flags;
+	};
+
+	uint64_t HashBytes(const void* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+
+	uint64_t HashSettings(const IBLBakeSettings& settings, uint64_t hash)
+	{
+		const uint32_t values[] = { IBL_CACHE_VERSION, settings.environmentSize, settings.irradianceSize, settings.prefilterSize, settings.prefilterMipLevels, settings.brdfLUTSize };
+		return HashBytes(values, sizeof(values), hash);
+	}
+
+	// Creates every missing directory of 'path'.
+	void CreateDirectories(const std::string& path)
+	{
+		for (size_t i = 1; i <= path.size(); i++)
+		{
+			if (i != path.size() && path[i] != '/' && path[i] != '\\')
+				continue;
+#ifdef _WIN32
+			_mkdir(path.substr(0, i).c_str());
+#else
+			mkdir(path.substr(0, i).c_str(), 0755);
+#endif
+		}
+	}
+
+	std::string ToHex(uint64_t value)
+	{
+		char buffer[17];
+		snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)value);
+		return buffer;
+	}
+
+	bool SameSettings(const IBLBakeSettings& a, const IBLBakeSettings& b)
+	{
+		return a.environmentSize == b.environmentSize && a.irradianceSize == b.irradianceSize && a.prefilterSize == b.prefilterSize &&
+			a.prefilterMipLevels == b.prefilterMipLevels && a.brdfLUTSize == b.brdfLUTSize;
+	}
+
+	// Appends one level of a texture target as half floats.
+	void ReadLevel(GLenum target, int level, GLenum format, int components, uint32_t size, std::vector<uint16_t>& out)
+	{
+		size_t offset = out.size();
+		out.resize(offset + (size_t)size * size * components);
+		glGetTexImage(target, level, format, GL_HALF_FLOAT, out.data() + offset);
+	}
+
+	// Uploads one level of a texture target from the stream, returns false on a short read.
+	bool UploadLevel(std::ifstream& in, GLenum target, int level, GLenum format, int components, uint32_t size, std::vector<uint16_t>& scratch)
+	{
+		scratch.resize((size_t)size * size * components);
+		if (!in.read((char*)scratch.data(), scratch.size() * sizeof(uint16_t)))
+			return false;
+		glTexSubImage2D(target, level, 0, 0, size, size, format, GL_HALF_FLOAT, scratch.data());
+		return true;
+	}
+
+	// Writes to a temporary file first, so an interrupted write never leaves a truncated cache file behind.
+	bool WriteFile(const std::string& path, const CacheHeader& header, const uint16_t* data, size_t count)
+	{
+		std::string temporaryPath = path + ".tmp";
+		{
+			std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (!out)
+				return false;
+			out.write((const char*)&header, sizeof(header));
+			out.write((const char*)data, count * sizeof(uint16_t));
+			if (!out)
+				return false;
+		}
+		std::remove(path.c_str());
+		return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+	}
+
+	bool ReadHeader(std::ifstream& in, const char magic[4], uint64_t key, const IBLBakeSettings& settings, CacheHeader& header)
+	{
+		if (!in.read((char*)&header, sizeof(header)))
+			return false;
+		return std::equal(magic, magic + 4, header.magic) && header.version == IBL_CACHE_VERSION && header.key == key && SameSettings(header.settings, settings);
+	}
+}
+
+uint64_t HashFile(const char* path)
+{
+	static std::map<std::string, uint64_t> hashes;
+	static std::mutex hashesMutex;
+	{
+		std::lock_guard<std::mutex> lock(hashesMutex);
+		std::map<std::string, uint64_t>::iterator cached = hashes.find(path);
+		if (cached != hashes.end())
+			return cached->second;
+	}
+
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+		return 0;
+
+	uint64_t hash = FNV_OFFSET_BASIS;
+	std::vector<char> buffer(1 << 20);
+	while (in)
+	{
+		in.read(buffer.data(), buffer.size());
+		hash = HashBytes(buffer.data(), (size_t)in.gcount(), hash);
+	}
+	std::lock_guard<std::mutex> lock(hashesMutex);
+	hashes[path] = hash;
+	return hash;
+}
+
+uint64_t IBLCacheKey(const char* hdrPath, const IBLBakeSettings& settings)
+{
+	return HashSettings(settings, HashFile(hdrPath));
+}
+
+std::string IBLCachePath(const std::string& directory, uint64_t key)
+{
+	CreateDirectories(directory);
+	return directory + "/" + ToHex(key) + ".ibl";
+}
+
+std::string BRDFLUTCachePath(const std::string& directory, const IBLBakeSettings& settings)
+{
+	CreateDirectories(directory);
+	return directory + "/brdf_" + ToHex(HashSettings(settings, FNV_OFFSET_BASIS)) + ".lut";
+}
+
+std::vector<IBLCacheLevel> IBLCacheLayout(const IBLBakeSettings& settings, bool withIrradiance)
+{
+	std::vector<IBLCacheLevel> layout;
+	size_t offset = 0;
+	const auto add = [&](IBLCacheMap map, unsigned int mip, unsigned int size)
+	{
+		for (unsigned int face = 0; face < 6; face++)
+		{
+			layout.push_back({ map, face, mip, size, offset });
+			offset += (size_t)size * size * 3;
+		}
+	};
+
+	add(IBL_ENVIRONMENT_MAP, 0, settings.environmentSize);
+	if (withIrradiance)
+		add(IBL_IRRADIANCE_MAP, 0, settings.irradianceSize);
+	for (unsigned int mip = 0; mip < settings.prefilterMipLevels; mip++)
+		add(IBL_PREFILTER_MAP, mip, settings.prefilterSize >> mip);
+	return layout;
+}
+
+std::vector<uint32_t> PrefilterSampleCounts(const IBLBakeSettings& settings)
+{
+	std::vector<uint32_t> counts(settings.prefilterMipLevels, 1);
+	for (uint32_t mip = 1; mip < settings.prefilterMipLevels; mip++)
+	{
+		// powers of two from 64 samples at roughness 0.25 up to 256, about 2% of the brute force bake's samples per face.
+		float roughness = (float)mip / (float)(settings.prefilterMipLevels - 1);
+		uint32_t count = 64;
+		while (count < 256 && count < 256.0f * roughness)
+			count *= 2;
+		counts[mip] = count;
+	}
+	return counts;
+}
+
+size_t IBLCacheDataSize(const std::vector<IBLCacheLevel>& layout)
+{
+	if (layout.empty())
+		return 0;
+	const IBLCacheLevel& last = layout.back();
+	return last.offset + (size_t)last.size * last.size * 3;
+}
+
+bool ReadIBLCacheFile(const std::string& path, uint64_t key, const IBLBakeSettings& settings, std::vector<uint16_t>& data, bool& withIrradiance)
+{
+	std::ifstream in(path, std::ios::binary);
+	CacheHeader header;
+	if (!in || !ReadHeader(in, IBL_CACHE_MAGIC, key, settings, header))
+		return false;
+
+	withIrradiance = (header.flags & IBL_CACHE_HAS_IRRADIANCE) != 0;
+	data.resize(IBLCacheDataSize(IBLCacheLayout(settings, withIrradiance)));
+	if (!in.read((char*)data.data(), data.size() * sizeof(uint16_t)))
+	{
+		std::cout << "IBL cache " << path << " is truncated, baking again." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool WriteIBLCacheFile(const std::string& path, uint64_t key, const IBLBakeSettings& settings, const uint16_t* data, size_t count, bool withIrradiance)
+{
+	// zeroed padding, so the same bake always writes the same bytes.
+	CacheHeader header = {};
+	std::copy(IBL_CACHE_MAGIC, IBL_CACHE_MAGIC + 4, header.magic);
+	header.version = IBL_CACHE_VERSION;
+	header.key = key;
+	header.settings = settings;
+	header.flags = withIrradiance ? IBL_CACHE_HAS_IRRADIANCE : 0;
+	if (!WriteFile(path, header, data, count))
+	{
+		std::cout << "Failed to write IBL cache " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool ReadBRDFLUTCacheFile(const std::string& path, const IBLBakeSettings& settings, std::vector<uint16_t>& data)
+{
+	std::ifstream in(path, std::ios::binary);
+	CacheHeader header;
+	if (!in || !ReadHeader(in, BRDF_CACHE_MAGIC, 0, settings, header))
+		return false;
+
+	data.resize((size_t)settings.brdfLUTSize * settings.brdfLUTSize * 2);
+	return (bool)in.read((char*)data.data(), data.size() * sizeof(uint16_t));
+}
+
+bool WriteBRDFLUTCacheFile(const std::string& path, const IBLBakeSettings& settings, const uint16_t* data, size_t count)
+{
+	// zeroed padding, so the same bake always writes the same bytes.
+	CacheHeader header = {};
+	std::copy(BRDF_CACHE_MAGIC, BRDF_CACHE_MAGIC + 4, header.magic);
+	header.version = IBL_CACHE_VERSION;
+	header.key = 0;
+	header.settings = settings;
+	header.flags = 0;
+	if (!WriteFile(path, header, data, count))
+	{
+		std::cout << "Failed to write BRDF LUT cache " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool SaveIBLCache(const std::string& path, uint64_t key, const IBLBakeSettings& settings, unsigned int envCubemap, unsigned int irradianceMap, unsigned int prefilterMap)
+{
+	const unsigned int textures[] = { envCubemap, irradianceMap, prefilterMap };
+	std::vector<IBLCacheLevel> layout = IBLCacheLayout(settings, irradianceMap != 0);
+	std::vector<uint16_t> data(IBLCacheDataSize(layout));
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	for (const IBLCacheLevel& level : layout)
+	{
+		glBindTexture(GL_TEXTURE_CUBE_MAP, textures[level.map]);
+		glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + level.face, level.mip, GL_RGB, GL_HALF_FLOAT, data.data() + level.offset);
+	}
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	return WriteIBLCacheFile(path, key, settings, data.data(), data.size(), irradianceMap != 0);
+}
+
+bool LoadIBLCache(const std::string& path, uint64_t key, const IBLBakeSettings& settings, unsigned int envCubemap, unsigned int irradianceMap, unsigned int prefilterMap)
+{
+	std::vector<uint16_t> data;
+	bool storedIrradiance = false;
+	if (!ReadIBLCacheFile(path, key, settings, data, storedIrradiance))
+		return false;
+	if (irradianceMap != 0 && !storedIrradiance)
+		return false;
+
+	const unsigned int textures[] = { envCubemap, irradianceMap, prefilterMap };
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (const IBLCacheLevel& level : IBLCacheLayout(settings, storedIrradiance))
+	{
+		if (textures[level.map] == 0)
+			continue;
+		glBindTexture(GL_TEXTURE_CUBE_MAP, textures[level.map]);
+		glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + level.face, level.mip, 0, 0, level.size, level.size, GL_RGB, GL_HALF_FLOAT, data.data() + level.offset);
+	}
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	return true;
+}
+
+bool SaveBRDFLUTCache(const std::string& path, const IBLBakeSettings& settings, unsigned int brdfLUTTexture)
+{
+	std::vector<uint16_t> data;
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+	ReadLevel(GL_TEXTURE_2D, 0, GL_RG, 2, settings.brdfLUTSize, data);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	return WriteBRDFLUTCacheFile(path, settings, data.data(), data.size());
+}
+
+bool LoadBRDFLUTCache(const std::string& path, const IBLBakeSettings& settings, unsigned int brdfLUTTexture)
+{
+	std::ifstream in(path, std::ios::binary);
+	CacheHeader header;
+	if (!in || !ReadHeader(in, BRDF_CACHE_MAGIC, 0, settings, header))
+		return false;
+
+	std::vector<uint16_t> scratch;
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+	bool complete = UploadLevel(in, GL_TEXTURE_2D, 0, GL_RG, 2, settings.brdfLUTSize, scratch);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	return complete;
+}
@@ -0,0 +1,84 @@
+#ifndef IBL_CACHE_H
+#define IBL_CACHE_H
+
+#include <string>
+#include <cstdint>
+#include <vector>
+
+// Bump whenever the bake shaders or the cache layout change, so stale cache files are ignored.
+const uint32_t IBL_CACHE_VERSION = 3;
+
+// Sizes the IBL maps are baked at. Part of the cache key.
+struct IBLBakeSettings
+{
+	uint32_t environmentSize = 1024;
+	uint32_t irradianceSize = 64;
+	uint32_t prefilterSize = 256;
+	uint32_t prefilterMipLevels = 5;
+	uint32_t brdfLUTSize = 1024;
+};
+
+// Most prefilter mips prefilter.fs takes a sample count for (the size of its sampleCounts array).
+const uint32_t PREFILTER_MAX_MIP_LEVELS = 8;
+// GGX samples per texel the prefilter bake used to take at every roughness, the reference its sample schedule is measured against.
+const uint32_t PREFILTER_BRUTE_FORCE_SAMPLES = 1024;
+
+// GGX samples per texel of each prefilter mip. Every sample reads the environment mip whose texels cover the sample's share of
+// the lobe (filtered importance sampling), so the count only has to resolve the lobe's shape: one for the mirror mip, more as the
+// lobe widens.
+std::vector<uint32_t> PrefilterSampleCounts(const IBLBakeSettings& settings);
+
+// 64-bit FNV-1a hash of a file's contents (0 if the file can't be read). Results are memoized per path, thread safe.
+uint64_t HashFile(const char* path);
+
+// Cache key of the baked maps of an HDR environment: hash of the HDR source, the bake settings & cache version.
+uint64_t IBLCacheKey(const char* hdrPath, const IBLBakeSettings& settings);
+
+// Path of the cache file for a key in the given directory (which is created if missing).
+std::string IBLCachePath(const std::string& directory, uint64_t key);
+// Path of the BRDF LUT cache file, it only depends on the bake settings.
+std::string BRDFLUTCachePath(const std::string& directory, const IBLBakeSettings& settings);
+
+// Map of an IBL cache file a stored level belongs to.
+enum IBLCacheMap
+{
+	IBL_ENVIRONMENT_MAP,
+	IBL_IRRADIANCE_MAP,
+	IBL_PREFILTER_MAP
+};
+
+// One cubemap face level stored in an IBL cache file as RGB half floats.
+struct IBLCacheLevel
+{
+	IBLCacheMap map;
+	unsigned int face;
+	unsigned int mip;
+	unsigned int size;
+	size_t offset;	// in half floats from the start of the data.
+};
+
+// Levels stored in an IBL cache file, in file order.
+std::vector<IBLCacheLevel> IBLCacheLayout(const IBLBakeSettings& settings, bool withIrradiance);
+// Number of half floats of all levels of a layout.
+size_t IBLCacheDataSize(const std::vector<IBLCacheLevel>& layout);
+
+// CPU only, safe to call from worker threads. 'data' is laid out as IBLCacheLayout(settings, withIrradiance).
+bool ReadIBLCacheFile(const std::string& path, uint64_t key, const IBLBakeSettings& settings, std::vector<uint16_t>& data, bool& withIrradiance);
+bool WriteIBLCacheFile(const std::string& path, uint64_t key, const IBLBakeSettings& settings, const uint16_t* data, size_t count, bool withIrradiance);
+// Same for the BRDF LUT file, 'data' holds brdfLUTSize * brdfLUTSize RG pairs.
+bool ReadBRDFLUTCacheFile(const std::string& path, const IBLBakeSettings& settings, std::vector<uint16_t>& data);
+bool WriteBRDFLUTCacheFile(const std::string& path, const IBLBakeSettings& settings, const uint16_t* data, size_t count);
+
+// Reads back mip 0 of the environment cubemap, the irradiance cubemap & every prefilter mip as half floats and writes them to 'path'.
+// Pass 0 as irradianceMap to store the file without it (irradiance from spherical harmonics).
+bool SaveIBLCache(const std::string& path, uint64_t key, const IBLBakeSettings& settings, unsigned int envCubemap, unsigned int irradianceMap, unsigned int prefilterMap);
+// Uploads a cache file written by SaveIBLCache into already allocated textures. Returns false if the file is missing or doesn't match.
+// The environment cubemap's mip chain has to be regenerated by the caller.
+// An irradianceMap of 0 skips the stored irradiance, a file stored without irradiance doesn't match a non 0 irradianceMap.
+bool LoadIBLCache(const std::string& path, uint64_t key, const IBLBakeSettings& settings, unsigned int envCubemap, unsigned int irradianceMap, unsigned int prefilterMap);
+
+// Same for the 2D BRDF LUT (RG half floats).
+bool SaveBRDFLUTCache(const std::string& path, const IBLBakeSettings& settings, unsigned int brdfLUTTexture);
+bool LoadBRDFLUTCache(const std::string& path, const IBLBakeSettings& settings, unsigned int brdfLUTTexture);
+
+#endif
@@ -12,6 +12,7 @@
 #include "../../vendor/glm/gtc/quaternion.hpp"
 #include "../../vendor/glm/gtc/type_ptr.hpp"
 
+#include "Frustum.h"
 #include "Shader.h"
 
 using namespace std;
@@ -102,10 +103,26 @@ struct Texture
     }
 };
 
+// Material shader variant features, bit i enables the define MaterialFeatureNames()[i].
+enum MaterialFeature : unsigned int
+{
+    MATERIAL_BASE_COLOR_TEXTURE         = 1 << 0,
+    MATERIAL_METALLIC_ROUGHNESS_TEXTURE = 1 << 1,
+    MATERIAL_EMISSION_TEXTURE           = 1 << 2,
+    MATERIAL_NORMAL_TEXTURE             = 1 << 3
+};
+
+inline const vector<string>& MaterialFeatureNames()
+{
+    static const vector<string> names = { "HAS_BASE_COLOR_TEXTURE", "HAS_METALLIC_ROUGHNESS_TEXTURE", "HAS_EMISSION_TEXTURE", "HAS_NORMAL_TEXTURE" };
+    return names;
+}
+
 struct Material_GLTF
 {
     float metallicFactor;
     float roughnessFactor;
+    float emissionStrength;
 
     Texture baseColorTexture;
     Texture metallicRoughnessTexture;
@@ -116,6 +133,7 @@ struct Material_GLTF
     {
         this->metallicFactor = 0.0f;
         this->roughnessFactor = 1.0f;
+        this->emissionStrength = 1.0f;
     }
 
     Material_GLTF(vector<Texture> textures, float metallicFactor = 0.0f, float roughnessFactor = 1.0f)
@@ -143,6 +161,18 @@ struct Material_GLTF
 
         this->metallicFactor = metallicFactor;
         this->roughnessFactor = roughnessFactor;
+        this->emissionStrength = 1.0f;
+    }
+
+    // the shader variant features needed to render this material.
+    unsigned int FeatureMask() const
+    {
+        unsigned int mask = 0;
+        if (baseColorTexture.type != TextureType::None)         mask |= MATERIAL_BASE_COLOR_TEXTURE;
+        if (metallicRoughnessTexture.type != TextureType::None) mask |= MATERIAL_METALLIC_ROUGHNESS_TEXTURE;
+        if (emissiveTexture.type != TextureType::None)          mask |= MATERIAL_EMISSION_TEXTURE;
+        if (normalTexture.type != TextureType::None)            mask |= MATERIAL_NORMAL_TEXTURE;
+        return mask;
     }
 };
 
@@ -154,6 +184,8 @@ public:
     vector<unsigned int> indices;
     Material_GLTF material;
     unsigned int VAO;
+    // Bounds of the vertex positions, in mesh space.
+    AABB bounds;
 
     // constructor
     Mesh_GLTF(vector<Vertex> vertices, vector<unsigned int> indices, Material_GLTF material)
@@ -162,6 +194,13 @@ public:
         this->indices = indices;
         this->material = material;
 
+        if (!vertices.empty())
+        {
+            bounds = AABB(vertices[0].Position, vertices[0].Position);
+            for (const Vertex& vertex : vertices)
+                bounds.Expand(vertex.Position);
+        }
+
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
         setupMesh();
     }
@@ -178,65 +217,51 @@ public:
         glBindVertexArray(0);
     }
 
-    // render the mesh
+    // render the mesh with the variant of 'shader' that matches its material, so missing textures aren't sampled.
+    // the material textures use fixed units: base color - 0, metallic roughness - 1, emission - 2, normal - 3.
     void Draw(Shader& shader, mat4 meshMatrix)
     {
-        //Cache Sizes of All Textures.
-        int baseColorTextureOffset = material.baseColorTexture.type != TextureType::None ? 1 : 0;
-        int metallicRoughnessTextureOffset = material.metallicRoughnessTexture.type != TextureType::None ? 1 : 0;
-        int emissiveTextureOffset = material.emissiveTexture.type != TextureType::None ? 1 : 0;
-        int normalTextureOffset = material.normalTexture.type != TextureType::None ? 1 : 0;
+        unsigned int features = material.FeatureMask();
+        Shader& variant = shader.Variant(features);
+        variant.use();
 
-        if (baseColorTextureOffset)
+        if (features & MATERIAL_BASE_COLOR_TEXTURE)
         {
             //Bind Base Color Texture!
             glActiveTexture(GL_TEXTURE0);
-            glUniform1i(glGetUniformLocation(shader.ID, "material.baseColorTexture"), 0);
-            glUniform1ui(glGetUniformLocation(shader.ID, "material.hasBCT"), 1);
             glBindTexture(GL_TEXTURE_2D, material.baseColorTexture.ID);
         }
 
-        if (metallicRoughnessTextureOffset)
+        if (features & MATERIAL_METALLIC_ROUGHNESS_TEXTURE)
         {
             //Bind All Metallic Roughness Textures!
-            glActiveTexture(GL_TEXTURE0 + baseColorTextureOffset);
-            glUniform1i(glGetUniformLocation(shader.ID, "material.metallicRoughnessTexture"), baseColorTextureOffset);
-            glUniform1ui(glGetUniformLocation(shader.ID, "material.hasMRT"), 1);
+            glActiveTexture(GL_TEXTURE1);
             glBindTexture(GL_TEXTURE_2D, material.metallicRoughnessTexture.ID);
         }
 
-        if (emissiveTextureOffset)
+        if (features & MATERIAL_EMISSION_TEXTURE)
         {
             //Bind All Emissive Textures!
-            int offset = baseColorTextureOffset + metallicRoughnessTextureOffset;
-            glActiveTexture(GL_TEXTURE0 + offset);
-            glUniform1i(glGetUniformLocation(shader.ID, "material.emissionTexture"), offset);
-            glUniform1ui(glGetUniformLocation(shader.ID, "material.hasET"), 1);
+            glActiveTexture(GL_TEXTURE2);
             glBindTexture(GL_TEXTURE_2D, material.emissiveTexture.ID);
         }
         
-        if (normalTextureOffset)
+        if (features & MATERIAL_NORMAL_TEXTURE)
         {
-            int offset = baseColorTextureOffset + metallicRoughnessTextureOffset + emissiveTextureOffset;
-            glActiveTexture(GL_TEXTURE0 + offset);
-            glUniform1i(glGetUniformLocation(shader.ID, "material.normalTexture"), offset);
-            glUniform1ui(glGetUniformLocation(shader.ID, "material.hasNT"), 1);
+            glActiveTexture(GL_TEXTURE3);
             glBindTexture(GL_TEXTURE_2D, material.normalTexture.ID);
         }
 
         //Set The Additional Material Properties.
-        glUniform1f(glGetUniformLocation(shader.ID, "material.metallicFactor"), material.metallicFactor);
-        glUniform1f(glGetUniformLocation(shader.ID, "material.roughnessFactor"), material.roughnessFactor);
+        glUniform1f(glGetUniformLocation(variant.ID, "material.metallicFactor"), material.metallicFactor);
+        glUniform1f(glGetUniformLocation(variant.ID, "material.roughnessFactor"), material.roughnessFactor);
+        glUniform1f(glGetUniformLocation(variant.ID, "material.emissionStrength"), material.emissionStrength);
 
-        glUniformMatrix4fv(glGetUniformLocation(shader.ID, "model"), 1, GL_FALSE, value_ptr(meshMatrix));
+        glUniformMatrix4fv(glGetUniformLocation(variant.ID, "model"), 1, GL_FALSE, value_ptr(meshMatrix));
         // draw mesh
         glBindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
-        glUniform1ui(glGetUniformLocation(shader.ID, "material.hasBCT"), 0);
-        glUniform1ui(glGetUniformLocation(shader.ID, "material.hasMRT"), 0);
-        glUniform1ui(glGetUniformLocation(shader.ID, "material.hasET"), 0);
-        glUniform1ui(glGetUniformLocation(shader.ID, "material.hasNT"), 0);
 
         // always good practice to set everything back to defaults once configured.
         glActiveTexture(GL_TEXTURE0);
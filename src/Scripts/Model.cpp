@@ -20,6 +20,8 @@ std::string get_file_contents(const char* filename)
 
 Model::Model(const char* file)
 {
+	CpuProfiler::Scope profile("Model");
+
 	// Make a JSON object
 	std::string text = get_file_contents(file);
 	JSON = json::parse(text);
@@ -44,6 +46,36 @@ void Model::SimpleDraw(Shader& shader, mat4 model)
 		meshes[i].Mesh_GLTF::SimpleDraw(shader, model * matricesMeshes[i] * blenderImportRotation);
 }
 
+unsigned int Model::SimpleDraw(Shader& shader, mat4 model, const Frustum& frustum)
+{
+	// Skip the meshes outside the frustum.
+	unsigned int drawn = 0;
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		mat4 meshMatrix = model * matricesMeshes[i] * blenderImportRotation;
+		if (!frustum.Intersects(meshes[i].bounds.Transformed(meshMatrix)))
+			continue;
+		meshes[i].Mesh_GLTF::SimpleDraw(shader, meshMatrix);
+		drawn++;
+	}
+	return drawn;
+}
+
+AABB Model::Bounds(mat4 model) const
+{
+	// Union of the transformed bounds of every mesh.
+	AABB bounds;
+	for (unsigned int i = 0; i < meshes.size(); i++)
+	{
+		AABB meshBounds = meshes[i].bounds.Transformed(model * matricesMeshes[i] * blenderImportRotation);
+		if (i == 0)
+			bounds = meshBounds;
+		bounds.Expand(meshBounds.min);
+		bounds.Expand(meshBounds.max);
+	}
+	return bounds;
+}
+
 void Model::Draw(Shader& shader, mat4 model)
 {
 	// Go over all meshes and draw each one
@@ -16,6 +16,10 @@ public:
 	Model(const char* file);
 	void Draw(Shader& shader, mat4 model);
 	void SimpleDraw(Shader& shader, mat4 model);
+	// Draws only the meshes whose bounds intersect 'frustum', without any texturing. Returns the number of meshes drawn.
+	unsigned int SimpleDraw(Shader& shader, mat4 model, const Frustum& frustum);
+	// World space bounds of all meshes drawn with 'model'.
+	AABB Bounds(mat4 model) const;
 
 	// All the meshes and transformations
 	std::vector<Mesh_GLTF> meshes;
@@ -0,0 +1,395 @@
+#include "PointShadowCache.h"
+
+#include "../../vendor/glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+	const unsigned int ALL_FACES = 0x3F;
+
+	// face texels per pixel of the light's influence on screen, a light filling the screen gets a face of half its height.
+	const float TEXELS_PER_PIXEL = 0.5f;
+
+	// priority of a dirty face out of view per frame it waits, so those catch up too.
+	const float UNSEEN_FACE_PRIORITY = 0.1f;
+}
+
+bool CasterTransform::Set(const glm::mat4& matrix)
+{
+	if (version != 0 && matrix == this->matrix)
+		return false;
+	this->matrix = matrix;
+	version++;
+	return true;
+}
+
+PointShadowCache::PointShadowCache(unsigned int lightCount, const std::vector<unsigned int>& tierSizes, size_t budgetBytes, unsigned int depthFormat)
+	: atlas(tierSizes, budgetBytes, depthFormat), lights(lightCount), frame(0),
+	filterShader(PROJECT_DIR"/src/Shaders/shadowFilter.vs", PROJECT_DIR"/src/Shaders/shadowFilter.fs"), filterProgram(filterShader.ID),
+	hasView(false), cameraPosition(0.0f), tanHalfFovY(1.0f), viewportHeight(0.0f), facesPerFrame(0), fullRefreshDistance(0.0f),
+	staticVersion(0), dynamicVersion(0), lightsRendered(0), facesRendered(0), castersDrawn(0), facesFiltered(0), facesPending(0)
+{
+	// depth only framebuffers, the faces are attached as they're rendered.
+	glGenFramebuffers(1, &readFBO);
+	glGenFramebuffers(1, &drawFBO);
+	for (unsigned int framebuffer : { readFBO, drawFBO })
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+	}
+
+	glGenFramebuffers(1, &filterFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, filterFBO);
+	glDrawBuffer(GL_COLOR_ATTACHMENT0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glGenVertexArrays(1, &filterVAO);
+}
+
+PointShadowCache::~PointShadowCache()
+{
+	const unsigned int framebuffers[] = { readFBO, drawFBO, filterFBO };
+	glDeleteFramebuffers(3, framebuffers);
+	glDeleteVertexArrays(1, &filterVAO);
+}
+
+void PointShadowCache::SetLight(unsigned int index, const glm::vec3& position, float nearPlane, float farPlane)
+{
+	Light& light = lights[index];
+	if (light.position == position && light.nearPlane == nearPlane && light.farPlane == farPlane)
+		return;
+	light.position = position;
+	light.nearPlane = nearPlane;
+	light.farPlane = farPlane;
+	light.changed = true;
+}
+
+void PointShadowCache::SetFiltered(unsigned int index, bool filtered, float exponent)
+{
+	Light& light = lights[index];
+	if (light.filtered == filtered && light.filterExponent == exponent)
+		return;
+	light.filtered = filtered;
+	light.filterExponent = exponent;
+	light.filterValid = false;
+}
+
+void PointShadowCache::SetTimeSlicing(unsigned int facesPerFrame, float fullRefreshDistance)
+{
+	this->facesPerFrame = facesPerFrame;
+	this->fullRefreshDistance = fullRefreshDistance;
+}
+
+void PointShadowCache::SetView(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, float tanHalfFovY, float viewportHeight)
+{
+	hasView = true;
+	viewFrustum = Frustum(viewProjection);
+	this->cameraPosition = cameraPosition;
+	this->tanHalfFovY = tanHalfFovY;
+	this->viewportHeight = viewportHeight;
+}
+
+void PointShadowCache::SetCasters(uint64_t staticVersion, const AABB& staticBounds, uint64_t dynamicVersion, const AABB& dynamicBounds)
+{
+	this->staticVersion = staticVersion;
+	this->staticBounds = staticBounds;
+	this->dynamicVersion = dynamicVersion;
+	this->dynamicBounds = dynamicBounds;
+}
+
+void PointShadowCache::InvalidateAll()
+{
+	for (Light& light : lights)
+		light.staticValid = false;
+}
+
+void PointShadowCache::FaceTransforms(const glm::vec3& position, float nearPlane, float farPlane, glm::mat4 transforms[6])
+{
+	glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+	transforms[0] = projection * glm::lookAt(position, position + glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+	transforms[1] = projection * glm::lookAt(position, position + glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+	transforms[2] = projection * glm::lookAt(position, position + glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f));
+	transforms[3] = projection * glm::lookAt(position, position + glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f));
+	transforms[4] = projection * glm::lookAt(position, position + glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+	transforms[5] = projection * glm::lookAt(position, position + glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+}
+
+float PointShadowCache::DesiredResolution(const Light& light) const
+{
+	if (!hasView)
+		return (float)atlas.TierSize(0);
+
+	// the camera inside the sphere sees it fill the screen, else its projected diameter from the angle it subtends.
+	float distance = glm::length(light.position - cameraPosition);
+	if (distance <= light.farPlane)
+		return viewportHeight * TEXELS_PER_PIXEL;
+	float tanRadius = std::tan(std::asin(light.farPlane / distance));
+	return std::min(tanRadius / tanHalfFovY, 1.0f) * viewportHeight * TEXELS_PER_PIXEL;
+}
+
+void PointShadowCache::MarkDirty(Light& light, const Frustum frustums[6])
+{
+	if (light.changed)
+	{
+		// stale faces are looked up with the new position, fine for small moves. New planes change how the depth is read back.
+		float moved = 0.0f;
+		for (unsigned int face = 0; face < 6; ++face)
+			moved = std::max(moved, glm::length(light.position - light.facePositions[face]));
+		if (light.nearPlane != light.renderedNearPlane || light.farPlane != light.renderedFarPlane || moved > fullRefreshDistance)
+			light.staticValid = false;
+		else
+			light.staticDirtyFaces = ALL_FACES;
+		light.changed = false;
+	}
+
+	// a caster change only matters to the faces that see where the caster was or is now.
+	unsigned int compositeDirtyFaces = 0;
+	for (unsigned int face = 0; face < 6; ++face)
+	{
+		if (light.staticVersion != staticVersion && (frustums[face].Intersects(light.staticBounds) || frustums[face].Intersects(staticBounds)))
+			light.staticDirtyFaces |= 1u << face;
+		if (light.dynamicVersion != dynamicVersion && ((light.dynamicFaces & (1u << face)) || frustums[face].Intersects(dynamicBounds)))
+			compositeDirtyFaces |= 1u << face;
+	}
+	light.staticVersion = staticVersion;
+	light.staticBounds = staticBounds;
+	light.dynamicVersion = dynamicVersion;
+	light.dynamicBounds = dynamicBounds;
+
+	if (!light.staticValid)
+		light.staticDirtyFaces = ALL_FACES;
+	unsigned int dirtyFaces = light.staticDirtyFaces | compositeDirtyFaces;
+	for (unsigned int face = 0; face < 6; ++face)
+	{
+		if ((dirtyFaces & (1u << face)) && !(light.dirtyFaces & (1u << face)))
+			light.dirtySince[face] = frame;
+	}
+	light.dirtyFaces |= dirtyFaces;
+}
+
+float PointShadowCache::ViewCoverage(const Light& light, unsigned int face) const
+{
+	if (!hasView)
+		return 1.0f;
+
+	// fraction of a 3x3x3 grid of points in the face's pyramid that are in view.
+	int axis = face / 2;
+	glm::vec3 forward(0.0f), right(0.0f), up(0.0f);
+	forward[axis] = face % 2 ? -1.0f : 1.0f;
+	right[(axis + 1) % 3] = 1.0f;
+	up[(axis + 2) % 3] = 1.0f;
+	unsigned int inside = 0;
+	for (float depth : { 1.0f / 6.0f, 0.5f, 5.0f / 6.0f })
+		for (float u : { -2.0f / 3.0f, 0.0f, 2.0f / 3.0f })
+			for (float v : { -2.0f / 3.0f, 0.0f, 2.0f / 3.0f })
+				inside += viewFrustum.Intersects(light.position + (forward + right * u + up * v) * depth * light.farPlane, 0.0f);
+	return inside / 27.0f;
+}
+
+void PointShadowCache::RenderFace(Shader& shader, Light& light, unsigned int face, const glm::mat4& transform, const Frustum& frustum,
+	const DrawCasters& drawStatic, const DrawCasters& drawDynamic)
+{
+	GLint size = (GLint)atlas.TierSize(light.tier);
+	unsigned int staticTexture = atlas.StaticTexture(light.tier);
+	GLint layer = light.slot * 6 + face;
+	glViewport(0, 0, size, size);
+	shader.setMat4("shadowMatrix", transform);
+
+	if (light.staticDirtyFaces & (1u << face))
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, drawFBO);
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticTexture, 0, layer);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		castersDrawn += drawStatic(frustum);
+		light.staticDirtyFaces &= ~(1u << face);
+	}
+
+	// copy the static layer's face, then draw the dynamic casters over it.
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
+	glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticTexture, 0, layer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFBO);
+	glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, atlas.Texture(light.tier), 0, layer);
+	glBlitFramebuffer(0, 0, size, size, 0, 0, size, size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	unsigned int drawn = drawDynamic(frustum);
+	castersDrawn += drawn;
+	if (drawn)
+		light.dynamicFaces |= 1u << face;
+	else
+		light.dynamicFaces &= ~(1u << face);
+
+	light.dirtyFaces &= ~(1u << face);
+	light.facePositions[face] = light.position;
+	light.filterValid = false;
+	facesRendered++;
+}
+
+void PointShadowCache::Update(Shader& shader, const DrawCasters& drawStatic, const DrawCasters& drawDynamic)
+{
+	lightsRendered = facesRendered = castersDrawn = facesFiltered = facesPending = 0;
+	frame++;
+
+	// lights in view, largest on screen first so they win the slots of the larger tiers.
+	std::vector<std::pair<float, unsigned int>> visible;
+	for (unsigned int i = 0; i < lights.size(); i++)
+	{
+		if (!hasView || viewFrustum.Intersects(lights[i].position, lights[i].farPlane))
+			visible.push_back(std::make_pair(DesiredResolution(lights[i]), i));
+	}
+	std::sort(visible.begin(), visible.end(), [](const std::pair<float, unsigned int>& a, const std::pair<float, unsigned int>& b) { return a.first > b.first; });
+
+	for (const std::pair<float, unsigned int>& entry : visible)
+	{
+		Light& light = lights[entry.second];
+		unsigned int tier, slot;
+		bool fresh;
+		if (!atlas.Acquire((int)entry.second, atlas.TierFor(entry.first), frame, tier, slot, fresh))
+			continue;
+		if (fresh)
+			light.staticValid = false;
+		light.tier = (int)tier;
+		light.slot = (int)slot;
+	}
+
+	// slots taken by other lights this frame.
+	for (unsigned int i = 0; i < lights.size(); i++)
+	{
+		Light& light = lights[i];
+		if (light.tier >= 0 && !atlas.Owns((int)i, light.tier, light.slot))
+		{
+			light.tier = light.slot = -1;
+			light.staticValid = false;
+		}
+	}
+
+	// faces of the lights in view & their transforms, lights without valid contents are refreshed in full right away.
+	std::vector<glm::mat4> transforms(lights.size() * 6);
+	std::vector<Frustum> frustums(lights.size() * 6);
+	std::vector<unsigned int> refreshes;
+	std::vector<std::pair<float, unsigned int>> pending;	// priority, light * 6 + face.
+	for (const std::pair<float, unsigned int>& entry : visible)
+	{
+		unsigned int index = entry.second;
+		Light& light = lights[index];
+		if (light.tier < 0)
+			continue;
+
+		FaceTransforms(light.position, light.nearPlane, light.farPlane, &transforms[index * 6]);
+		for (unsigned int face = 0; face < 6; ++face)
+			frustums[index * 6 + face] = Frustum(transforms[index * 6 + face]);
+		MarkDirty(light, &frustums[index * 6]);
+
+		if (!light.staticValid)
+		{
+			refreshes.push_back(index);
+			continue;
+		}
+
+		// faces covering more of the view first, the longer a face waits the more it counts.
+		for (unsigned int face = 0; face < 6; ++face)
+		{
+			if (light.dirtyFaces & (1u << face))
+			{
+				float waited = (float)(frame - light.dirtySince[face] + 1);
+				pending.push_back(std::make_pair((ViewCoverage(light, face) + UNSEEN_FACE_PRIORITY) * waited, index * 6 + face));
+			}
+		}
+	}
+	std::sort(pending.begin(), pending.end(), [](const std::pair<float, unsigned int>& a, const std::pair<float, unsigned int>& b) { return a.first > b.first; });
+	size_t budget = facesPerFrame == 0 ? pending.size() : std::min(pending.size(), (size_t)facesPerFrame);
+	facesPending = (unsigned int)(pending.size() - budget);
+	if (refreshes.empty() && budget == 0)
+	{
+		Filter(visible);
+		return;
+	}
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	shader.use();
+	std::vector<bool> rendered(lights.size(), false);
+
+	for (unsigned int index : refreshes)
+	{
+		Light& light = lights[index];
+		for (unsigned int face = 0; face < 6; ++face)
+			RenderFace(shader, light, face, transforms[index * 6 + face], frustums[index * 6 + face], drawStatic, drawDynamic);
+		light.staticValid = true;
+		light.renderedNearPlane = light.nearPlane;
+		light.renderedFarPlane = light.farPlane;
+		rendered[index] = true;
+	}
+
+	for (size_t i = 0; i < budget; i++)
+	{
+		unsigned int index = pending[i].second / 6;
+		unsigned int face = pending[i].second % 6;
+		RenderFace(shader, lights[index], face, transforms[pending[i].second], frustums[pending[i].second], drawStatic, drawDynamic);
+		rendered[index] = true;
+	}
+
+	lightsRendered = (unsigned int)std::count(rendered.begin(), rendered.end(), true);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+	Filter(visible);
+}
+
+void PointShadowCache::Filter(const std::vector<std::pair<float, unsigned int>>& visible)
+{
+	// a reloaded filter shader invalidates every filtered map.
+	if (filterShader.ID != filterProgram)
+	{
+		filterProgram = filterShader.ID;
+		for (Light& light : lights)
+			light.filterValid = false;
+	}
+
+	GLint viewport[4];
+	bool started = false;
+	for (const std::pair<float, unsigned int>& entry : visible)
+	{
+		Light& light = lights[entry.second];
+		if (!light.filtered || light.filterValid || light.tier < 0)
+			continue;
+
+		if (!started)
+		{
+			glGetIntegerv(GL_VIEWPORT, viewport);
+			filterShader.use();
+			glBindFramebuffer(GL_FRAMEBUFFER, filterFBO);
+			glBindVertexArray(filterVAO);
+			glActiveTexture(GL_TEXTURE0);
+			glBindSampler(0, atlas.DepthSampler());
+			started = true;
+		}
+
+		GLint size = (GLint)atlas.TierSize(light.tier);
+		glViewport(0, 0, size, size);
+		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, atlas.Texture(light.tier));
+		filterShader.setInt("cubemap", light.slot);
+		filterShader.setFloat("faceSize", (float)size);
+		filterShader.setFloat("exponent", light.filterExponent);
+		filterShader.setFloat("nearPlane", light.nearPlane);
+		filterShader.setFloat("farPlane", light.farPlane);
+		for (unsigned int face = 0; face < 6; ++face)
+		{
+			glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, atlas.FilteredTexture(light.tier), 0, light.slot * 6 + face);
+			filterShader.setInt("face", face);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			facesFiltered++;
+		}
+		light.filterValid = true;
+	}
+
+	if (started)
+	{
+		glBindSampler(0, 0);
+		glBindVertexArray(0);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	}
+}
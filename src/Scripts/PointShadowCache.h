@@ -0,0 +1,162 @@
+#ifndef POINT_SHADOW_CACHE_H
+#define POINT_SHADOW_CACHE_H
+
+#include "../../vendor/glm/glm.hpp"
+
+#include "Frustum.h"
+#include "Shader.h"
+#include "ShadowAtlas.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Transform of a shadow caster with a version that changes whenever the transform does.
+class CasterTransform
+{
+public:
+	// Returns true if 'matrix' differs from the current transform (or is the first one).
+	bool Set(const glm::mat4& matrix);
+	const glm::mat4& Matrix() const { return matrix; }
+	uint64_t Version() const { return version; }
+
+private:
+	glm::mat4 matrix = glm::mat4(1.0f);
+	uint64_t version = 0;	// 0 until the first Set.
+};
+
+// Point light shadow cubemaps split into two layers: a cached cubemap of the static casters and the cubemap the lighting samples,
+// which is the static layer with the dynamic casters drawn on top. Each light remembers the light parameters, caster versions &
+// bounds it was rendered with, so only the faces a change reaches are re-rendered. A face's static layer is only redrawn when the
+// light moves or a static caster changes in its frustum, otherwise just the faces the dynamic casters were or are visible in are
+// re-composited. Dirty faces can be spread over frames (SetTimeSlicing).
+// The cubemaps live in a ShadowAtlas: each frame every light whose influence sphere (radius = far plane) is in view gets a slot
+// in the tier matching its projected size on screen, the larger lights first. Lights out of view keep their slot until it's
+// evicted, a light that loses its slot or moves to another tier is rendered again in full. Lights can also keep a prefiltered
+// exponential shadow map, it's refiltered (all faces, the filter crosses face edges) whenever the light's cubemap changes.
+class PointShadowCache
+{
+public:
+	// Draws the casters that intersect a cubemap face's frustum with the bound shadow shader, returns how many were drawn.
+	typedef std::function<unsigned int(const Frustum&)> DrawCasters;
+
+	// 'tierSizes', 'budgetBytes' & 'depthFormat' as for ShadowAtlas.
+	PointShadowCache(unsigned int lightCount, const std::vector<unsigned int>& tierSizes, size_t budgetBytes, unsigned int depthFormat);
+	~PointShadowCache();
+	PointShadowCache(const PointShadowCache&) = delete;
+	PointShadowCache& operator=(const PointShadowCache&) = delete;
+
+	// Depth cubemap arrays of the shadows, the hardware depth of each face's projection (see FaceTransforms).
+	const ShadowAtlas& Atlas() const { return atlas; }
+	// Atlas tier & cubemap of a light's shadows, -1 if the light has no shadows this frame.
+	int ShadowTier(unsigned int light) const { return lights[light].tier; }
+	int ShadowLayer(unsigned int light) const { return lights[light].slot; }
+
+	void SetLight(unsigned int light, const glm::vec3& position, float nearPlane, float farPlane);
+	// Keeps the light's filtered map (ShadowAtlas::FilteredTexture) up to date for exponential shadows with 'exponent'.
+	void SetFiltered(unsigned int light, bool filtered, float exponent);
+	// Camera the shadow resolutions are picked for. Without a view every light is in view at the largest tier.
+	void SetView(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, float tanHalfFovY, float viewportHeight);
+	// Current versions & world bounds of all static & all dynamic casters.
+	void SetCasters(uint64_t staticVersion, const AABB& staticBounds, uint64_t dynamicVersion, const AABB& dynamicBounds);
+	// Renders at most 'facesPerFrame' dirty faces per Update (0 for all of them), the faces covering more of the view & waiting
+	// longer first, until then a face keeps the shadows of where the light was. A light that moved more than 'fullRefreshDistance'
+	// from where one of its faces was rendered, changed its planes or has no valid cubemap is refreshed in full right away,
+	// outside of the budget. The defaults (0, 0) refresh every change in full.
+	void SetTimeSlicing(unsigned int facesPerFrame, float fullRefreshDistance);
+	// Forces every light to be re-rendered, e.g. after the shadow shader was reloaded.
+	void InvalidateAll();
+
+	// Re-renders what changed with 'shader' (shadow.vs / shadow.fs, depth only). Restores the viewport, binds framebuffer 0.
+	void Update(Shader& shader, const DrawCasters& drawStatic, const DrawCasters& drawDynamic);
+
+	// Work done by the last Update.
+	unsigned int LightsRendered() const { return lightsRendered; }
+	unsigned int FacesRendered() const { return facesRendered; }
+	unsigned int CastersDrawn() const { return castersDrawn; }
+	unsigned int FacesFiltered() const { return facesFiltered; }
+	// Dirty faces of lights in view left for later frames.
+	unsigned int FacesPending() const { return facesPending; }
+
+	// Projection * view of each cubemap face of a light.
+	static void FaceTransforms(const glm::vec3& position, float nearPlane, float farPlane, glm::mat4 transforms[6]);
+
+private:
+	struct Light
+	{
+		glm::vec3 position = glm::vec3(0.0f);
+		float nearPlane = 0.0f;
+		float farPlane = 0.0f;
+		bool changed = true;		// light moved or its planes changed since it was rendered.
+
+		// inputs the layers were rendered with.
+		bool staticValid = false;		// false until all faces were rendered into the light's slot.
+		float renderedNearPlane = 0.0f;
+		float renderedFarPlane = 0.0f;
+		glm::vec3 facePositions[6];		// light position each face was rendered from.
+		uint64_t staticVersion = 0;
+		AABB staticBounds;
+		uint64_t dynamicVersion = 0;
+		AABB dynamicBounds;
+		unsigned int dynamicFaces = 0;	// bit per face the dynamic casters were drawn into.
+
+		// faces waiting to be rendered (bit per face), the ones in staticDirtyFaces redraw their static layer too.
+		unsigned int dirtyFaces = 0;
+		unsigned int staticDirtyFaces = 0;
+		uint64_t dirtySince[6] = {};
+
+		bool filtered = false;
+		float filterExponent = 0.0f;
+		bool filterValid = false;		// filtered map matches the cubemap & exponent.
+
+		// atlas slot, -1 if none.
+		int tier = -1;
+		int slot = -1;
+	};
+
+	ShadowAtlas atlas;
+	std::vector<Light> lights;
+	unsigned int readFBO;
+	unsigned int drawFBO;
+	uint64_t frame;
+
+	// shadowFilter.vs / shadowFilter.fs, drawn without vertex buffers.
+	Shader filterShader;
+	unsigned int filterProgram;
+	unsigned int filterFBO;
+	unsigned int filterVAO;
+
+	bool hasView;
+	Frustum viewFrustum;
+	glm::vec3 cameraPosition;
+	float tanHalfFovY;
+	float viewportHeight;
+
+	unsigned int facesPerFrame;
+	float fullRefreshDistance;
+
+	uint64_t staticVersion;
+	AABB staticBounds;
+	uint64_t dynamicVersion;
+	AABB dynamicBounds;
+
+	unsigned int lightsRendered;
+	unsigned int facesRendered;
+	unsigned int castersDrawn;
+	unsigned int facesFiltered;
+	unsigned int facesPending;
+
+	// Turns the light's changes & the caster changes since it was last updated into dirty faces.
+	void MarkDirty(Light& light, const Frustum frustums[6]);
+	// Fraction of a face's frustum (up to the far plane) in view.
+	float ViewCoverage(const Light& light, unsigned int face) const;
+	// Renders a face of the light's cubemap, its static layer first if that's dirty.
+	void RenderFace(Shader& shader, Light& light, unsigned int face, const glm::mat4& transform, const Frustum& frustum,
+		const DrawCasters& drawStatic, const DrawCasters& drawDynamic);
+	// Texels across a cubemap face the light should get, from the size of its influence sphere on screen.
+	float DesiredResolution(const Light& light) const;
+	// Refilters the filtered maps of the lights in 'visible' that need it.
+	void Filter(const std::vector<std::pair<float, unsigned int>>& visible);
+};
+
+#endif
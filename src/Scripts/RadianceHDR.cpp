@@ -0,0 +1,233 @@
+#include "RadianceHDR.h"
+#include "HalfFloat.h"
+#include "CpuProfiler.h"
+
+#include <stb_image.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace
+{
+	// Half float 1.0, the alpha of every pixel.
+	const uint16_t HALF_ONE = 0x3C00;
+
+	// Scanlines decoded per task.
+	const size_t ROWS_PER_TASK = 16;
+
+	bool ReadFile(const char* path, std::vector<uint8_t>& data)
+	{
+		std::ifstream in(path, std::ios::binary | std::ios::ate);
+		if (!in)
+			return false;
+		std::streamsize size = in.tellg();
+		in.seekg(0);
+		data.resize((size_t)size);
+		return (bool)in.read((char*)data.data(), size);
+	}
+
+	// Reads a '\n' terminated line starting at 'position', which is moved past it.
+	bool ReadLine(const std::vector<uint8_t>& data, size_t& position, std::string& line)
+	{
+		size_t end = position;
+		while (end < data.size() && data[end] != '\n')
+			end++;
+		if (end == data.size())
+			return false;
+		line.assign((const char*)data.data() + position, end - position);
+		position = end + 1;
+		return true;
+	}
+
+	// Parses the header & resolution line, returns the offset of the first scanline or 0 if the layout isn't supported.
+	size_t ParseHeader(const std::vector<uint8_t>& data, int& width, int& height)
+	{
+		size_t position = 0;
+		std::string line;
+		if (!ReadLine(data, position, line) || (line.compare(0, 10, "#?RADIANCE") != 0 && line.compare(0, 6, "#?RGBE") != 0))
+			return 0;
+
+		bool rgbe = false;
+		while (ReadLine(data, position, line) && !line.empty())
+			rgbe |= line == "FORMAT=32-bit_rle_rgbe";
+
+		// only the standard orientation, top to bottom & left to right.
+		if (!rgbe || !ReadLine(data, position, line) || std::sscanf(line.c_str(), "-Y %d +X %d", &height, &width) != 2 || width <= 0 || height <= 0)
+			return 0;
+		return position;
+	}
+
+	// Finds where each scanline starts by walking the run lengths without decoding anything.
+	bool ScanlineOffsets(const std::vector<uint8_t>& data, size_t position, int width, int height, std::vector<size_t>& offsets)
+	{
+		const bool runLengthEncoded = width >= 8 && width < 32768;
+		offsets.resize(height);
+		for (int row = 0; row < height; row++)
+		{
+			offsets[row] = position;
+			const uint8_t* bytes = data.data() + position;
+			if (runLengthEncoded && position + 4 <= data.size() && bytes[0] == 2 && bytes[1] == 2 && !(bytes[2] & 0x80))
+			{
+				if (((bytes[2] << 8) | bytes[3]) != width)
+					return false;
+				position += 4;
+				for (int component = 0; component < 4; component++)
+				{
+					for (int x = 0; x < width;)
+					{
+						if (position >= data.size())
+							return false;
+						int count = data[position++];
+						if (count > 128)
+						{
+							count -= 128;
+							position++;
+						}
+						else
+						{
+							position += count;
+						}
+						x += count;
+						if (count == 0 || x > width)
+							return false;
+					}
+				}
+			}
+			else
+			{
+				// flat scanline.
+				position += (size_t)width * 4;
+			}
+			if (position > data.size())
+				return false;
+		}
+		return true;
+	}
+
+	// Decodes the scanline at 'position' into 4 planes of 'width' bytes (R, G, B, E).
+	void DecodeScanline(const uint8_t* bytes, int width, uint8_t* planes)
+	{
+		if (width >= 8 && width < 32768 && bytes[0] == 2 && bytes[1] == 2 && !(bytes[2] & 0x80))
+		{
+			bytes += 4;
+			for (int component = 0; component < 4; component++)
+			{
+				uint8_t* plane = planes + (size_t)component * width;
+				for (int x = 0; x < width;)
+				{
+					int count = *bytes++;
+					if (count > 128)
+					{
+						count -= 128;
+						std::memset(plane + x, *bytes++, count);
+					}
+					else
+					{
+						std::memcpy(plane + x, bytes, count);
+						bytes += count;
+					}
+					x += count;
+				}
+			}
+		}
+		else
+		{
+			for (int x = 0; x < width; x++)
+				for (int component = 0; component < 4; component++)
+					planes[(size_t)component * width + x] = bytes[x * 4 + component];
+		}
+	}
+
+	// RGBE planes to RGBA half floats. Same values as stbi: mantissa * 2^(exponent - 136), 0 for a 0 exponent.
+	void ConvertScanline(const uint8_t* planes, int width, uint16_t* out)
+	{
+		const uint8_t* r = planes;
+		const uint8_t* g = planes + width;
+		const uint8_t* b = planes + 2 * (size_t)width;
+		const uint8_t* e = planes + 3 * (size_t)width;
+		int x = 0;
+#if defined(HALF_FLOAT_USE_F16C) || defined(HALF_FLOAT_USE_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alpha = _mm_set1_epi32(HALF_ONE << 16);
+		const auto load4 = [&zero](const uint8_t* bytes)
+		{
+			int32_t packed;
+			std::memcpy(&packed, bytes, sizeof(packed));
+			return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+		};
+		for (; x + 4 <= width; x += 4)
+		{
+			// 2^(e - 136) built from its exponent bits, exponents below 10 give values far below the smallest half.
+			__m128i exponent = load4(e + x);
+			__m128 scale = _mm_and_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(exponent, _mm_set1_epi32(9)), 23)),
+				_mm_castsi128_ps(_mm_cmpgt_epi32(exponent, _mm_set1_epi32(9))));
+			__m128i red = FloatToHalf4(_mm_mul_ps(_mm_cvtepi32_ps(load4(r + x)), scale));
+			__m128i green = FloatToHalf4(_mm_mul_ps(_mm_cvtepi32_ps(load4(g + x)), scale));
+			__m128i blue = FloatToHalf4(_mm_mul_ps(_mm_cvtepi32_ps(load4(b + x)), scale));
+
+			// interleave to RGBA: (R | G << 16, B | A << 16) pairs.
+			__m128i redGreen = _mm_or_si128(red, _mm_slli_epi32(green, 16));
+			__m128i blueAlpha = _mm_or_si128(blue, alpha);
+			_mm_storeu_si128((__m128i*)(out + (size_t)x * 4), _mm_unpacklo_epi32(redGreen, blueAlpha));
+			_mm_storeu_si128((__m128i*)(out + (size_t)x * 4 + 8), _mm_unpackhi_epi32(redGreen, blueAlpha));
+		}
+#endif
+		// remaining pixels (or all of them without SIMD).
+		for (; x < width; x++)
+		{
+			float scale = e[x] ? (float)std::ldexp(1.0f, e[x] - 136) : 0.0f;
+			uint16_t* pixel = out + (size_t)x * 4;
+			pixel[0] = FloatToHalf(r[x] * scale);
+			pixel[1] = FloatToHalf(g[x] * scale);
+			pixel[2] = FloatToHalf(b[x] * scale);
+			pixel[3] = HALF_ONE;
+		}
+	}
+
+	// Any other layout stbi understands, decoded to floats & converted.
+	bool LoadWithStbi(const char* path, HalfImage& image)
+	{
+		int channels;
+		stbi_set_flip_vertically_on_load_thread(true);
+		float* pixels = stbi_loadf(path, &image.width, &image.height, &channels, 4);
+		if (!pixels)
+			return false;
+		image.pixels.resize((size_t)image.width * image.height * 4);
+		FloatsToHalfs(pixels, image.pixels.data(), image.pixels.size());
+		stbi_image_free(pixels);
+		return true;
+	}
+}
+
+bool LoadRadianceHDR(const char* path, HalfImage& image, ThreadPool& pool)
+{
+	CpuProfiler::Scope profile("LoadRadianceHDR");
+
+	std::vector<uint8_t> data;
+	if (!ReadFile(path, data))
+		return false;
+
+	int width = 0, height = 0;
+	std::vector<size_t> offsets;
+	size_t position = ParseHeader(data, width, height);
+	if (position == 0 || !ScanlineOffsets(data, position, width, height, offsets))
+		return LoadWithStbi(path, image);
+
+	image.width = width;
+	image.height = height;
+	image.pixels.resize((size_t)width * height * 4);
+	pool.ParallelFor(height, ROWS_PER_TASK, [&](size_t begin, size_t end)
+	{
+		std::vector<uint8_t> planes((size_t)width * 4);
+		for (size_t row = begin; row < end; row++)
+		{
+			// the file goes top to bottom, the image bottom to top.
+			DecodeScanline(data.data() + offsets[row], width, planes.data());
+			ConvertScanline(planes.data(), width, image.pixels.data() + (height - 1 - row) * (size_t)width * 4);
+		}
+	});
+	return true;
+}
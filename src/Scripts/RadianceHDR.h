@@ -0,0 +1,22 @@
+#ifndef RADIANCE_HDR_H
+#define RADIANCE_HDR_H
+
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+// RGBA half float image, rows bottom to top like stbi with flipping enabled. Alpha is 1.
+struct HalfImage
+{
+	int width = 0;
+	int height = 0;
+	std::vector<uint16_t> pixels;
+};
+
+// Decodes a Radiance .hdr file straight to half floats. The scanline offsets are found in one quick pass over the run lengths,
+// then the scanlines are decoded in parallel & converted 4 pixels at a time with SIMD when available.
+// Files this decoder doesn't handle (flipped orientations) fall back to stbi_loadf. Returns false if the file can't be read.
+bool LoadRadianceHDR(const char* path, HalfImage& image, ThreadPool& pool);
+
+#endif
@@ -3,146 +3,158 @@
 
 #include "../../vendor/glad/include/glad.h"
 
+#include "CpuProfiler.h"
+
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <memory>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+// KHR_parallel_shader_compile / ARB_parallel_shader_compile tokens (not part of the GL 3.3 glad header).
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+// ARB_texture_cube_map_array sampler types (not part of the GL 3.3 glad header).
+#ifndef GL_SAMPLER_CUBE_MAP_ARRAY
+#define GL_SAMPLER_CUBE_MAP_ARRAY 0x900C
+#endif
+#ifndef GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW
+#define GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW 0x900D
+#endif
+
 class Shader
 {
 public:
     unsigned int ID;
     // constructor generates the shader on the fly(VS, FS)
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
+    Shader(const char* vertexPath, const char* fragmentPath) : Shader(vertexPath, nullptr, fragmentPath)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure&)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << vertexPath << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
     }
     // constructor generates the shader on the fly(VS, GS, FS)
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* geometryPath, const char* fragmentPath)
+        : Shader(std::string(vertexPath), geometryPath ? std::string(geometryPath) : std::string(), std::string(fragmentPath), std::string())
     {
-        // 1. retrieve the vertex/geometry/fragment source code from filePath
-        std::string vertexCode;
-        std::string geometryCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream gShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
+    }
+    ~Shader()
+    {
+        std::vector<Shader*>& registry = Registry();
+        registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+        std::vector<Shader*>& batch = AsyncBatch();
+        batch.erase(std::remove(batch.begin(), batch.end(), this), batch.end());
+    }
+    // programs are registered by address for hot reloading, so they can't be copied around.
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // async compilation
+    // ------------------------------------------------------------------------
+    // Opens a batch: shaders constructed until WaitForAsyncCompile() only submit their sources and link request
+    // instead of blocking on every stage. A batched program is finished once the driver reports it done (see
+    // PollAsyncCompile()), or at its first use(), which waits for it. 'loader' is used to look up glMaxShaderCompilerThreadsKHR/ARB.
+    static void BeginAsyncCompile(GLADloadproc loader)
+    {
+        DetectParallelCompile(loader);
+        AsyncBatchOpen() = true;
+    }
+    // Non-blocking; checks and releases the programs of the batch whose GL_COMPLETION_STATUS_KHR is set and returns
+    // true once none are left. Without KHR_parallel_shader_compile there is no way to ask, so nothing is finished here.
+    static bool PollAsyncCompile()
+    {
+        if (ParallelCompileSupported())
         {
-            // open files
-            vShaderFile.open(vertexPath);
-            gShaderFile.open(geometryPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, gShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            gShaderStream << gShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            gShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            geometryCode = gShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            std::vector<Shader*> batch = AsyncBatch();
+            for (Shader* shader : batch)
+                if (shader->PendingComplete())
+                    shader->FinishBatched();
         }
-        catch (std::ifstream::failure&)
+        return AsyncBatch().empty();
+    }
+    // Closes the batch, waits for the programs that are left and checks them for compile/link errors.
+    static void WaitForAsyncCompile()
+    {
+        CpuProfiler::Scope profile("WaitForAsyncCompile");
+        std::vector<Shader*> batch = AsyncBatch();
+        for (Shader* shader : batch)
+            shader->FinishBatched();
+        AsyncBatchOpen() = false;
+    }
+
+    // variants
+    // ------------------------------------------------------------------------
+    // Names the compile time features of this shader; bit i of a variant mask adds "#define featureNames[i]".
+    void SetFeatures(const std::vector<std::string>& featureNames)
+    {
+        features = featureNames;
+    }
+    // Returns the program compiled with the features of 'featureMask', building it on first use.
+    // Mask 0 is this shader itself. Variants are hot reloaded like any other shader.
+    Shader& Variant(unsigned int featureMask)
+    {
+        if (featureMask == 0)
+            return *this;
+        std::map<unsigned int, std::unique_ptr<Shader>>::iterator variant = variants.find(featureMask);
+        if (variant != variants.end())
+            return *variant->second;
+
+        std::string variantDefines = defines;
+        for (size_t i = 0; i < features.size(); i++)
+            if (featureMask & (1u << i))
+                variantDefines += "#define " + features[i] + "\n";
+        Shader* shader = new Shader(vertexPath, geometryPath, fragmentPath, variantDefines);
+        variants[featureMask] = std::unique_ptr<Shader>(shader);
+        return *shader;
+    }
+
+    // hot reload
+    // ------------------------------------------------------------------------
+    // Recompiles the program from disk. The current program stays in use until the new one links successfully.
+    void Reload()
+    {
+        // a batched program is the one in use, it's finished like any other before the new one is submitted.
+        if (batched)
+            FinishBatched();
+        if (pending.program != 0)
+            DiscardPending();
+        Submit(pending);
+    }
+    // Queues a reload for every live shader that uses the given file (matched by file name).
+    static void ReloadShadersUsing(const std::string& fileName)
+    {
+        for (Shader* shader : Registry())
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << vertexPath << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* gShaderCode = geometryCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, geometry, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // geomtry shader
-        geometry = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(geometry, 1, &gShaderCode, NULL);
-        glCompileShader(geometry);
-        checkCompileErrors(geometry, "GEOMETRY");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, geometry);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(geometry);
-        glDeleteShader(fragment);
+            if (shader->Uses(fileName))
+            {
+                std::cout << "Reloading shader program: " << shader->vertexPath << (shader->geometryPath.empty() ? "" : " | " + shader->geometryPath) << " | " << shader->fragmentPath << std::endl;
+                shader->Reload();
+            }
+        }
+    }
+    // Call once per frame; swaps in reloaded programs whose compilation has finished.
+    static void UpdatePendingReloads()
+    {
+        for (Shader* shader : Registry())
+            if (shader->pending.program != 0 && shader->pending.program != shader->ID && shader->PendingComplete())
+                shader->FinishPending(false);
+    }
+    bool Uses(const std::string& fileName) const
+    {
+        return EndsWithFile(vertexPath, fileName) || EndsWithFile(geometryPath, fileName) || EndsWithFile(fragmentPath, fileName);
     }
     // activate the shader
     // ------------------------------------------------------------------------
     void use()
     {
+        if (batched)
+            FinishBatched();
         glUseProgram(ID);
     }
     // utility uniform functions
@@ -197,15 +209,302 @@ public:
         glUniform4f(glGetUniformLocation(ID, name.c_str()), value.x, value.y, value.z, value.w);
     }
     // ------------------------------------------------------------------------
+    void setMat3(const std::string& name, const glm::mat3& mat) const
+    {
+        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    }
+    // ------------------------------------------------------------------------
     void setMat4(const std::string& name, const glm::mat4& mat) const
     {
         glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    // a program whose compile/link has been submitted but whose status hasn't been checked yet.
+    struct PendingProgram
+    {
+        unsigned int program = 0;
+        unsigned int stages[3] = { 0, 0, 0 };
+    };
+
+    std::string vertexPath;
+    std::string geometryPath;
+    std::string fragmentPath;
+    PendingProgram pending;
+    // in the open async batch: 'pending' is the program in use and hasn't been checked yet.
+    bool batched = false;
+
+    // "#define"s inserted after the #version line of every stage.
+    std::string defines;
+    std::vector<std::string> features;
+    std::map<unsigned int, std::unique_ptr<Shader>> variants;
+
+    Shader(const std::string& vertexPath, const std::string& geometryPath, const std::string& fragmentPath, const std::string& defines)
+        : ID(0), vertexPath(vertexPath), geometryPath(geometryPath), fragmentPath(fragmentPath), defines(defines)
+    {
+        Registry().push_back(this);
+        // submit the compile/link work to the driver. Outside of an async batch the status is checked right away,
+        // inside one it is deferred until WaitForAsyncCompile() so the driver can work on all programs in parallel.
+        if (!Submit(pending))
+            return;
+        if (AsyncBatchOpen())
+        {
+            ID = pending.program;
+            batched = true;
+            AsyncBatch().push_back(this);
+        }
+        else
+        {
+            FinishPending(true);
+        }
+    }
+
+    // shared state, kept in function-local statics so the class can stay header only.
+    // ------------------------------------------------------------------------
+    static std::vector<Shader*>& Registry()
+    {
+        static std::vector<Shader*> registry;
+        return registry;
+    }
+    static std::vector<Shader*>& AsyncBatch()
+    {
+        static std::vector<Shader*> batch;
+        return batch;
+    }
+    static bool& AsyncBatchOpen()
+    {
+        static bool open = false;
+        return open;
+    }
+    static bool& ParallelCompileSupported()
+    {
+        static bool supported = false;
+        return supported;
+    }
+    static void DetectParallelCompile(GLADloadproc loader)
+    {
+        typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+        int extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (int i = 0; i < extensionCount; i++)
+        {
+            const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            bool khr = std::string(extension) == "GL_KHR_parallel_shader_compile";
+            bool arb = std::string(extension) == "GL_ARB_parallel_shader_compile";
+            if (!khr && !arb)
+                continue;
+            ParallelCompileSupported() = true;
+            // let the driver pick as many compiler threads as it likes.
+            PFNGLMAXSHADERCOMPILERTHREADSPROC maxThreads = (PFNGLMAXSHADERCOMPILERTHREADSPROC)loader(khr ? "glMaxShaderCompilerThreadsKHR" : "glMaxShaderCompilerThreadsARB");
+            if (maxThreads)
+                maxThreads(0xFFFFFFFF);
+            break;
+        }
+    }
+    static bool EndsWithFile(const std::string& path, const std::string& fileName)
+    {
+        if (path.empty() || fileName.empty() || path.size() < fileName.size())
+            return false;
+        if (path.compare(path.size() - fileName.size(), fileName.size(), fileName) != 0)
+            return false;
+        return path.size() == fileName.size() || path[path.size() - fileName.size() - 1] == '/' || path[path.size() - fileName.size() - 1] == '\\';
+    }
+    // utility function for reading a whole shader file.
+    // ------------------------------------------------------------------------
+    static bool ReadFile(const std::string& path, std::string& code)
+    {
+        std::ifstream file;
+        // ensure ifstream objects can throw exceptions:
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            code = stream.str();
+        }
+        catch (std::ifstream::failure&)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+    // inserts the variant defines right after the #version directive, keeping the line numbers of error messages.
+    void InjectDefines(std::string& code) const
+    {
+        size_t version = code.find("#version");
+        if (version == std::string::npos)
+            return;
+        size_t lineEnd = code.find('\n', version);
+        if (lineEnd == std::string::npos)
+            return;
+        size_t versionLine = std::count(code.begin(), code.begin() + lineEnd, '\n') + 1;
+        code.insert(lineEnd + 1, defines + "#line " + std::to_string(versionLine + 1) + "\n");
+    }
+    // reads the sources and issues compile + link without querying any status, so the calls don't stall.
+    // ------------------------------------------------------------------------
+    bool Submit(PendingProgram& target)
+    {
+        CpuProfiler::Scope profile("Shader Submit");
+        const std::string* paths[3] = { &vertexPath, &geometryPath, &fragmentPath };
+        const GLenum types[3] = { GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER };
+        std::string codes[3];
+        for (int i = 0; i < 3; i++)
+            if (!paths[i]->empty() && !ReadFile(*paths[i], codes[i]))
+                return false;
+        if (!defines.empty())
+            for (int i = 0; i < 3; i++)
+                InjectDefines(codes[i]);
+
+        target.program = glCreateProgram();
+        for (int i = 0; i < 3; i++)
+        {
+            if (paths[i]->empty())
+                continue;
+            const char* code = codes[i].c_str();
+            target.stages[i] = glCreateShader(types[i]);
+            glShaderSource(target.stages[i], 1, &code, NULL);
+            glCompileShader(target.stages[i]);
+            glAttachShader(target.program, target.stages[i]);
+        }
+        glLinkProgram(target.program);
+        return true;
+    }
+    bool PendingComplete() const
+    {
+        if (pending.program == 0 || !ParallelCompileSupported())
+            return true;
+        int complete = 0;
+        glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &complete);
+        return complete != 0;
+    }
+    // checks the pending program and, if it linked, makes it the active one. On a failed reload the previous
+    // program is kept; on initial creation the (broken) program is kept so the errors show up like before.
+    // ------------------------------------------------------------------------
+    void FinishPending(bool initial)
+    {
+        CpuProfiler::Scope profile("Shader Finish");
+        static const char* stageNames[3] = { "VERTEX", "GEOMETRY", "FRAGMENT" };
+        bool compiled = true;
+        for (int i = 0; i < 3; i++)
+            if (pending.stages[i] != 0)
+                compiled &= checkCompileErrors(pending.stages[i], stageNames[i]);
+        bool linked = compiled && checkCompileErrors(pending.program, "PROGRAM");
+
+        // delete the shaders as they're linked into our program now and no longer necessary
+        for (int i = 0; i < 3; i++)
+        {
+            if (pending.stages[i] != 0)
+                glDeleteShader(pending.stages[i]);
+            pending.stages[i] = 0;
+        }
+
+        if (initial)
+        {
+            ID = pending.program;
+        }
+        else if (linked)
+        {
+            TransferUniforms(ID, pending.program);
+            glDeleteProgram(ID);
+            ID = pending.program;
+        }
+        else
+        {
+            std::cout << "Shader reload failed, keeping the previous program." << std::endl;
+            glDeleteProgram(pending.program);
+        }
+        pending.program = 0;
+    }
+    // checks a program of the async batch and takes it out of the batch.
+    void FinishBatched()
+    {
+        FinishPending(true);
+        batched = false;
+        std::vector<Shader*>& batch = AsyncBatch();
+        batch.erase(std::remove(batch.begin(), batch.end(), this), batch.end());
+    }
+    void DiscardPending()
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            if (pending.stages[i] != 0)
+                glDeleteShader(pending.stages[i]);
+            pending.stages[i] = 0;
+        }
+        glDeleteProgram(pending.program);
+        pending.program = 0;
+    }
+    // copies the values of all default-block uniforms that exist in both programs, so a reloaded program
+    // keeps sampler units and settings that were only set once at startup.
+    // ------------------------------------------------------------------------
+    static void TransferUniforms(unsigned int from, unsigned int to)
+    {
+        int previousProgram = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+        glUseProgram(to);
+
+        int uniformCount = 0;
+        glGetProgramiv(from, GL_ACTIVE_UNIFORMS, &uniformCount);
+        for (int i = 0; i < uniformCount; i++)
+        {
+            char name[256];
+            int size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(from, i, sizeof(name), NULL, &size, &type, name);
+            // array uniforms are reported as "name[0]"; walk every element.
+            std::string baseName = name;
+            if (size > 1 && baseName.size() > 3 && baseName.compare(baseName.size() - 3, 3, "[0]") == 0)
+                baseName.resize(baseName.size() - 3);
+            for (int element = 0; element < size; element++)
+            {
+                std::string elementName = size > 1 ? baseName + "[" + std::to_string(element) + "]" : baseName;
+                int fromLocation = glGetUniformLocation(from, elementName.c_str());
+                int toLocation = glGetUniformLocation(to, elementName.c_str());
+                if (fromLocation < 0 || toLocation < 0)
+                    continue;
+                CopyUniform(from, fromLocation, toLocation, type);
+            }
+        }
+
+        glUseProgram(previousProgram == (int)from ? to : (unsigned int)previousProgram);
+    }
+    static void CopyUniform(unsigned int from, int fromLocation, int toLocation, GLenum type)
+    {
+        float f[16];
+        int i[4];
+        unsigned int u[4];
+        switch (type)
+        {
+        case GL_FLOAT:              glGetUniformfv(from, fromLocation, f); glUniform1fv(toLocation, 1, f); break;
+        case GL_FLOAT_VEC2:         glGetUniformfv(from, fromLocation, f); glUniform2fv(toLocation, 1, f); break;
+        case GL_FLOAT_VEC3:         glGetUniformfv(from, fromLocation, f); glUniform3fv(toLocation, 1, f); break;
+        case GL_FLOAT_VEC4:         glGetUniformfv(from, fromLocation, f); glUniform4fv(toLocation, 1, f); break;
+        case GL_FLOAT_MAT2:         glGetUniformfv(from, fromLocation, f); glUniformMatrix2fv(toLocation, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT3:         glGetUniformfv(from, fromLocation, f); glUniformMatrix3fv(toLocation, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT4:         glGetUniformfv(from, fromLocation, f); glUniformMatrix4fv(toLocation, 1, GL_FALSE, f); break;
+        case GL_UNSIGNED_INT:       glGetUniformuiv(from, fromLocation, u); glUniform1uiv(toLocation, 1, u); break;
+        case GL_UNSIGNED_INT_VEC2:  glGetUniformuiv(from, fromLocation, u); glUniform2uiv(toLocation, 1, u); break;
+        case GL_UNSIGNED_INT_VEC3:  glGetUniformuiv(from, fromLocation, u); glUniform3uiv(toLocation, 1, u); break;
+        case GL_UNSIGNED_INT_VEC4:  glGetUniformuiv(from, fromLocation, u); glUniform4uiv(toLocation, 1, u); break;
+        case GL_INT: case GL_BOOL:  glGetUniformiv(from, fromLocation, i); glUniform1iv(toLocation, 1, i); break;
+        case GL_INT_VEC2: case GL_BOOL_VEC2: glGetUniformiv(from, fromLocation, i); glUniform2iv(toLocation, 1, i); break;
+        case GL_INT_VEC3: case GL_BOOL_VEC3: glGetUniformiv(from, fromLocation, i); glUniform3iv(toLocation, 1, i); break;
+        case GL_INT_VEC4: case GL_BOOL_VEC4: glGetUniformiv(from, fromLocation, i); glUniform4iv(toLocation, 1, i); break;
+        case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_SAMPLER_CUBE_SHADOW: case GL_SAMPLER_CUBE_MAP_ARRAY: case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+            // the texture unit.
+            glGetUniformiv(from, fromLocation, i); glUniform1iv(toLocation, 1, i); break;
+        default:
+            // other types aren't used by the shaders, they keep the value the new program was linked with.
+            break;
+        }
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, std::string type)
+    bool checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
         char infoLog[1024];
@@ -227,6 +526,7 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,106 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// Watches a shader directory on a background thread and collects the names of files that were written.
+// The GL work (recompiling) happens on the render thread, see Shader::ReloadShadersUsing().
+// Only implemented with inotify; on other platforms it never reports any change.
+class ShaderWatcher
+{
+public:
+    // constructor starts watching the given directory
+    // ------------------------------------------------------------------------
+    ShaderWatcher(const std::string& directory) : running(false)
+    {
+#ifdef __linux__
+        inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFD < 0)
+        {
+            std::cout << "ShaderWatcher: inotify_init1 failed, shader hot reload is disabled." << std::endl;
+            return;
+        }
+        // editors either write in place or write a temporary file and rename it over the original.
+        if (inotify_add_watch(inotifyFD, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            std::cout << "ShaderWatcher: unable to watch " << directory << ", shader hot reload is disabled." << std::endl;
+            close(inotifyFD);
+            inotifyFD = -1;
+            return;
+        }
+        running = true;
+        worker = std::thread(&ShaderWatcher::Run, this);
+#else
+        (void)directory;
+#endif
+    }
+    ~ShaderWatcher()
+    {
+        running = false;
+        if (worker.joinable())
+            worker.join();
+#ifdef __linux__
+        if (inotifyFD >= 0)
+            close(inotifyFD);
+#endif
+    }
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // returns (and clears) the file names changed since the last call, each name at most once.
+    // ------------------------------------------------------------------------
+    std::vector<std::string> PollChanged()
+    {
+        std::lock_guard<std::mutex> lock(changedMutex);
+        std::vector<std::string> result(changed.begin(), changed.end());
+        changed.clear();
+        return result;
+    }
+
+private:
+    std::atomic<bool> running;
+    std::thread worker;
+    std::mutex changedMutex;
+    std::set<std::string> changed;
+#ifdef __linux__
+    int inotifyFD = -1;
+
+    void Run()
+    {
+        alignas(inotify_event) char buffer[4096];
+        while (running)
+        {
+            // wake up regularly so the destructor doesn't have to wait for a file event.
+            pollfd descriptor = { inotifyFD, POLLIN, 0 };
+            if (poll(&descriptor, 1, 100) <= 0)
+                continue;
+
+            ssize_t length = read(inotifyFD, buffer, sizeof(buffer));
+            if (length <= 0)
+                continue;
+
+            std::lock_guard<std::mutex> lock(changedMutex);
+            for (char* ptr = buffer; ptr < buffer + length; )
+            {
+                const inotify_event* event = (const inotify_event*)ptr;
+                if (event->len > 0)
+                    changed.insert(event->name);
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+#endif
+};
+#endif
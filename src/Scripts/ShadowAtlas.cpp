@@ -0,0 +1,151 @@
+#include "ShadowAtlas.h"
+
+#include "../../vendor/glad/include/glad.h"
+
+#include <algorithm>
+
+namespace
+{
+	// bytes of the 16-bit float filtered map.
+	const size_t FILTERED_BYTES_PER_TEXEL = 2;
+
+	// 24-bit depth is padded to 32 bits.
+	size_t DepthBytes(unsigned int depthFormat)
+	{
+		return depthFormat == GL_DEPTH_COMPONENT16 ? 2 : 4;
+	}
+
+	unsigned int CreateCubemapArray(unsigned int size, unsigned int cubemaps, GLenum internalFormat, GLenum format, GLenum filter)
+	{
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, texture);
+		glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, internalFormat, size, size, cubemaps * 6, 0, format, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		return texture;
+	}
+}
+
+ShadowAtlas::ShadowAtlas(const std::vector<unsigned int>& tierSizes, size_t budgetBytes, unsigned int depthFormat) : bytes(0), frame(0)
+{
+	// sampled & static depth plus the filtered map.
+	size_t texelBytes = DepthBytes(depthFormat) * 2 + FILTERED_BYTES_PER_TEXEL;
+
+	GLint maxLayers = 2048;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	size_t remaining = budgetBytes;
+	for (size_t i = 0; i < tierSizes.size(); i++)
+	{
+		size_t slotBytes = (size_t)tierSizes[i] * tierSizes[i] * 6 * texelBytes;
+		size_t share = i + 1 == tierSizes.size() ? remaining : remaining / 2;
+		size_t count = std::min(std::max(share / slotBytes, (size_t)1), (size_t)maxLayers / 6);
+		remaining -= std::min(remaining, count * slotBytes);
+		bytes += count * slotBytes;
+
+		Tier tier;
+		tier.size = tierSizes[i];
+		tier.slots.resize(count);
+		tier.texture = CreateCubemapArray(tier.size, (unsigned int)count, depthFormat, GL_DEPTH_COMPONENT, GL_LINEAR);
+		// hardware PCF: each fetch compares the 4 nearest texels & filters the results.
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		tier.staticTexture = CreateCubemapArray(tier.size, (unsigned int)count, depthFormat, GL_DEPTH_COMPONENT, GL_NEAREST);
+		tier.filteredTexture = CreateCubemapArray(tier.size, (unsigned int)count, GL_R16F, GL_RED, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+		tiers.push_back(tier);
+	}
+
+	glGenSamplers(1, &depthSampler);
+	glSamplerParameteri(depthSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glSamplerParameteri(depthSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glSamplerParameteri(depthSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glSamplerParameteri(depthSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glSamplerParameteri(depthSampler, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glSamplerParameteri(depthSampler, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+}
+
+ShadowAtlas::~ShadowAtlas()
+{
+	for (const Tier& tier : tiers)
+	{
+		const unsigned int textures[] = { tier.texture, tier.staticTexture, tier.filteredTexture };
+		glDeleteTextures(3, textures);
+	}
+	glDeleteSamplers(1, &depthSampler);
+}
+
+unsigned int ShadowAtlas::TierSlotsInUse(unsigned int tier) const
+{
+	unsigned int used = 0;
+	for (const Slot& slot : tiers[tier].slots)
+		used += slot.owner >= 0 && slot.lastUsed == frame;
+	return used;
+}
+
+unsigned int ShadowAtlas::TierFor(float texels) const
+{
+	for (unsigned int tier = TierCount(); tier-- > 0;)
+		if ((float)tiers[tier].size >= texels)
+			return tier;
+	return 0;
+}
+
+bool ShadowAtlas::Acquire(int owner, unsigned int tier, uint64_t frame, unsigned int& slotTier, unsigned int& slot, bool& fresh)
+{
+	this->frame = frame;
+	for (unsigned int t = tier; t < TierCount(); t++)
+	{
+		std::vector<Slot>& slots = tiers[t].slots;
+
+		// keep the slot the owner has in this tier, else take the least recently used one not used in this frame (free slots
+		// have lastUsed 0 so they go first).
+		int found = -1;
+		for (size_t i = 0; i < slots.size(); i++)
+		{
+			if (slots[i].owner == owner)
+			{
+				found = (int)i;
+				break;
+			}
+			if (slots[i].lastUsed < frame && (found < 0 || slots[i].lastUsed < slots[found].lastUsed))
+				found = (int)i;
+		}
+		if (found < 0)
+			continue;
+
+		fresh = slots[found].owner != owner;
+		if (fresh)
+		{
+			// the owner's slot in another tier is given up.
+			Release(owner);
+			slots[found].owner = owner;
+		}
+		slots[found].lastUsed = frame;
+		slotTier = t;
+		slot = (unsigned int)found;
+		return true;
+	}
+	return false;
+}
+
+bool ShadowAtlas::Owns(int owner, unsigned int tier, unsigned int slot) const
+{
+	return tier < TierCount() && slot < tiers[tier].slots.size() && tiers[tier].slots[slot].owner == owner;
+}
+
+void ShadowAtlas::Release(int owner)
+{
+	for (Tier& tier : tiers)
+	{
+		for (Slot& slot : tier.slots)
+		{
+			if (slot.owner == owner)
+				slot = Slot();
+		}
+	}
+}
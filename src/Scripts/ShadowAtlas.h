@@ -0,0 +1,79 @@
+#ifndef SHADOW_ATLAS_H
+#define SHADOW_ATLAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ARB_texture_cube_map_array token (not part of the GL 3.3 glad header).
+#ifndef GL_TEXTURE_CUBE_MAP_ARRAY
+#define GL_TEXTURE_CUBE_MAP_ARRAY 0x9009
+#endif
+
+// Point light shadow cubemaps of a few fixed resolutions (tiers), each tier a pair of depth cubemap arrays: the maps the lighting
+// samples and the cached static caster layer of the same slots, plus a filtered cubemap array for exponential shadow maps.
+// Slot counts come from a memory budget, half of it goes to the largest tier, half of the rest to the next & so on, the
+// smallest tier takes what's left. Slots are handed to lights per frame, a full tier evicts its least recently used slot that
+// wasn't used in the current frame.
+class ShadowAtlas
+{
+public:
+	// 'tierSizes' from largest to smallest. 'depthFormat' is GL_DEPTH_COMPONENT16, 24 or 32F, 16 bits halve the depth memory
+	// but leave little precision far from the light since the stored depth isn't linear.
+	ShadowAtlas(const std::vector<unsigned int>& tierSizes, size_t budgetBytes, unsigned int depthFormat);
+	~ShadowAtlas();
+	ShadowAtlas(const ShadowAtlas&) = delete;
+	ShadowAtlas& operator=(const ShadowAtlas&) = delete;
+
+	unsigned int TierCount() const { return (unsigned int)tiers.size(); }
+	unsigned int TierSize(unsigned int tier) const { return tiers[tier].size; }
+	unsigned int TierSlots(unsigned int tier) const { return (unsigned int)tiers[tier].slots.size(); }
+	// GL_TEXTURE_CUBE_MAP_ARRAY textures of a tier, slot s is cubemap s (layers 6s to 6s + 5).
+	// 'Texture' is set up for depth comparison with linear filtering (samplerCubeArrayShadow), read it through DepthSampler()
+	// for the stored depth.
+	unsigned int Texture(unsigned int tier) const { return tiers[tier].texture; }
+	unsigned int StaticTexture(unsigned int tier) const { return tiers[tier].staticTexture; }
+	// GL_R16F, depth filtered in exponential space (see PointShadowCache::SetFiltered), linear filtering.
+	unsigned int FilteredTexture(unsigned int tier) const { return tiers[tier].filteredTexture; }
+	// Sampler object reading the depth of 'Texture' without the comparison.
+	unsigned int DepthSampler() const { return depthSampler; }
+	// Memory of all tiers & layers.
+	size_t Bytes() const { return bytes; }
+	// Slots of a tier used in the last frame passed to Acquire.
+	unsigned int TierSlotsInUse(unsigned int tier) const;
+
+	// Smallest tier whose faces have at least 'texels' texels across (the largest tier if none).
+	unsigned int TierFor(float texels) const;
+
+	// Makes sure 'owner' has a slot in 'tier', or failing that in the next smaller tier with room, and marks it used in 'frame'.
+	// Keeps the owner's slot if it's already in that tier. 'fresh' is set when the slot is new, its contents have to be rendered.
+	// Returns false if every slot of those tiers was used in this frame. Frames start at 1.
+	bool Acquire(int owner, unsigned int tier, uint64_t frame, unsigned int& slotTier, unsigned int& slot, bool& fresh);
+	// True if 'owner' still holds the slot (it wasn't evicted).
+	bool Owns(int owner, unsigned int tier, unsigned int slot) const;
+	// Frees every slot of 'owner'.
+	void Release(int owner);
+
+private:
+	struct Slot
+	{
+		int owner = -1;		// -1 if free.
+		uint64_t lastUsed = 0;
+	};
+
+	struct Tier
+	{
+		unsigned int size;
+		std::vector<Slot> slots;
+		unsigned int texture;
+		unsigned int staticTexture;
+		unsigned int filteredTexture;
+	};
+
+	std::vector<Tier> tiers;
+	unsigned int depthSampler;
+	size_t bytes;
+	uint64_t frame;
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include "SphericalHarmonics.h"
+#include "HalfFloat.h"
+
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SH_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	const float PI = 3.14159265359f;
+
+	// Real SH basis constants of bands 0-2.
+	const float SH_C0 = 0.282095f;
+	const float SH_C1 = 0.488603f;
+	const float SH_C2 = 1.092548f;
+	const float SH_C3 = 0.315392f;
+	const float SH_C4 = 0.546274f;
+
+	// Adds the weighted basis of direction (x, y, z) times color to the 27 accumulators.
+	inline void AccumulateScalar(float x, float y, float z, const float* color, float weight, float accumulator[9][3])
+	{
+		const float basis[9] =
+		{
+			SH_C0,
+			SH_C1 * y, SH_C1 * z, SH_C1 * x,
+			SH_C2 * x * y, SH_C2 * y * z, SH_C3 * (3.0f * z * z - 1.0f), SH_C2 * x * z, SH_C4 * (x * x - y * y)
+		};
+		for (int i = 0; i < 9; i++)
+			for (int c = 0; c < 3; c++)
+				accumulator[i][c] += basis[i] * color[c] * weight;
+	}
+
+	// Pixels of a row as floats, half float rows are widened into 'scratch'.
+	inline const float* RowPixels(const float* pixels, size_t row, int width, int channels, std::vector<float>&)
+	{
+		return pixels + row * width * channels;
+	}
+	inline const float* RowPixels(const uint16_t* pixels, size_t row, int width, int channels, std::vector<float>& scratch)
+	{
+		const uint16_t* rowPixels = pixels + row * width * channels;
+		scratch.resize((size_t)width * channels);
+		for (size_t i = 0; i < scratch.size(); i++)
+			scratch[i] = HalfToFloat(rowPixels[i]);
+		return scratch.data();
+	}
+
+	// Projects rows [beginRow, endRow) into 'result'.
+	template <typename Pixel>
+	void ProjectRows(const Pixel* pixels, int width, int height, int channels, const std::vector<float>& cosPhi, const std::vector<float>& sinPhi,
+		size_t beginRow, size_t endRow, float result[9][3])
+	{
+		const float pixelSolidAngle = (2.0f * PI / width) * (PI / height);
+		std::vector<float> scratch;
+
+		for (size_t row = beginRow; row < endRow; row++)
+		{
+			// latitude of the row, row 0 is the bottom (v = 0 -> y = -1).
+			float latitude = ((row + 0.5f) / height - 0.5f) * PI;
+			float y = std::sin(latitude);
+			float cosLatitude = std::cos(latitude);
+			float weight = pixelSolidAngle * cosLatitude;
+			const float* rowPixels = RowPixels(pixels, row, width, channels, scratch);
+
+			float rowSum[9][3] = {};
+			int column = 0;
+#ifdef SH_USE_SSE
+			// 4 pixels per iteration, one SSE lane each; the lanes are summed at the end of the row.
+			__m128 sum[9][3];
+			for (int i = 0; i < 9; i++)
+				for (int c = 0; c < 3; c++)
+					sum[i][c] = _mm_setzero_ps();
+
+			const __m128 vy = _mm_set1_ps(y);
+			const __m128 vCosLatitude = _mm_set1_ps(cosLatitude);
+			const __m128 c1y = _mm_set1_ps(SH_C1 * y);
+			const __m128 c1 = _mm_set1_ps(SH_C1);
+			const __m128 c2 = _mm_set1_ps(SH_C2);
+			const __m128 c3 = _mm_set1_ps(SH_C3);
+			const __m128 c4 = _mm_set1_ps(SH_C4);
+			const __m128 three = _mm_set1_ps(3.0f);
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 yy = _mm_mul_ps(vy, vy);
+
+			for (; column + 4 <= width; column += 4)
+			{
+				__m128 x = _mm_mul_ps(_mm_loadu_ps(&cosPhi[column]), vCosLatitude);
+				__m128 z = _mm_mul_ps(_mm_loadu_ps(&sinPhi[column]), vCosLatitude);
+
+				const float* p = rowPixels + (size_t)column * channels;
+				__m128 color[3] =
+				{
+					_mm_setr_ps(p[0], p[channels], p[2 * channels], p[3 * channels]),
+					_mm_setr_ps(p[1], p[channels + 1], p[2 * channels + 1], p[3 * channels + 1]),
+					_mm_setr_ps(p[2], p[channels + 2], p[2 * channels + 2], p[3 * channels + 2])
+				};
+
+				__m128 basis[9];
+				basis[1] = c1y;
+				basis[2] = _mm_mul_ps(c1, z);
+				basis[3] = _mm_mul_ps(c1, x);
+				basis[4] = _mm_mul_ps(c2, _mm_mul_ps(x, vy));
+				basis[5] = _mm_mul_ps(c2, _mm_mul_ps(vy, z));
+				basis[6] = _mm_mul_ps(c3, _mm_sub_ps(_mm_mul_ps(three, _mm_mul_ps(z, z)), one));
+				basis[7] = _mm_mul_ps(c2, _mm_mul_ps(x, z));
+				basis[8] = _mm_mul_ps(c4, _mm_sub_ps(_mm_mul_ps(x, x), yy));
+
+				// band 0 is constant, it's scaled once at the end of the row.
+				for (int c = 0; c < 3; c++)
+					sum[0][c] = _mm_add_ps(sum[0][c], color[c]);
+				for (int i = 1; i < 9; i++)
+					for (int c = 0; c < 3; c++)
+						sum[i][c] = _mm_add_ps(sum[i][c], _mm_mul_ps(basis[i], color[c]));
+			}
+
+			for (int i = 0; i < 9; i++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					float lanes[4];
+					_mm_storeu_ps(lanes, sum[i][c]);
+					rowSum[i][c] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+				}
+			}
+			for (int c = 0; c < 3; c++)
+				rowSum[0][c] *= SH_C0;
+#endif
+			// remaining pixels (or all of them without SSE).
+			for (; column < width; column++)
+			{
+				float x = cosPhi[column] * cosLatitude;
+				float z = sinPhi[column] * cosLatitude;
+				AccumulateScalar(x, y, z, rowPixels + (size_t)column * channels, 1.0f, rowSum);
+			}
+
+			for (int i = 0; i < 9; i++)
+				for (int c = 0; c < 3; c++)
+					result[i][c] += rowSum[i][c] * weight;
+		}
+	}
+
+	template <typename Pixel>
+	SH9 ProjectPixels(const Pixel* pixels, int width, int height, int channels, ThreadPool& pool)
+	{
+		SH9 sh;
+		if (!pixels || width <= 0 || height <= 0 || channels < 3)
+			return sh;
+
+		// longitude only depends on the column: phi = atan(z, x) = (u - 0.5) * 2PI.
+		std::vector<float> cosPhi(width), sinPhi(width);
+		for (int column = 0; column < width; column++)
+		{
+			float phi = ((column + 0.5f) / width - 0.5f) * 2.0f * PI;
+			cosPhi[column] = std::cos(phi);
+			sinPhi[column] = std::sin(phi);
+		}
+
+		// one partial sum per chunk, reduced in chunk order so the result doesn't depend on thread timing.
+		const size_t rowsPerChunk = 16;
+		size_t chunks = (height + rowsPerChunk - 1) / rowsPerChunk;
+		std::vector<SH9> partials(chunks);
+		pool.ParallelFor(height, rowsPerChunk, [&](size_t begin, size_t end)
+		{
+			ProjectRows(pixels, width, height, channels, cosPhi, sinPhi, begin, end, partials[begin / rowsPerChunk].coefficients);
+		});
+
+		for (const SH9& partial : partials)
+			for (int i = 0; i < 9; i++)
+				for (int c = 0; c < 3; c++)
+					sh.coefficients[i][c] += partial.coefficients[i][c];
+		return sh;
+	}
+}
+
+SH9 ProjectEquirectangularSH9(const float* pixels, int width, int height, int channels, ThreadPool& pool)
+{
+	return ProjectPixels(pixels, width, height, channels, pool);
+}
+
+SH9 ProjectEquirectangularSH9(const uint16_t* pixels, int width, int height, int channels, ThreadPool& pool)
+{
+	return ProjectPixels(pixels, width, height, channels, pool);
+}
+
+void SH9ToIrradianceUniforms(const SH9& radiance, float out[9][4])
+{
+	// Convolution with the clamped cosine lobe (Ramamoorthi & Hanrahan): A0 = PI, A1 = 2PI/3, A2 = PI/4.
+	// Divided by PI to match the irradiance map, which stores E / PI.
+	const float band[9] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+	const float basis[9] = { SH_C0, SH_C1, SH_C1, SH_C1, SH_C2, SH_C2, SH_C3, SH_C2, SH_C4 };
+	for (int i = 0; i < 9; i++)
+	{
+		for (int c = 0; c < 3; c++)
+			out[i][c] = radiance.coefficients[i][c] * band[i] * basis[i];
+		out[i][3] = 0.0f;
+	}
+}
+
+SH9 LerpSH9(const SH9& a, const SH9& b, float t)
+{
+	SH9 result;
+	for (int i = 0; i < 9; i++)
+		for (int c = 0; c < 3; c++)
+			result.coefficients[i][c] = a.coefficients[i][c] + (b.coefficients[i][c] - a.coefficients[i][c]) * t;
+	return result;
+}
@@ -0,0 +1,30 @@
+#ifndef SPHERICAL_HARMONICS_H
+#define SPHERICAL_HARMONICS_H
+
+#include "ThreadPool.h"
+
+#include <cstdint>
+
+// 9 RGB coefficients of an order 2 (3 band) spherical harmonics expansion.
+// Basis order: Y00, Y1-1 (y), Y10 (z), Y11 (x), Y2-2 (xy), Y2-1 (yz), Y20 (3z²-1), Y21 (xz), Y22 (x²-y²).
+struct SH9
+{
+	float coefficients[9][3] = {};
+};
+
+// Projects an equirectangular radiance map (rows bottom to top, as loaded with stbi flipping enabled; same mapping as
+// equirectangular_to_cubemap.fs) onto the SH basis. 'channels' is the float stride per pixel, the first 3 are used as RGB.
+// Rows are split across the thread pool and each row is processed 4 pixels at a time with SSE when available.
+SH9 ProjectEquirectangularSH9(const float* pixels, int width, int height, int channels, ThreadPool& pool);
+// Same for half float pixels, each row is widened to floats before it's projected.
+SH9 ProjectEquirectangularSH9(const uint16_t* pixels, int width, int height, int channels, ThreadPool& pool);
+
+// Turns radiance coefficients into the coefficients of the diffuse irradiance divided by PI (the same quantity the irradiance
+// cubemap stores), premultiplied with the basis constants so the shader only evaluates polynomials of the normal.
+// Written as 9 vec4s, ready for a std140 uniform block.
+void SH9ToIrradianceUniforms(const SH9& radiance, float out[9][4]);
+
+// Linear blend of two expansions, the expansion of the blended environments.
+SH9 LerpSH9(const SH9& a, const SH9& b, float t);
+
+#endif
@@ -0,0 +1,86 @@
+#include "TemporalAA.h"
+
+TemporalAA::TemporalAA(unsigned int width, unsigned int height, void (*renderQuad)())
+	: renderQuad(renderQuad),
+	resolveShader(PROJECT_DIR"/src/Shaders/blur.vs", PROJECT_DIR"/src/Shaders/taa.fs"),
+	width(width), height(height), current(0), historyValid(false)
+{
+	glGenFramebuffers(1, &framebuffer);
+	CreateTargets();
+}
+
+TemporalAA::~TemporalAA()
+{
+	DeleteTargets();
+	glDeleteFramebuffers(1, &framebuffer);
+}
+
+void TemporalAA::Resize(unsigned int width, unsigned int height)
+{
+	if (width == this->width && height == this->height)
+		return;
+	this->width = width;
+	this->height = height;
+	DeleteTargets();
+	CreateTargets();
+}
+
+void TemporalAA::Reset()
+{
+	historyValid = false;
+}
+
+void TemporalAA::CreateTargets()
+{
+	glGenTextures(2, history);
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		glBindTexture(GL_TEXTURE_2D, history[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+		// the reprojected history is read between texels.
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	historyValid = false;
+}
+
+void TemporalAA::DeleteTargets()
+{
+	glDeleteTextures(2, history);
+}
+
+void TemporalAA::Render(unsigned int colorTexture, unsigned int depthTexture, const glm::mat4& viewProjection, const glm::mat4& previousViewProjection,
+	float feedback)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	unsigned int previous = current;
+	current = 1 - current;
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, history[current], 0);
+	glViewport(0, 0, width, height);
+
+	resolveShader.use();
+	resolveShader.setInt("currentColor", 0);
+	resolveShader.setInt("currentDepth", 1);
+	resolveShader.setInt("history", 2);
+	// from this frame's clip space to the last one's, both without jitter so a still camera reprojects onto the same pixels.
+	resolveShader.setMat4("reprojection", previousViewProjection * glm::inverse(viewProjection));
+	// the first frame after a reset is taken as is.
+	resolveShader.setFloat("feedback", historyValid ? feedback : 0.0f);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, colorTexture);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, depthTexture);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, history[previous]);
+	renderQuad();
+	historyValid = true;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
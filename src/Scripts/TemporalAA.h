@@ -0,0 +1,55 @@
+#ifndef TEMPORAL_AA_H
+#define TEMPORAL_AA_H
+
+#include "../../vendor/glm/glm.hpp"
+
+#include "Shader.h"
+
+// Temporal anti-aliasing. The scene is rendered with a sub-pixel projection jitter that changes every frame (Camera::SetJitter)
+// & each frame is blended into a history of the ones before, so the history converges on the average over the jitter pattern.
+// The history is reprojected from the depth of each pixel & the view projections of this & the last frame, which covers camera
+// motion, & clamped to the color distribution of the pixel's 3x3 neighbourhood, so what the history shows that the current frame
+// doesn't (disocclusions, moving objects, changed lighting) is rejected instead of ghosting. Per pixel sampling rotated every
+// frame (soft shadows, SSAO) converges the same way.
+class TemporalAA
+{
+public:
+	// 'width' & 'height' of the HDR image.
+	TemporalAA(unsigned int width, unsigned int height, void (*renderQuad)());
+	~TemporalAA();
+	TemporalAA(const TemporalAA&) = delete;
+	TemporalAA& operator=(const TemporalAA&) = delete;
+
+	// Resizing drops the history.
+	void Resize(unsigned int width, unsigned int height);
+	// Drops the history, the next Render starts over from its frame, e.g. when TAA is turned back on.
+	void Reset();
+
+	// Blends 'colorTexture' (HDR, rendered with the jittered projection) into the history. 'depthTexture' is the hardware depth it
+	// was rendered with, 'viewProjection' & 'previousViewProjection' the unjittered matrices of this & the last frame. 'feedback' is
+	// the weight of the history, higher converges further but takes longer. Restores the viewport, binds framebuffer 0.
+	void Render(unsigned int colorTexture, unsigned int depthTexture, const glm::mat4& viewProjection, const glm::mat4& previousViewProjection,
+		float feedback);
+
+	// GL_RGBA16F, the HDR image of the last Render.
+	unsigned int Texture() const { return history[current]; }
+
+private:
+	void (*renderQuad)();
+
+	Shader resolveShader;
+
+	unsigned int width;
+	unsigned int height;
+
+	// the history is read from one texture & written to the other, current is the last one written.
+	unsigned int history[2];
+	unsigned int current;
+	bool historyValid;
+	unsigned int framebuffer;
+
+	void CreateTargets();
+	void DeleteTargets();
+};
+
+#endif
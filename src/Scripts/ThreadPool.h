@@ -0,0 +1,140 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for CPU side work (SH projection, image decoding, ...).
+class ThreadPool
+{
+public:
+    // constructor starts 'threadCount' workers, by default one less than the number of hardware threads
+    // since the thread calling ParallelFor() does its share of the work too.
+    // ------------------------------------------------------------------------
+    ThreadPool(unsigned int threadCount = DefaultThreadCount()) : stopping(false)
+    {
+        for (unsigned int i = 0; i < threadCount; i++)
+            workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCondition.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int ThreadCount() const
+    {
+        return (unsigned int)workers.size();
+    }
+
+    // queues a task for the workers.
+    // ------------------------------------------------------------------------
+    std::future<void> Submit(std::function<void()> task)
+    {
+        std::shared_ptr<std::packaged_task<void()>> packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+        std::future<void> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            tasks.push([packaged]() { (*packaged)(); });
+        }
+        queueCondition.notify_one();
+        return result;
+    }
+
+    // runs job(begin, end) over [0, count) in chunks of 'grain' items on the workers and the calling thread.
+    // returns once every chunk is done. The calling thread keeps taking chunks, so this never waits on busy workers.
+    // ------------------------------------------------------------------------
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& job)
+    {
+        if (count == 0)
+            return;
+        grain = grain == 0 ? 1 : grain;
+
+        std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+        state->count = count;
+        state->grain = grain;
+        state->chunks = (count + grain - 1) / grain;
+        state->job = job;
+
+        size_t helpers = std::min<size_t>(workers.size(), state->chunks - 1);
+        for (size_t i = 0; i < helpers; i++)
+            Submit([state]() { RunChunks(*state); });
+
+        RunChunks(*state);
+        std::unique_lock<std::mutex> lock(state->doneMutex);
+        state->doneCondition.wait(lock, [&state]() { return state->done == state->chunks; });
+    }
+
+private:
+    struct ParallelForState
+    {
+        size_t count = 0;
+        size_t grain = 1;
+        size_t chunks = 0;
+        std::function<void(size_t, size_t)> job;
+        std::atomic<size_t> next{ 0 };
+        size_t done = 0;
+        std::mutex doneMutex;
+        std::condition_variable doneCondition;
+    };
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool stopping;
+
+    static unsigned int DefaultThreadCount()
+    {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+    static void RunChunks(ParallelForState& state)
+    {
+        size_t finished = 0;
+        for (size_t chunk = state.next++; chunk < state.chunks; chunk = state.next++)
+        {
+            size_t begin = chunk * state.grain;
+            state.job(begin, std::min(begin + state.grain, state.count));
+            finished++;
+        }
+        if (finished == 0)
+            return;
+        std::lock_guard<std::mutex> lock(state.doneMutex);
+        state.done += finished;
+        if (state.done == state.chunks)
+            state.doneCondition.notify_all();
+    }
+    void WorkerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+};
+#endif
@@ -0,0 +1,176 @@
+#include "ToneMapping.h"
+
+#include "../../vendor/glad/include/glad.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	// 48 texels over the 20 stops keep every operator within ~1/255 of the analytic curve.
+	const int LUT_SIZE = 48;
+	// 2^-12 maps to (nearly) black under every operator, past 2^8 all of them but None & Exposure have saturated.
+	const float MIN_LOG2 = -12.0f;
+	const float MAX_LOG2 = 8.0f;
+
+	glm::vec3 FilmicCurve(const glm::vec3& x)
+	{
+		glm::vec3 X = glm::max(glm::vec3(0.0f), x - 0.004f);
+		glm::vec3 result = (X * (6.2f * X + 0.5f)) / (X * (6.2f * X + 1.7f) + 0.06f);
+		return glm::pow(result, glm::vec3(2.2f));
+	}
+
+	// Narkowicz 2015, "ACES Filmic Tone Mapping Curve".
+	glm::vec3 AcesCurve(const glm::vec3& x)
+	{
+		const float a = 2.51f;
+		const float b = 0.03f;
+		const float c = 2.43f;
+		const float d = 0.59f;
+		const float e = 0.14f;
+		return glm::clamp((x * (a * x + b)) / (x * (c * x + d) + e), 0.0f, 1.0f);
+	}
+
+	// Lottes 2016, "Advanced Techniques and Optimization of HDR Color Pipelines".
+	glm::vec3 LottesCurve(const glm::vec3& x)
+	{
+		const float a = 1.6f;
+		const float d = 0.977f;
+		const float hdrMax = 8.0f;
+		const float midIn = 0.18f;
+		const float midOut = 0.267f;
+
+		const float b = (-std::pow(midIn, a) + std::pow(hdrMax, a) * midOut) /
+			((std::pow(hdrMax, a * d) - std::pow(midIn, a * d)) * midOut);
+		const float c = (std::pow(hdrMax, a * d) * std::pow(midIn, a) - std::pow(hdrMax, a) * std::pow(midIn, a * d) * midOut) /
+			((std::pow(hdrMax, a * d) - std::pow(midIn, a * d)) * midOut);
+
+		return glm::pow(x, glm::vec3(a)) / (glm::pow(x, glm::vec3(a * d)) * b + c);
+	}
+
+	// Uchimura 2017, "HDR theory and practice".
+	glm::vec3 UchimuraCurve(const glm::vec3& x)
+	{
+		const float P = 1.0f;	// max display brightness
+		const float a = 1.0f;	// contrast
+		const float m = 0.22f;	// linear section start
+		const float l = 0.4f;	// linear section length
+		const float c = 1.33f;	// black
+		const float b = 0.0f;	// pedestal
+
+		float l0 = ((P - m) * l) / a;
+		float S0 = m + l0;
+		float S1 = m + a * l0;
+		float C2 = (a * P) / (P - S1);
+		float CP = -C2 / P;
+
+		glm::vec3 w0 = 1.0f - glm::smoothstep(glm::vec3(0.0f), glm::vec3(m), x);
+		glm::vec3 w2 = glm::step(glm::vec3(m + l0), x);
+		glm::vec3 w1 = 1.0f - w0 - w2;
+
+		glm::vec3 T = m * glm::pow(x / m, glm::vec3(c)) + b;
+		glm::vec3 S = P - (P - S1) * glm::exp(CP * (x - S0));
+		glm::vec3 L = m + a * (x - m);
+
+		return T * w0 + L * w1 + S * w2;
+	}
+
+	glm::vec3 Uncharted2Partial(const glm::vec3& x)
+	{
+		const float A = 0.15f;
+		const float B = 0.50f;
+		const float C = 0.10f;
+		const float D = 0.20f;
+		const float E = 0.02f;
+		const float F = 0.30f;
+		return ((x * (A * x + C * B) + D * E) / (x * (A * x + B) + D * F)) - E / F;
+	}
+
+	glm::vec3 Uncharted2Curve(const glm::vec3& color)
+	{
+		const float W = 11.2f;
+		const float exposureBias = 2.0f;
+		return Uncharted2Partial(exposureBias * color) / Uncharted2Partial(glm::vec3(W));
+	}
+}
+
+ToneMappingLUT::ToneMappingLUT() : toneMapping(-1), exposure(0.0f)
+{
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_3D, texture);
+	glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB16F, LUT_SIZE, LUT_SIZE, LUT_SIZE, 0, GL_RGB, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+ToneMappingLUT::~ToneMappingLUT()
+{
+	glDeleteTextures(1, &texture);
+}
+
+glm::vec2 ToneMappingLUT::LogRange() const
+{
+	return glm::vec2(MIN_LOG2, MAX_LOG2);
+}
+
+glm::vec3 ToneMappingLUT::Apply(unsigned int toneMapping, float exposure, const glm::vec3& color)
+{
+	switch (toneMapping)
+	{
+	case Exposure:
+		return 1.0f - glm::exp(-color * exposure);
+	case Reinhard:
+		return color / (1.0f + color);
+	case Reinhard2:
+	{
+		const float whiteSquared = 4.0f * 4.0f;
+		return (color * (1.0f + color / whiteSquared)) / (1.0f + color);
+	}
+	case Filmic:
+		return FilmicCurve(color);
+	case ACES:
+		return AcesCurve(color);
+	case Lottes:
+		return LottesCurve(color);
+	case Uchimura:
+		return UchimuraCurve(color);
+	case Uncharted2:
+		return Uncharted2Curve(color);
+	case Unreal:
+		// Unreal 3, "Color Grading": close to ACES with gamma 2.2 baked in.
+		return color / (color + 0.155f) * 1.019f;
+	default:
+		return color;
+	}
+}
+
+bool ToneMappingLUT::Update(unsigned int toneMapping, float exposure)
+{
+	// exposure only changes the Exposure operator.
+	if ((int)toneMapping == this->toneMapping && (toneMapping != Exposure || exposure == this->exposure))
+		return false;
+	this->toneMapping = (int)toneMapping;
+	this->exposure = exposure;
+
+	// every operator maps each channel on its own, so it's evaluated once per texel along an axis & the table is put together
+	// from those.
+	glm::vec3 axis[LUT_SIZE];
+	for (int i = 0; i < LUT_SIZE; i++)
+		axis[i] = Apply(toneMapping, exposure, glm::vec3(std::exp2(MIN_LOG2 + (MAX_LOG2 - MIN_LOG2) * (float)i / (float)(LUT_SIZE - 1))));
+
+	std::vector<glm::vec3> texels(LUT_SIZE * LUT_SIZE * LUT_SIZE);
+	size_t index = 0;
+	for (int b = 0; b < LUT_SIZE; b++)
+		for (int g = 0; g < LUT_SIZE; g++)
+			for (int r = 0; r < LUT_SIZE; r++)
+				texels[index++] = glm::vec3(axis[r].r, axis[g].g, axis[b].b);
+
+	glBindTexture(GL_TEXTURE_3D, texture);
+	glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, LUT_SIZE, LUT_SIZE, LUT_SIZE, GL_RGB, GL_FLOAT, texels.data());
+	glBindTexture(GL_TEXTURE_3D, 0);
+	return true;
+}
@@ -0,0 +1,51 @@
+#ifndef TONE_MAPPING_H
+#define TONE_MAPPING_H
+
+#include "../../vendor/glm/glm.hpp"
+
+// The selected tone mapping operator baked into a 3D lookup table, so the post processing shader maps a color with a single
+// trilinear fetch instead of branching over the operators. The table is indexed by the log2 of each channel over LogRange(),
+// which spreads its texels evenly over the stops of the HDR input. It's only baked again when the operator or exposure change.
+class ToneMappingLUT
+{
+public:
+	// Operators in the order of the settings' tone mapping combo.
+	enum Operator
+	{
+		Exposure,
+		Reinhard,
+		Reinhard2,
+		Filmic,
+		ACES,
+		Lottes,
+		Uchimura,
+		Uncharted2,
+		Unreal,
+		None,
+		OperatorCount
+	};
+
+	ToneMappingLUT();
+	~ToneMappingLUT();
+	ToneMappingLUT(const ToneMappingLUT&) = delete;
+	ToneMappingLUT& operator=(const ToneMappingLUT&) = delete;
+
+	// Bakes the table for 'toneMapping' (an Operator) if it or 'exposure' (only used by the Exposure operator) changed, returns
+	// true if it did.
+	bool Update(unsigned int toneMapping, float exposure);
+
+	// GL_TEXTURE_3D, GL_RGB16F, 48 texels per side.
+	unsigned int Texture() const { return texture; }
+	// log2 of the input the first & last texels of each axis map.
+	glm::vec2 LogRange() const;
+
+	// The operator on the CPU, the function the table samples.
+	static glm::vec3 Apply(unsigned int toneMapping, float exposure, const glm::vec3& color);
+
+private:
+	unsigned int texture;
+	int toneMapping;	// -1 until the first bake.
+	float exposure;
+};
+
+#endif
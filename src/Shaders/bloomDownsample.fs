@@ -0,0 +1,67 @@
+#version 420 core
+// 13 tap downsample (Jimenez 2014): five overlapping 2x2 boxes of bilinear taps around the texel, the center box weighted most.
+//
+// Compile time feature PREFILTER: the first downsample of the HDR image, keeps only what's above the soft knee threshold & weighs
+// each box by 1 / (1 + luminance) so a single very bright pixel can't dominate (& flicker as it moves).
+out vec3 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+uniform float threshold = 2.0;
+uniform float knee = 0.5;
+
+float Luminance(vec3 color)
+{
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+#ifdef PREFILTER
+// scales the color down to what's above the threshold, with a quadratic curve over [threshold - knee, threshold + knee].
+vec3 Threshold(vec3 color)
+{
+    float brightness = Luminance(color);
+    float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 0.0001);
+    return color * max(soft, brightness - threshold) / max(brightness, 0.0001);
+}
+#endif
+
+// average of a box of 4 taps, weighted by 'weight' (& the box's brightness when prefiltering).
+void AddBox(vec3 a, vec3 b, vec3 c, vec3 d, float weight, inout vec3 result, inout float weights)
+{
+    vec3 box = (a + b + c + d) * 0.25;
+#ifdef PREFILTER
+    box = Threshold(box);
+    weight /= 1.0 + Luminance(box);
+#endif
+    result += box * weight;
+    weights += weight;
+}
+
+void main()
+{
+    vec2 texel = 1.0 / vec2(textureSize(source, 0));
+    vec3 a = texture(source, TexCoord + texel * vec2(-2.0, 2.0)).rgb;
+    vec3 b = texture(source, TexCoord + texel * vec2(0.0, 2.0)).rgb;
+    vec3 c = texture(source, TexCoord + texel * vec2(2.0, 2.0)).rgb;
+    vec3 d = texture(source, TexCoord + texel * vec2(-2.0, 0.0)).rgb;
+    vec3 e = texture(source, TexCoord).rgb;
+    vec3 f = texture(source, TexCoord + texel * vec2(2.0, 0.0)).rgb;
+    vec3 g = texture(source, TexCoord + texel * vec2(-2.0, -2.0)).rgb;
+    vec3 h = texture(source, TexCoord + texel * vec2(0.0, -2.0)).rgb;
+    vec3 i = texture(source, TexCoord + texel * vec2(2.0, -2.0)).rgb;
+    vec3 j = texture(source, TexCoord + texel * vec2(-1.0, 1.0)).rgb;
+    vec3 k = texture(source, TexCoord + texel * vec2(1.0, 1.0)).rgb;
+    vec3 l = texture(source, TexCoord + texel * vec2(-1.0, -1.0)).rgb;
+    vec3 m = texture(source, TexCoord + texel * vec2(1.0, -1.0)).rgb;
+
+    vec3 result = vec3(0.0);
+    float weights = 0.0;
+    AddBox(j, k, l, m, 0.5, result, weights);
+    AddBox(a, b, d, e, 0.125, result, weights);
+    AddBox(b, c, e, f, 0.125, result, weights);
+    AddBox(d, e, g, h, 0.125, result, weights);
+    AddBox(e, f, h, i, 0.125, result, weights);
+    FragColor = result / weights;
+}
@@ -0,0 +1,24 @@
+#version 420 core
+// 3x3 tent filter upsample of the level below, blended additively onto the level being drawn.
+out vec3 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+// tent radius in texels of the source.
+uniform float radius = 1.0;
+
+void main()
+{
+    vec2 offset = radius / vec2(textureSize(source, 0));
+    vec3 result = texture(source, TexCoord).rgb * 4.0;
+    result += texture(source, TexCoord + vec2(0.0, offset.y)).rgb * 2.0;
+    result += texture(source, TexCoord - vec2(0.0, offset.y)).rgb * 2.0;
+    result += texture(source, TexCoord + vec2(offset.x, 0.0)).rgb * 2.0;
+    result += texture(source, TexCoord - vec2(offset.x, 0.0)).rgb * 2.0;
+    result += texture(source, TexCoord + offset).rgb;
+    result += texture(source, TexCoord - offset).rgb;
+    result += texture(source, TexCoord + vec2(offset.x, -offset.y)).rgb;
+    result += texture(source, TexCoord + vec2(-offset.x, offset.y)).rgb;
+    FragColor = result / 16.0;
+}
@@ -7,62 +7,87 @@ in VS_OUT
     mat3 TBN;
 } fs_in;
 
-layout (location = 0) out vec3 gPosition;
-layout (location = 1) out vec3 gNormal;
-layout (location = 2) out vec3 gAlbedo;
-layout (location = 3) out vec3 gEmission;
-layout (location = 4) out vec2 gMetallicRoughness;
+//Position Is Reconstructed From The Depth Buffer, See deferredLighting.fs.
+layout (location = 0) out vec2 gNormal;             // Octahedral Encoded World Normal (RG16).
+layout (location = 1) out vec4 gAlbedoMetallic;     // Base Color & Metallic (sRGB RGBA8).
+layout (location = 2) out vec4 gEmissionRoughness;  // Range Compressed Emission & Roughness (RGBA8).
+
+// Compile time features, injected by Shader::Variant() (see MaterialFeatureNames() in Mesh.h):
+// HAS_BASE_COLOR_TEXTURE, HAS_METALLIC_ROUGHNESS_TEXTURE, HAS_EMISSION_TEXTURE & HAS_NORMAL_TEXTURE.
+// Textures that the mesh doesn't have are never sampled.
+layout (binding = 0) uniform sampler2D baseColorTexture;            // BCT
+layout (binding = 1) uniform sampler2D metallicRoughnessTexture;    // Metallic Roughness Texture.
+layout (binding = 2) uniform sampler2D emissionTexture;             // Emission Texture.
+layout (binding = 3) uniform sampler2D normalTexture;               // Normal Texture.
 
 uniform struct Material
 {
-    uint hasBCT;                                // Tells if There is A Base Color Texture For This Mesh.
-    sampler2D baseColorTexture;                 // BCT
-
-    uint hasMRT;                                // Tells if There is a metallicRoughness Texture.
-    sampler2D metallicRoughnessTexture;         // Metallic Roughness Texture.
     float metallicFactor;                       // Metallic Factor Multiplied By The Sampling of the Blue Color of Metallic Roughness Texture.
     float roughnessFactor;                      // Roughness Factor Multiplied By The Sampling of the Green Color of Metallic Roughness Texture.
-
-    uint hasET;                                 // Tells if There is A Emissive Texture for this Mesh.
     float emissionStrength;                     // The Strength Of The Emission Texture To Add Color Bleeding.
-    sampler2D emissionTexture;                  // Emission Texture.
-
-    uint hasNT;                                 // Tells if There is A Normal Texture for this Mesh.
-    sampler2D normalTexture;                    // Normal Texture.
 }material;
 
-void main()
+//Folds The Lower Hemisphere Of The Octahedron Over The Upper One.
+vec2 OctahedronWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+//Unit Vector To Octahedral Coordinates in [0, 1].
+vec2 EncodeNormal(vec3 n)
 {
-    //Store The Fragment Position in the First gBuffer Texture.
-    gPosition = fs_in.FragPos;
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    n.xy = n.z >= 0.0 ? n.xy : OctahedronWrap(n.xy);
+    return n.xy * 0.5 + 0.5;
+}
 
-    //Store The Fragment Normal in the Second gBuffer Texture.
-    vec3 normal = material.hasNT > 0 ? normalize(fs_in.TBN * (texture(material.normalTexture, fs_in.TexCoord).rgb * 2.0 - 1.0)) : normalize(fs_in.Normal);
-    gNormal = normal;
+//Maps HDR Emission To [0, 1) So It Fits 8 Bits, Inverted With e / (1 - e).
+vec3 EncodeEmission(vec3 emission)
+{
+    return emission / (1.0 + emission);
+}
+
+void main()
+{
+    //Store The Fragment Normal in the First gBuffer Texture.
+#ifdef HAS_NORMAL_TEXTURE
+    vec3 normal = normalize(fs_in.TBN * (texture(normalTexture, fs_in.TexCoord).rgb * 2.0 - 1.0));
+#else
+    vec3 normal = normalize(fs_in.Normal);
+#endif
+    gNormal = EncodeNormal(normal);
 
     //Get Emission Color.
-    vec3 emissionColor = material.emissionStrength * material.hasET * texture2D(material.emissionTexture, fs_in.TexCoord).rgb;
+#ifdef HAS_EMISSION_TEXTURE
+    vec3 emissionColor = material.emissionStrength * texture(emissionTexture, fs_in.TexCoord).rgb;
+#else
+    vec3 emissionColor = vec3(0.0f);
+#endif
 
     //Get Base Color.
-    vec3 baseColor = material.hasBCT * texture2D(material.baseColorTexture, fs_in.TexCoord).rgb;
+#ifdef HAS_BASE_COLOR_TEXTURE
+    vec3 baseColor = texture(baseColorTexture, fs_in.TexCoord).rgb;
+#else
+    vec3 baseColor = vec3(0.0f);
+#endif
 
+#ifdef HAS_EMISSION_TEXTURE
     //Don't Have Base Color where there is Emission.
-    if(emissionColor.r > 0.1f && material.hasET == 1) baseColor = vec3(0.0f);
-
-    //Store The Fragment Albedo Data in the Third gBuffer Texture.
-    gAlbedo = baseColor;
-
-    //Store The Fragment Emission Data in the Fourth gBuffer Texture.
-    gEmission = emissionColor;
+    if(emissionColor.r > 0.1f) baseColor = vec3(0.0f);
+#endif
 
     //Get Metallic Roughness Value
     vec2 metallicRoughness = vec2(1.0f);
     //Multiply Roughness & Roughness Factor & Metallicness By Metallic Factor.     
     metallicRoughness.r *= clamp(material.metallicFactor, 0.0, 1.0);
     metallicRoughness.g *= clamp(material.roughnessFactor, 0.0, 1.0);
-    if(material.hasMRT > 0)
-        metallicRoughness *= texture2D(material.metallicRoughnessTexture, fs_in.TexCoord).bg;
+#ifdef HAS_METALLIC_ROUGHNESS_TEXTURE
+    metallicRoughness *= texture(metallicRoughnessTexture, fs_in.TexCoord).bg;
+#endif
     
-    //Store The Fragment Metallic Roughness Data in the Fifth gBuffer Texture.
-    gMetallicRoughness = metallicRoughness;
+    //Store The Fragment Albedo & Metallic Data in the Second gBuffer Texture.
+    gAlbedoMetallic = vec4(baseColor, metallicRoughness.r);
+
+    //Store The Fragment Emission & Roughness Data in the Third gBuffer Texture.
+    gEmissionRoughness = vec4(EncodeEmission(emissionColor), metallicRoughness.g);
 }
\ No newline at end of file
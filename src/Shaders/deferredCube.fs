@@ -8,11 +8,10 @@ in VS_OUT {
     mat3 TBN;
 } fs_in;
 
-layout (location = 0) out vec3 gPosition;
-layout (location = 1) out vec3 gNormal;
-layout (location = 2) out vec3 gAlbedo;
-layout (location = 3) out vec3 gEmission;
-layout (location = 4) out vec2 gMetallicRoughness;
+//Position Is Reconstructed From The Depth Buffer, See deferredLighting.fs.
+layout (location = 0) out vec2 gNormal;             // Octahedral Encoded World Normal (RG16).
+layout (location = 1) out vec4 gAlbedoMetallic;     // Base Color & Metallic (sRGB RGBA8).
+layout (location = 2) out vec4 gEmissionRoughness;  // Range Compressed Emission & Roughness (RGBA8).
 
 uniform sampler2D diffuse;
 uniform sampler2D normal;
@@ -63,11 +62,28 @@ vec2 ParallaxOcclusionMapping(vec2 texCoords, vec3 viewDir)
     return finalTexCoords;
 }
 
-void main()
+//Folds The Lower Hemisphere Of The Octahedron Over The Upper One.
+vec2 OctahedronWrap(vec2 v)
 {
-    //Store The Fragment Position in the First gBuffer Texture.
-    gPosition = fs_in.FragPos;
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
 
+//Unit Vector To Octahedral Coordinates in [0, 1].
+vec2 EncodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    n.xy = n.z >= 0.0 ? n.xy : OctahedronWrap(n.xy);
+    return n.xy * 0.5 + 0.5;
+}
+
+//Maps HDR Emission To [0, 1) So It Fits 8 Bits, Inverted With e / (1 - e).
+vec3 EncodeEmission(vec3 emission)
+{
+    return emission / (1.0 + emission);
+}
+
+void main()
+{
     // offset texture coordinates with Parallax Mapping
     vec3 tangentViewDir = normalize(fs_in.TangentViewPos - fs_in.TangentFragPos);
     vec2 texCoords = fs_in.TexCoord;
@@ -76,23 +92,20 @@ void main()
     // obtain normal from normal map
     vec3 norm = texture(normal, texCoords).rgb;
     norm = normalize(fs_in.TBN * (norm * 2.0 - 1.0));
-    //Store The Fragment Normal in the Second gBuffer Texture.
-    gNormal = norm;
+    //Store The Fragment Normal in the First gBuffer Texture.
+    gNormal = EncodeNormal(norm);
 
     //Get Base Color.
     vec3 baseColor = texture(diffuse, texCoords).rgb;
-    //Store The Fragment Albedo Data in the Third gBuffer Texture.
-    gAlbedo = baseColor;
-
-    //Store The Fragment Emission Data in the Fourth gBuffer Texture.
-    gEmission = vec3(0.0f);
-
     //Get Metallic Roughness Value
     vec2 metallicRoughness = vec2(1.0f);
     //Multiply Roughness & Roughness Factor & Metallicness By Metallic Factor.
     metallicRoughness.r *= clamp(metallicness, 0.0, 1.0);
     metallicRoughness.g *= clamp(roughness, 0.0, 1.0);
 
-    //Store The Fragment Metallic Roughness Data in the Fifth gBuffer Texture.
-    gMetallicRoughness = metallicRoughness;
+    //Store The Fragment Albedo & Metallic Data in the Second gBuffer Texture.
+    gAlbedoMetallic = vec4(baseColor, metallicRoughness.r);
+
+    //Store The Fragment Emission & Roughness Data in the Third gBuffer Texture, The Cube Has No Emission.
+    gEmissionRoughness = vec4(0.0f, 0.0f, 0.0f, metallicRoughness.g);
 }
\ No newline at end of file
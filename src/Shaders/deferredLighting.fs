@@ -1,29 +1,71 @@
 #version 420 core
 layout (location = 0) out vec4 FragmentColor;
-layout (location = 1) out vec4 BrightColor;
 
 in vec2 TexCoord;
 
+// Compile time features, injected by Shader::Variant() (see lightingFeatureNames in AdvancedLighting.cpp):
+// PBR, PHYSICAL_ATTENUATION, SSAO, AO_MULTI_BOUNCE, BENT_NORMALS, SH_IRRADIANCE, ENVIRONMENT_CROSSFADE, TEMPORAL_SAMPLING and per light LIGHTn_SHADOWS, LIGHTn_SOFT_SHADOWS, LIGHTn_FAST_SOFT_SHADOWS,
+// LIGHTn_ESM_SHADOWS, LIGHTn_BLINN & LIGHTn_DEBUG_SHADOW. Disabled features are compiled out instead of branched over per pixel.
+#ifdef LIGHT0_SHADOWS
+#define LIGHT0_SHADOWS_ENABLED true
+#else
+#define LIGHT0_SHADOWS_ENABLED false
+#endif
+#ifdef LIGHT1_SHADOWS
+#define LIGHT1_SHADOWS_ENABLED true
+#else
+#define LIGHT1_SHADOWS_ENABLED false
+#endif
+
+// 0 - Hard Shadows
+// 1 - Soft Shadows
+// 2 - Faster Soft Shadows
+// 3 - Exponential Shadows
+#if defined(LIGHT0_ESM_SHADOWS)
+#define LIGHT0_SHADOW_TYPE 3
+#elif defined(LIGHT0_FAST_SOFT_SHADOWS)
+#define LIGHT0_SHADOW_TYPE 2
+#elif defined(LIGHT0_SOFT_SHADOWS)
+#define LIGHT0_SHADOW_TYPE 1
+#else
+#define LIGHT0_SHADOW_TYPE 0
+#endif
+#if defined(LIGHT1_ESM_SHADOWS)
+#define LIGHT1_SHADOW_TYPE 3
+#elif defined(LIGHT1_FAST_SOFT_SHADOWS)
+#define LIGHT1_SHADOW_TYPE 2
+#elif defined(LIGHT1_SOFT_SHADOWS)
+#define LIGHT1_SHADOW_TYPE 1
+#else
+#define LIGHT1_SHADOW_TYPE 0
+#endif
+
+//Which Lighting Model To use.
+#ifdef LIGHT0_BLINN
+#define LIGHT0_BLINN_ENABLED true
+#else
+#define LIGHT0_BLINN_ENABLED false
+#endif
+#ifdef LIGHT1_BLINN
+#define LIGHT1_BLINN_ENABLED true
+#else
+#define LIGHT1_BLINN_ENABLED false
+#endif
+
 struct PointLight
 {
     vec3 position;
     vec3 color;
     float intensity;
 
-    //Which Lighting Model To use.
-    bool blinn;
-
     //Shadows
-    bool shadows;
-    // 0 - Hard Shadows
-    // 1 - Soft Shadows
-    // 2 - Faster Soft Shadows
-    uint shadowType;
     float softShadowOffset;
     float fsoftShadowFactor;
-    bool debugShadow;
-    samplerCube shadowMap;
+    float shadowNearPlane;
     float shadowFarPlane;
+    float esmExponent;
+    int shadowTier;         //Shadow Atlas Tier & Cubemap, -1 If The Light Has No Shadows This Frame.
+    int shadowLayer;
 
     //Attenuation Stuff
     float linear;
@@ -36,22 +78,76 @@ uniform PointLight pointLight[NR_OF_POINT_LIGHTS];
 uniform vec3 viewPos;
 
 uniform float ambientStrength;
-uniform bool ssaoEnabled;
 uniform float specularStrength;
 
-uniform sampler2D gPosition;
-uniform sampler2D gNormal;
-uniform sampler2D gAlbedo;
-uniform sampler2D gEmission;
-uniform sampler2D gMetallicRoughness;
-uniform sampler2D ambientOcclusionMap;
+//Geometry Buffer (see deferredBed.fs), The World Position Is Reconstructed From The Depth With inverseViewProjection.
+layout (binding = 0) uniform sampler2D gDepth;
+layout (binding = 1) uniform sampler2D gNormal;
+layout (binding = 2) uniform sampler2D gAlbedoMetallic;
+layout (binding = 3) uniform sampler2D gEmissionRoughness;
+uniform mat4 inverseViewProjection;
+//Half Resolution Occlusion & Linear View Depth (see AmbientOcclusion.h), projectionDepth Is projection[2][2] & projection[3][2].
+layout (binding = 7) uniform sampler2D ambientOcclusionMap;
+uniform vec2 projectionDepth;
+#ifdef BENT_NORMALS
+//World Space Bent Normals * 0.5 + 0.5 Matching ambientOcclusionMap, Used For The Diffuse Irradiance Lookup.
+layout (binding = 4) uniform sampler2D bentNormalMap;
+#endif
+
+#ifdef TEMPORAL_SAMPLING
+//TAA Accumulates The Result, So The Soft Shadow Disks Take Fewer Samples & Rotate Every Frame (frameIndex Wraps Around).
+uniform int frameIndex;
+#endif
+
+//Point Shadow Atlas Tiers (Units 13 - 15), A Light Samples Cubemap shadowLayer Of Tier shadowTier (see ShadowAtlas.h).
+//Depth Comparison With Linear Filtering, Each Fetch Is A 2x2 PCF.
+#define NR_OF_SHADOW_TIERS 3
+layout (binding = 13) uniform samplerCubeArrayShadow shadowAtlas[NR_OF_SHADOW_TIERS];
+#if defined(LIGHT0_ESM_SHADOWS) || defined(LIGHT1_ESM_SHADOWS) || defined(LIGHT0_DEBUG_SHADOW) || defined(LIGHT1_DEBUG_SHADOW)
+#define FILTERED_SHADOWS
+//The Filtered Maps For Exponential Shadows & The Shadow Debug View Are At Units 16 - 18, Past The 16 Units GL 4.2 Guarantees,
+//So Only The Variants Reading Them Declare Them & They Aren't Offered Where The Fragment Shader Has Fewer Units.
+layout (binding = 16) uniform samplerCubeArray filteredShadowAtlas[NR_OF_SHADOW_TIERS];
+#endif
 
 //PBR
-uniform bool pbrEnabled;
-uniform bool physicallyCorrectAttenuation;
-uniform samplerCube irradianceMap;
-uniform samplerCube prefilterMap;
-uniform sampler2D brdfLUT;
+layout (binding = 8) uniform samplerCube irradianceMap;
+layout (binding = 9) uniform samplerCube prefilterMap;
+layout (binding = 10) uniform sampler2D brdfLUT;
+
+//Environment Orientation & Brightness, Applied At Lookup Time So Changing Them Needs No Re-Bake.
+uniform mat3 environmentRotation;
+uniform float environmentIntensity;
+
+#ifdef ENVIRONMENT_CROSSFADE
+//Maps Of The Previous Environment While Fading To A Newly Baked One, environmentBlend Goes From 0 (Previous) To 1 (Current).
+//SH Irradiance Is Blended On The CPU.
+layout (binding = 11) uniform samplerCube previousIrradianceMap;
+layout (binding = 12) uniform samplerCube previousPrefilterMap;
+uniform float environmentBlend;
+#endif
+
+#ifdef SH_IRRADIANCE
+//Irradiance / PI Of The Environment As 9 SH Coefficients, Projected On The CPU (see SphericalHarmonics.cpp).
+//The Cosine Lobe Convolution & Basis Constants Are Already Folded Into The Coefficients.
+layout (std140, binding = 1) uniform EnvironmentSH
+{
+    vec4 shCoefficients[9];
+};
+
+vec3 EvaluateSHIrradiance(vec3 n)
+{
+    return max(shCoefficients[0].rgb
+             + shCoefficients[1].rgb * n.y
+             + shCoefficients[2].rgb * n.z
+             + shCoefficients[3].rgb * n.x
+             + shCoefficients[4].rgb * (n.x * n.y)
+             + shCoefficients[5].rgb * (n.y * n.z)
+             + shCoefficients[6].rgb * (3.0 * n.z * n.z - 1.0)
+             + shCoefficients[7].rgb * (n.x * n.z)
+             + shCoefficients[8].rgb * (n.x * n.x - n.y * n.y), vec3(0.0));
+}
+#endif
 
 const float PI = 3.14159265359;
 // ----------------------------------------------------------------------------
@@ -101,75 +197,125 @@ vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
 }   
 // ----------------------------------------------------------------------------
 
-// array of offset direction for sampling
-vec3 gridSamplingDisk[20] = vec3[]
-(
-   vec3(1, 1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1, 1,  1), 
-   vec3(1, 1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1),
-   vec3(1, 1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1, 1,  0),
-   vec3(1, 0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1, 0, -1),
-   vec3(0, 1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0, 1, -1)
-);
-
-float ShadowCalculation(PointLight light, vec3 FragPos)
+#ifdef TEMPORAL_SAMPLING
+#define SOFT_SHADOW_SAMPLES 4
+#define FAST_SOFT_SHADOW_SAMPLES 4
+#else
+#define SOFT_SHADOW_SAMPLES 16
+#define FAST_SOFT_SHADOW_SAMPLES 8
+#endif
+#define GOLDEN_ANGLE 2.39996323
+
+// Interleaved gradient noise (Jimenez 2014), a per pixel value in [0;1) that averages out over a few pixels.
+float InterleavedGradientNoise(vec2 pixel)
+{
+    return fract(52.9829189 * fract(dot(pixel, vec2(0.06711056, 0.00583715))));
+}
+
+// Sample i of a Vogel disk of n samples in the unit disk, rotated by 'rotation'.
+vec2 VogelDiskSample(int i, int n, float rotation)
 {
+    float radius = sqrt((float(i) + 0.5) / float(n));
+    float theta = float(i) * GOLDEN_ANGLE + rotation;
+    return radius * vec2(cos(theta), sin(theta));
+}
+
+// Distance of 'fragToLight' along the axis of the cubemap face 'direction' falls on, the view depth in that face.
+float FaceAxisDistance(vec3 direction, vec3 fragToLight)
+{
+    vec3 axes = abs(direction);
+    vec3 distances = abs(fragToLight);
+    return axes.x >= axes.y && axes.x >= axes.z ? distances.x : (axes.y >= axes.z ? distances.y : distances.z);
+}
+
+// Hardware depth a face's projection (90 degrees, the light's near & far planes) gives view depth 'distance'.
+// The shadow maps store that depth as is, so the references are brought into the same space instead of linearizing every fetch.
+float FaceDepth(PointLight light, float distance)
+{
+    float n = light.shadowNearPlane;
+    float f = light.shadowFarPlane;
+    return ((f + n) - 2.0 * f * n / distance) / (f - n) * 0.5 + 0.5;
+}
+
+// Fraction of the light reaching the fragment at 'fragToLight' looking up 'direction', one hardware PCF fetch.
+float ShadowLit(PointLight light, vec3 direction, vec3 fragToLight, float bias)
+{
+    float reference = FaceDepth(light, FaceAxisDistance(direction, fragToLight) - bias);
+    return texture(shadowAtlas[light.shadowTier], vec4(direction, light.shadowLayer), reference);
+}
+
+// Filtered linear depth / far plane for exponential shadows towards 'direction', in [0;1].
+float FilteredShadowDepth(PointLight light, vec3 direction)
+{
+#ifdef FILTERED_SHADOWS
+    return texture(filteredShadowAtlas[light.shadowTier], vec4(direction, light.shadowLayer)).r;
+#else
+    return 1.0;
+#endif
+}
+
+// PCF over a disk of 'radius' (world units at the fragment) around the fragment, perpendicular to the light direction.
+// The disk is rotated per pixel, trading banding for noise that the few samples leave behind. With temporal sampling the
+// rotation also changes every frame, the noise pattern moving by the offset that decorrelates consecutive frames (Jimenez 2014).
+float DiskShadowLit(PointLight light, vec3 fragToLight, float bias, float radius, const int samples)
+{
+    vec3 direction = normalize(fragToLight);
+    vec3 up = abs(direction.y) < 0.999 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 tangent = normalize(cross(up, direction));
+    vec3 bitangent = cross(direction, tangent);
+#ifdef TEMPORAL_SAMPLING
+    float rotation = InterleavedGradientNoise(gl_FragCoord.xy + 5.588238 * float(frameIndex)) * 2.0 * PI;
+#else
+    float rotation = InterleavedGradientNoise(gl_FragCoord.xy) * 2.0 * PI;
+#endif
+
+    float lit = 0.0;
+    for(int i = 0; i < samples; ++i)
+    {
+        vec2 offset = VogelDiskSample(i, samples, rotation) * radius;
+        lit += ShadowLit(light, fragToLight + tangent * offset.x + bitangent * offset.y, fragToLight, bias);
+    }
+    return lit / float(samples);
+}
+
+// 'shadowType' is always a compile time constant, so only the selected filter ends up in the program.
+float ShadowCalculation(PointLight light, const int shadowType, vec3 FragPos)
+{
+    if(light.shadowLayer < 0)
+        return 0.0f;
+
     // Get vector between fragment position and light position
     vec3 fragToLight = FragPos - light.position;
-    // Get current linear depth as the length between the fragment and light position
-    float currentDepth = length(fragToLight);
-    
+
     float bias = 0.05f; // we use a much larger bias since depth is now in [near_plane, far_plane] range
-    float shadow = 0.0f;
 
-    if(light.shadowType == 0)
+    if(shadowType == 0)
     {
         //Hard Shadows
-        // use the fragment to light vector to sample from the depth map
-        float closestDepth = texture(light.shadowMap, fragToLight).r;
-        // it is currently in linear range between [0,1], let's re-transform it back to original depth value
-        closestDepth *= light.shadowFarPlane;
-        shadow = currentDepth -  bias > closestDepth ? 1.0 : 0.0;
+        return 1.0 - ShadowLit(light, fragToLight, fragToLight, bias);
     }
-    else if(light.shadowType == 1)
+    else if(shadowType == 1)
     {
-        //Soft Shadows(Percentage Close Filtering)
-        float samples = 4.0f;
-        float offset = light.softShadowOffset;
-        for(float x = -offset; x < offset; x += offset / (samples * 0.5))
-        {
-            for(float y = -offset; y < offset; y += offset / (samples * 0.5))
-            {
-                for(float z = -offset; z < offset; z += offset / (samples * 0.5))
-                {
-                    float closestDepth = texture(light.shadowMap, fragToLight + vec3(x, y, z)).r; // use lightdir to lookup cubemap
-                    closestDepth *= light.shadowFarPlane;   // Undo mapping [0;1]
-                    if(currentDepth - bias > closestDepth)
-                        shadow += 1.0;
-                }
-            }
-        }
-        shadow /= (samples * samples * samples);
+        //Soft Shadows(Percentage Close Filtering Over A Rotated Vogel Disk)
+        return 1.0 - DiskShadowLit(light, fragToLight, bias, light.softShadowOffset, SOFT_SHADOW_SAMPLES);
     }
-    else
+    else if(shadowType == 2)
     {
-        //Fast Soft Shadows
-        int samples = 20;
+        //Fast Soft Shadows, Wider Further From The Camera
         float viewDistance = length(viewPos - FragPos);
         float diskRadius = (1.0 + (viewDistance / light.shadowFarPlane)) / light.fsoftShadowFactor;
-        for(int i = 0; i < samples; ++i)
-        {
-            float closestDepth = texture(light.shadowMap, fragToLight + gridSamplingDisk[i] * diskRadius).r;
-            closestDepth *= light.shadowFarPlane;   // undo mapping [0;1]
-            if(currentDepth - bias > closestDepth)
-                shadow += 1.0;
-        }
-        shadow /= float(samples);
+        return 1.0 - DiskShadowLit(light, fragToLight, bias, diskRadius, FAST_SOFT_SHADOW_SAMPLES);
+    }
+    else
+    {
+        //Exponential Shadows From The Prefiltered Map. The Bias Scales The Result By exp(esmExponent * bias), So It's Kept Small.
+        float esmReference = (FaceAxisDistance(fragToLight, fragToLight) - 0.01f) / light.shadowFarPlane;
+        float filteredDepth = FilteredShadowDepth(light, fragToLight);
+        return 1.0 - clamp(exp(light.esmExponent * (filteredDepth - esmReference)), 0.0, 1.0);
     }
-
-    return shadow;
 }
 
-vec3 CalculatePointLight(PointLight light, vec3 FragPos, vec3 Normal, vec3 viewDir, vec3 ambientColor, vec3 baseColor)
+vec3 CalculatePointLight(PointLight light, const bool shadows, const int shadowType, const bool blinn, vec3 FragPos, vec3 Normal, vec3 viewDir, vec3 ambientColor, vec3 baseColor)
 {
     vec3 LightPos = light.position;
     vec3 lightDir = normalize(LightPos - FragPos);
@@ -189,14 +335,14 @@ vec3 CalculatePointLight(PointLight light, vec3 FragPos, vec3 Normal, vec3 viewD
 
     vec3 specular = vec3(specularStrength);
 
-    if(baseColor == 0.0f)
+    if(baseColor == vec3(0.0f))
     {
         //Nullify Specular Component When There is no Diffuse Component.
         specular = vec3(0.0f);
     }
     else
     {
-        if(light.blinn)
+        if(blinn)
         {
            const float kEnergyConservation = ( 8.0 + kShininess ) / ( 8.0 * kPi );
            vec3 halfwayDir = normalize(lightDir + viewDir); 
@@ -210,26 +356,149 @@ vec3 CalculatePointLight(PointLight light, vec3 FragPos, vec3 Normal, vec3 viewD
         }
     }
 
-    float shadow = light.shadows ? ShadowCalculation(light, FragPos) : 0.0f;
+    float shadow = shadows ? ShadowCalculation(light, shadowType, FragPos) : 0.0f;
 
     return ambientColor + (1.0f - shadow) * (baseColor + specular);
 }
 
+// Cook-Torrance radiance of a single point light.
+vec3 CalculatePBRPointLight(PointLight light, const bool shadows, const int shadowType, vec3 FragPos, vec3 Normal, vec3 viewDir, vec3 baseColor, vec3 F0, float metallic, float roughness)
+{
+    // calculate per-light radiance
+    vec3 L = normalize(light.position - FragPos);
+    vec3 H = normalize(viewDir + L);
+    float dist = length(light.position - FragPos);
+#ifdef PHYSICAL_ATTENUATION
+    float attenuation = 1.0 / (dist * dist);
+#else
+    float attenuation = 1.0 / (light.quadratic * dist * dist);
+#endif
+    vec3 radiance = light.color * light.intensity * attenuation;
+
+    // Cook-Torrance BRDF
+    float NDF = DistributionGGX(Normal, H, roughness);
+    float G   = GeometrySmith(Normal, viewDir, L, roughness);
+    vec3 F    = fresnelSchlick(max(dot(H, viewDir), 0.0), F0);
+    
+    vec3 numerator    = NDF * G * F;
+    float denominator = 4.0 * max(dot(Normal, viewDir), 0.0) * max(dot(Normal, L), 0.0) + 0.0001; // + 0.0001 to prevent divide by zero
+    vec3 specular = numerator / denominator;
+    
+     // kS is equal to Fresnel
+    vec3 kS = F;
+    // for energy conservation, the diffuse and specular light can't
+    // be above 1.0 (unless the surface emits light); to preserve this
+    // relationship the diffuse component (kD) should equal 1.0 - kS.
+    vec3 kD = vec3(1.0) - kS;
+    // multiply kD by the inverse metalness such that only non-metals 
+    // have diffuse lighting, or a linear blend if partly metal (pure metals
+    // have no diffuse light).
+    kD *= 1.0 - metallic;	                
+        
+    // scale light by NdotL
+    float NdotL = max(dot(Normal, L), 0.0);        
+
+    //Calculate Shadows if Enabled.
+    float shadow = shadows ? ShadowCalculation(light, shadowType, FragPos) : 0.0f;
+
+    // outgoing radiance Lo
+    return (1.0 - shadow) * (kD * baseColor / PI + specular) * radiance * NdotL; // note that we already multiplied the BRDF by the Fresnel (kS) so we won't multiply by kS again
+}
+
+//Inverse Of The Octahedral Encoding In The Geometry Pass.
+vec3 DecodeNormal(vec2 encoded)
+{
+    encoded = encoded * 2.0 - 1.0;
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+//Inverse Of The Emission Range Compression In The Geometry Pass.
+vec3 DecodeEmission(vec3 encoded)
+{
+    return encoded / max(1.0 - encoded, 1.0 / 255.0);
+}
+
+//World Position Of The Surface Whose Depth Is Stored At uv.
+vec3 ReconstructPosition(vec2 uv, float depth)
+{
+    vec4 position = inverseViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    return position.xyz / position.w;
+}
+
+//Joint Bilateral Upsample Of The Half Resolution Occlusion, The Bilinear Weights Scaled Down By Each Texel's Depth Difference.
+//With BENT_NORMALS bentNormal Is Replaced By The Upsampled Bent Normal.
+float UpsampleOcclusion(vec2 uv, float depth, inout vec3 bentNormal)
+{
+    float linearDepth = projectionDepth.y / (depth * 2.0 - 1.0 + projectionDepth.x);
+    vec2 position = uv * vec2(textureSize(gDepth, 0)) * 0.5 - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 fraction = position - vec2(base);
+    ivec2 maxTexel = textureSize(ambientOcclusionMap, 0) - 1;
+
+    float occlusion = 0.0;
+    float weights = 0.0;
+    vec3 bent = vec3(0.0);
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 coordinates = clamp(base + offset, ivec2(0), maxTexel);
+        vec2 texel = texelFetch(ambientOcclusionMap, coordinates, 0).rg;
+        float bilinear = mix(1.0 - fraction.x, fraction.x, float(offset.x)) * mix(1.0 - fraction.y, fraction.y, float(offset.y));
+        float weight = bilinear / (0.001 + abs(texel.g - linearDepth) / linearDepth);
+        occlusion += texel.r * weight;
+        weights += weight;
+#ifdef BENT_NORMALS
+        bent += (texelFetch(bentNormalMap, coordinates, 0).xyz * 2.0 - 1.0) * weight;
+#endif
+    }
+#ifdef BENT_NORMALS
+    if (dot(bent, bent) > 0.0)
+        bentNormal = normalize(bent);
+#endif
+    return weights > 0.0 ? occlusion / weights : 1.0;
+}
+
+//Multi Bounce Approximation Of GTAO (Jimenez Et Al. 2016): Light Bouncing Between Nearby Surfaces Of Similar Albedo Brightens The Occlusion.
+vec3 MultiBounceOcclusion(float visibility, vec3 albedo)
+{
+    vec3 a = 2.0404 * albedo - 0.3324;
+    vec3 b = -4.7951 * albedo + 0.6417;
+    vec3 c = 2.7552 * albedo + 0.6903;
+    return max(vec3(visibility), ((visibility * a + b) * visibility + c) * visibility);
+}
+
 void main()
 {   
     // Retrieve data from gbuffer
-    vec3 FragPos = texture(gPosition, TexCoord).rgb;
-    vec3 Normal = texture(gNormal, TexCoord).rgb;
-    vec3 baseColor = texture(gAlbedo, TexCoord).rgb;
-    vec3 emissionColor = texture(gEmission, TexCoord).rgb;
-    float AmbientOcclusion = ssaoEnabled ? texture(ambientOcclusionMap, TexCoord).r : 1.0f;
+    float depth = texture(gDepth, TexCoord).r;
+    //Nothing Was Drawn Here, The Skybox Fills It Later.
+    if (depth == 1.0)
+    {
+        FragmentColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+    vec3 FragPos = ReconstructPosition(TexCoord, depth);
+    vec3 Normal = DecodeNormal(texture(gNormal, TexCoord).rg);
+    vec4 albedoMetallic = texture(gAlbedoMetallic, TexCoord);
+    vec4 emissionRoughness = texture(gEmissionRoughness, TexCoord);
+    vec3 baseColor = albedoMetallic.rgb;
+    vec3 emissionColor = DecodeEmission(emissionRoughness.rgb);
+    vec3 BentNormal = Normal;
+#ifdef SSAO
+    float AmbientOcclusion = UpsampleOcclusion(TexCoord, depth, BentNormal);
+#else
+    float AmbientOcclusion = 1.0f;
+#endif
 
     // Get View Direction.
     vec3 viewDir  = normalize(viewPos - FragPos);
 
     vec3 lightingResult = vec3(0.0f);
 
-    if(pbrEnabled)
+#ifdef PBR
     {
         //PBR Shading.
         
@@ -237,8 +506,8 @@ void main()
         baseColor = pow(baseColor, vec3(2.2));
 
         //Get Metallic & Roughness.
-        float metallic = texture(gMetallicRoughness, TexCoord).r;
-        float roughness = texture(gMetallicRoughness, TexCoord).g;
+        float metallic = albedoMetallic.a;
+        float roughness = emissionRoughness.a;
 
         vec3 R = reflect(-viewDir, Normal);
 
@@ -249,44 +518,8 @@ void main()
 
         // reflectance equation
         vec3 Lo = vec3(0.0);
-        for(int i = 0; i < NR_OF_POINT_LIGHTS; ++i) 
-        {
-            // calculate per-light radiance
-            vec3 L = normalize(pointLight[i].position - FragPos);
-            vec3 H = normalize(viewDir + L);
-            float dist = length(pointLight[i].position - FragPos);
-            float attenuation = physicallyCorrectAttenuation ? 1.0 / (dist * dist) : 1.0 / (pointLight[i].quadratic * dist * dist);
-            vec3 radiance = pointLight[i].color * pointLight[i].intensity * attenuation;
-
-            // Cook-Torrance BRDF
-            float NDF = DistributionGGX(Normal, H, roughness);
-            float G   = GeometrySmith(Normal, viewDir, L, roughness);
-            vec3 F    = fresnelSchlick(max(dot(H, viewDir), 0.0), F0);
-            
-            vec3 numerator    = NDF * G * F;
-            float denominator = 4.0 * max(dot(Normal, viewDir), 0.0) * max(dot(Normal, L), 0.0) + 0.0001; // + 0.0001 to prevent divide by zero
-            vec3 specular = numerator / denominator;
-            
-             // kS is equal to Fresnel
-            vec3 kS = F;
-            // for energy conservation, the diffuse and specular light can't
-            // be above 1.0 (unless the surface emits light); to preserve this
-            // relationship the diffuse component (kD) should equal 1.0 - kS.
-            vec3 kD = vec3(1.0) - kS;
-            // multiply kD by the inverse metalness such that only non-metals 
-            // have diffuse lighting, or a linear blend if partly metal (pure metals
-            // have no diffuse light).
-            kD *= 1.0 - metallic;	                
-                
-            // scale light by NdotL
-            float NdotL = max(dot(Normal, L), 0.0);        
-
-            //Calculate Shadows if Enabled.
-            float shadow = pointLight[i].shadows ? ShadowCalculation(pointLight[i], FragPos) : 0.0f;
-
-            // add to outgoing radiance Lo
-            Lo += (1.0 - shadow) * (kD * baseColor / PI + specular) * radiance * NdotL; // note that we already multiplied the BRDF by the Fresnel (kS) so we won't multiply by kS again
-        }
+        Lo += CalculatePBRPointLight(pointLight[0], LIGHT0_SHADOWS_ENABLED, LIGHT0_SHADOW_TYPE, FragPos, Normal, viewDir, baseColor, F0, metallic, roughness);
+        Lo += CalculatePBRPointLight(pointLight[1], LIGHT1_SHADOWS_ENABLED, LIGHT1_SHADOW_TYPE, FragPos, Normal, viewDir, baseColor, F0, metallic, roughness);
     
         // ambient lighting (we now use IBL as the ambient term)
         vec3 F = fresnelSchlickRoughness(max(dot(Normal, viewDir), 0.0), F0, roughness);
@@ -295,26 +528,48 @@ void main()
         vec3 kD = 1.0 - kS;
         kD *= 1.0 - metallic;
         
-        vec3 irradiance = texture(irradianceMap, Normal).rgb;
+        vec3 environmentNormal = environmentRotation * BentNormal;
+#ifdef SH_IRRADIANCE
+        vec3 irradiance = EvaluateSHIrradiance(environmentNormal) * environmentIntensity;
+#else
+        vec3 irradiance = texture(irradianceMap, environmentNormal).rgb * environmentIntensity;
+#ifdef ENVIRONMENT_CROSSFADE
+        irradiance = mix(texture(previousIrradianceMap, environmentNormal).rgb * environmentIntensity, irradiance, environmentBlend);
+#endif
+#endif
         vec3 diffuse    = irradiance * baseColor;
         
         // sample both the pre-filter map and the BRDF lut and combine them together as per the Split-Sum approximation to get the IBL specular part.
         const float MAX_REFLECTION_LOD = 4.0;
-        vec3 prefilteredColor = textureLod(prefilterMap, R,  roughness * MAX_REFLECTION_LOD).rgb;    
+        vec3 prefilteredColor = textureLod(prefilterMap, environmentRotation * R,  roughness * MAX_REFLECTION_LOD).rgb * environmentIntensity;
+#ifdef ENVIRONMENT_CROSSFADE
+        vec3 previousPrefilteredColor = textureLod(previousPrefilterMap, environmentRotation * R,  roughness * MAX_REFLECTION_LOD).rgb * environmentIntensity;
+        prefilteredColor = mix(previousPrefilteredColor, prefilteredColor, environmentBlend);
+#endif
         vec2 brdf  = texture(brdfLUT, vec2(max(dot(Normal, viewDir), 0.0), roughness)).rg;
         vec3 specular = prefilteredColor * (F * brdf.x + brdf.y);
 
-        vec3 ambient = (kD * diffuse + specular) * AmbientOcclusion;
+#ifdef AO_MULTI_BOUNCE
+        vec3 diffuseOcclusion = MultiBounceOcclusion(AmbientOcclusion, baseColor);
+#else
+        vec3 diffuseOcclusion = vec3(AmbientOcclusion);
+#endif
+        vec3 ambient = kD * diffuse * diffuseOcclusion + specular * AmbientOcclusion;
         
         lightingResult = ambient + Lo;
     }
-    else
+#else
     {
         //Normal Shading.
+#ifdef AO_MULTI_BOUNCE
+        vec3 ambientColor = ambientStrength * MultiBounceOcclusion(AmbientOcclusion, baseColor) * baseColor;
+#else
         vec3 ambientColor = ambientStrength * AmbientOcclusion * baseColor;
-        for(int i = 0; i < NR_OF_POINT_LIGHTS; i++)
-            lightingResult += CalculatePointLight(pointLight[i], FragPos, Normal, viewDir, ambientColor, baseColor);
+#endif
+        lightingResult += CalculatePointLight(pointLight[0], LIGHT0_SHADOWS_ENABLED, LIGHT0_SHADOW_TYPE, LIGHT0_BLINN_ENABLED, FragPos, Normal, viewDir, ambientColor, baseColor);
+        lightingResult += CalculatePointLight(pointLight[1], LIGHT1_SHADOWS_ENABLED, LIGHT1_SHADOW_TYPE, LIGHT1_BLINN_ENABLED, FragPos, Normal, viewDir, ambientColor, baseColor);
     }
+#endif
 
     //Final Fragment Color.
     vec3 color = lightingResult + emissionColor;
@@ -322,27 +577,13 @@ void main()
     // Gamma correction
     color = pow(color, vec3(1.0/2.2));
 
-    if(pointLight[0].debugShadow)
-    {
-        vec3 fragToLight = FragPos - pointLight[0].position;
-        float currentDepth = length(fragToLight);
-        float closestDepth = texture(pointLight[0].shadowMap, fragToLight).r;
-        FragmentColor = vec4(vec3(closestDepth), 1.0f);
-    }
-    else if(pointLight[1].debugShadow)
-    {
-        vec3 fragToLight = FragPos - pointLight[1].position;
-        float currentDepth = length(fragToLight);
-        float closestDepth = texture(pointLight[1].shadowMap, fragToLight).r;
-        FragmentColor = vec4(vec3(closestDepth), 1.0f);
-    }
-    else
-        FragmentColor = vec4(color, 1.0f);
-
-    //Output Brightness Color To be used By Bloom Pass.
-    float brightness = dot(color, vec3(0.2126, 0.7152, 0.0722));
-    if(brightness > 2.0)
-        BrightColor = vec4(color, 1.0f);
-	else
-		BrightColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+#if defined(LIGHT0_DEBUG_SHADOW)
+    float closestDepth = pointLight[0].shadowLayer < 0 ? 1.0f : FilteredShadowDepth(pointLight[0], FragPos - pointLight[0].position);
+    FragmentColor = vec4(vec3(closestDepth), 1.0f);
+#elif defined(LIGHT1_DEBUG_SHADOW)
+    float closestDepth = pointLight[1].shadowLayer < 0 ? 1.0f : FilteredShadowDepth(pointLight[1], FragPos - pointLight[1].position);
+    FragmentColor = vec4(vec3(closestDepth), 1.0f);
+#else
+    FragmentColor = vec4(color, 1.0f);
+#endif
 }
\ No newline at end of file
@@ -7,38 +7,26 @@ in VS_OUT
 } fs_in;
 
 layout (location = 0) out vec4 FragmentColor;
-layout (location = 1) out vec4 BrightColor;
 
-uniform struct Material
-{
-    uint hasBCT;                                // Tells if There is A Base Color Texture For This Mesh.
-    sampler2D baseColorTexture;                 // BCT
-
-    uint hasMRT;                                // Tells if There is a metallicRoughness Texture.
-    sampler2D metallicRoughnessTexture;         // Metallic Roughness Texture.
-    float metallicFactor;                       // Metallic Factor Multiplied By The Sampling of the Blue Color of Metallic Roughness Texture.
-    float roughnessFactor;                      // Roughness Factor Multiplied By The Sampling of the Green Color of Metallic Roughness Texture.
-
-    uint hasET;                                 // Tells if There is A Emissive Texture for this Mesh.
-    sampler2D emissionTexture;                  // Emission Texture.
-
-    uint hasNT;                                 // Tells if There is A Normal Texture for this Mesh.
-    sampler2D normalTexture;                    // Normal Texture.
-}material;
+// Compile time features, injected by Shader::Variant() (see MaterialFeatureNames() in Mesh.h).
+layout (binding = 0) uniform sampler2D baseColorTexture;            // BCT
+layout (binding = 3) uniform sampler2D normalTexture;               // Normal Texture.
 
 void main()
 {
     //Store The Fragment Normal in the Second gBuffer Texture.
-    vec3 normal = material.hasNT > 0 ? normalize(fs_in.TBN * (texture(material.normalTexture, fs_in.TexCoord).rgb * 2.0 - 1.0)) : normalize(fs_in.Normal);
+#ifdef HAS_NORMAL_TEXTURE
+    vec3 normal = normalize(fs_in.TBN * (texture(normalTexture, fs_in.TexCoord).rgb * 2.0 - 1.0));
+#else
+    vec3 normal = normalize(fs_in.Normal);
+#endif
 
     //Get Base Color.
-    vec4 baseColor = material.hasBCT * texture2D(material.baseColorTexture, fs_in.TexCoord);
+#ifdef HAS_BASE_COLOR_TEXTURE
+    vec4 baseColor = texture(baseColorTexture, fs_in.TexCoord);
+#else
+    vec4 baseColor = vec4(0.0f);
+#endif
 
     FragmentColor = baseColor;
-
-    float brightness = dot(FragmentColor.rgb, vec3(0.2126, 0.7152, 0.0722));
-    if(brightness > 1.0)
-        BrightColor = FragmentColor;
-	else
-		BrightColor = vec4(0.0, 0.0, 0.0, FragmentColor.a);
 }
\ No newline at end of file
@@ -0,0 +1,132 @@
+#version 420 core
+// Horizon based ambient occlusion (GTAO, Jimenez et al. 2016): for each of 'sliceCount' screen space directions the highest
+// horizons on both sides of the pixel are searched over the linear depth pyramid (see ssaoDepthPyramid.fs) & the visible arc
+// between them is integrated against the cosine lobe of the normal. Like ssao.fs one 2x2 deinterleaved quarter resolution layer
+// is drawn at a time.
+//
+// Compile time feature BENT_NORMALS: also integrates the average unoccluded direction, written in world space * 0.5 + 0.5.
+layout (location = 0) out float Occlusion;
+#ifdef BENT_NORMALS
+layout (location = 1) out vec4 BentNormal;
+uniform mat3 inverseView;
+#endif
+
+in vec2 TexCoord;
+
+// view space normals with the linear depth in alpha (see ssaoDownsample.fs).
+uniform sampler2DArray viewNormal;
+uniform sampler2D depthPyramid;
+uniform sampler2D texNoise;
+uniform int layer;
+
+uniform int sliceCount = 2;
+// taps on each side of a slice.
+uniform int stepCount = 4;
+uniform float radius = 0.1;
+uniform float strength = 1.0;
+// added to the noise & wrapped, moves the slice rotations & tap jitter on every frame with temporal accumulation.
+uniform vec2 noiseOffset = vec2(0.0);
+
+uniform mat4 projection;
+uniform vec2 fullResolution;
+
+const float PI = 3.14159265;
+const float HALF_PI = 1.57079633;
+// coarsest pyramid level & how many levels below a tap's distance in pixels (log2) it reads.
+const float MAX_MIP = 4.0;
+const float MIP_OFFSET = 3.3;
+// taps in the outer part of the radius fade towards the tangent plane's horizon, so occluders don't pop in at the radius.
+const float FALLOFF_RANGE = 0.615;
+
+// half resolution pixel offset of the layer's texels.
+ivec2 LayerOffset()
+{
+    return ivec2(layer & 1, layer >> 1);
+}
+
+// view space position of the surface at 'uv' with linear depth 'depth'.
+vec3 ViewPosition(vec2 uv, float depth)
+{
+    return vec3((uv * 2.0 - 1.0) / vec2(projection[0][0], projection[1][1]) * depth, -depth);
+}
+
+// horizon cosine seen from 'position' towards the tap 'offset' away in uv, moved to 'lowHorizonCos' the further the tap is.
+float HorizonCos(vec2 uv, vec2 offset, float mip, vec3 position, vec3 viewVector, float lowHorizonCos, float falloffMul, float falloffAdd)
+{
+    vec2 sampleUV = uv + offset;
+    vec3 delta = ViewPosition(sampleUV, textureLod(depthPyramid, sampleUV, mip).r) - position;
+    float distance = length(delta);
+    float weight = clamp(distance * falloffMul + falloffAdd, 0.0, 1.0);
+    return mix(lowHorizonCos, dot(delta / distance, viewVector), weight);
+}
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    ivec2 halfPixel = 2 * texel + LayerOffset();
+    vec2 uv = (vec2(halfPixel) * 2.0 + 1.0) / fullResolution;
+    vec4 normalDepth = texelFetch(viewNormal, ivec3(texel, layer), 0);
+    vec3 position = ViewPosition(uv, normalDepth.w);
+    vec3 normal = normalize(normalDepth.xyz);
+    vec3 viewVector = normalize(-position);
+    // slice rotation & tap jitter, the 4x4 pattern tiles the half resolution image & is averaged out by the blur.
+    vec2 noise = fract(texelFetch(texNoise, halfPixel & 3, 0).xy * 0.5 + 0.5 + noiseOffset);
+
+    // the radius on screen in uv & half resolution pixels, the first tap at least a pixel & a bit away so it misses the pixel itself.
+    vec2 uvRadius = radius * 0.5 * vec2(projection[0][0], projection[1][1]) / normalDepth.w;
+    float pixelRadius = uvRadius.x * fullResolution.x * 0.5;
+    float minStep = 1.3 / max(pixelRadius, 1.3);
+    float falloffMul = -1.0 / (radius * FALLOFF_RANGE);
+    float falloffAdd = (1.0 - FALLOFF_RANGE) / FALLOFF_RANGE + 1.0;
+
+    float visibility = 0.0;
+    vec3 bentNormal = vec3(0.0);
+    for (int slice = 0; slice < sliceCount; slice++)
+    {
+        float phi = (float(slice) + noise.x) / float(sliceCount) * PI;
+        vec3 direction = vec3(cos(phi), sin(phi), 0.0);
+        vec2 omega = direction.xy * uvRadius;
+
+        // the slice plane through the view vector, the normal projected into it & its angle 'n' from the view vector.
+        vec3 orthoDirection = normalize(direction - dot(direction, viewVector) * viewVector);
+        vec3 axis = cross(orthoDirection, viewVector);
+        vec3 projectedNormal = normal - axis * dot(normal, axis);
+        float projectedNormalLength = length(projectedNormal);
+        float cosN = clamp(dot(projectedNormal, viewVector) / projectedNormalLength, 0.0, 1.0);
+        float n = sign(dot(orthoDirection, projectedNormal)) * acos(cosN);
+
+        // the horizons start at the tangent plane, side 0 along omega & side 1 against it.
+        float lowHorizonCos0 = cos(n + HALF_PI);
+        float lowHorizonCos1 = cos(n - HALF_PI);
+        float horizonCos0 = lowHorizonCos0;
+        float horizonCos1 = lowHorizonCos1;
+        for (int step = 0; step < stepCount; step++)
+        {
+            // quadratically spaced, denser near the pixel where occluders matter most.
+            float s = (float(step) + noise.y) / float(stepCount);
+            s = s * s + minStep;
+            float mip = clamp(log2(s * pixelRadius) - MIP_OFFSET, 0.0, MAX_MIP);
+            horizonCos0 = max(horizonCos0, HorizonCos(uv, omega * s, mip, position, viewVector, lowHorizonCos0, falloffMul, falloffAdd));
+            horizonCos1 = max(horizonCos1, HorizonCos(uv, -omega * s, mip, position, viewVector, lowHorizonCos1, falloffMul, falloffAdd));
+        }
+
+        // the visible arc between the horizons (clamped to the normal's hemisphere) integrated against the projected cosine.
+        projectedNormalLength = mix(projectedNormalLength, 1.0, 0.05);
+        float h0 = n + clamp(-acos(clamp(horizonCos1, -1.0, 1.0)) - n, -HALF_PI, HALF_PI);
+        float h1 = n + clamp(acos(clamp(horizonCos0, -1.0, 1.0)) - n, -HALF_PI, HALF_PI);
+        float arc0 = (cosN + 2.0 * h0 * sin(n) - cos(2.0 * h0 - n)) / 4.0;
+        float arc1 = (cosN + 2.0 * h1 * sin(n) - cos(2.0 * h1 - n)) / 4.0;
+        visibility += projectedNormalLength * (arc0 + arc1);
+#ifdef BENT_NORMALS
+        // the same arc's cosine weighted average direction, split along the slice direction & the view vector.
+        float t0 = (6.0 * sin(h0 - n) - sin(3.0 * h0 - n) + 6.0 * sin(h1 - n) - sin(3.0 * h1 - n) + 16.0 * sin(n) - 3.0 * (sin(h0 + n) + sin(h1 + n))) / 12.0;
+        float t1 = (-cos(3.0 * h0 - n) - cos(3.0 * h1 - n) + 8.0 * cos(n) - 3.0 * (cos(h0 + n) + cos(h1 + n))) / 12.0;
+        bentNormal += (orthoDirection * t0 + viewVector * t1) * projectedNormalLength;
+#endif
+    }
+
+    Occlusion = pow(clamp(visibility / float(sliceCount), 0.0, 1.0), strength);
+#ifdef BENT_NORMALS
+    BentNormal = vec4(normalize(inverseView * bentNormal) * 0.5 + 0.5, 1.0);
+#endif
+}
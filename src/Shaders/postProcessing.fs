@@ -4,9 +4,11 @@ out vec4 FragColor;
 
 uniform sampler2D screenTexture;
 uniform sampler2D blurTexture;
-uniform float exposure;
-uniform uint toneMapping;
+// Tone mapping operator baked into a 3D table over the log2 of each channel (ToneMappingLUT).
+uniform sampler3D toneMappingLUT;
+uniform vec2 toneMappingRange;
 uniform uint bloom;
+uniform float bloomIntensity;
 
 //FXAA
 uniform vec2 texelStep;
@@ -95,115 +97,12 @@ vec3 fxaa(vec3 color)
     return antialiased;
 }
 
-//Exposure Tone Mapping
-vec3 exposureToneMapping(vec3 x){
-    return vec3(1.0) - exp(-x * exposure);
-}
-
-//Reinhard
-vec3 reinhard(vec3 x) {
-  return x / (1.0 + x);
-}
-
-//Reinhard 2
-vec3 reinhard2(vec3 x) {
-  const float L_white = 4.0;
-  return (x * (1.0 + x / (L_white * L_white))) / (1.0 + x);
-}
-
-// Filmic Tonemapping Operators http://filmicworlds.com/blog/filmic-tonemapping-operators/
-vec3 filmic(vec3 x) {
-  vec3 X = max(vec3(0.0), x - 0.004);
-  vec3 result = (X * (6.2 * X + 0.5)) / (X * (6.2 * X + 1.7) + 0.06);
-  return pow(result, vec3(2.2));
-}
-
-// Narkowicz 2015, "ACES Filmic Tone Mapping Curve"
-vec3 aces(vec3 x) 
+vec3 toneMap(vec3 color)
 {
-  const float a = 2.51;
-  const float b = 0.03;
-  const float c = 2.43;
-  const float d = 0.59;
-  const float e = 0.14;
-  return clamp((x * (a * x + b)) / (x * (c * x + d) + e), 0.0, 1.0);
-}
-
-// Lottes 2016, "Advanced Techniques and Optimization of HDR Color Pipelines"
-vec3 lottes(vec3 x) {
-  const vec3 a = vec3(1.6);
-  const vec3 d = vec3(0.977);
-  const vec3 hdrMax = vec3(8.0);
-  const vec3 midIn = vec3(0.18);
-  const vec3 midOut = vec3(0.267);
-
-  const vec3 b =
-      (-pow(midIn, a) + pow(hdrMax, a) * midOut) /
-      ((pow(hdrMax, a * d) - pow(midIn, a * d)) * midOut);
-  const vec3 c =
-      (pow(hdrMax, a * d) * pow(midIn, a) - pow(hdrMax, a) * pow(midIn, a * d) * midOut) /
-      ((pow(hdrMax, a * d) - pow(midIn, a * d)) * midOut);
-
-  return pow(x, a) / (pow(x, a * d) * b + c);
-}
-
-// Uchimura 2017, "HDR theory and practice"
-// Math: https://www.desmos.com/calculator/gslcdxvipg
-// Source: https://www.slideshare.net/nikuque/hdr-theory-and-practicce-jp
-vec3 uchimura(vec3 x, float P, float a, float m, float l, float c, float b) {
-  float l0 = ((P - m) * l) / a;
-  float L0 = m - m / a;
-  float L1 = m + (1.0 - m) / a;
-  float S0 = m + l0;
-  float S1 = m + a * l0;
-  float C2 = (a * P) / (P - S1);
-  float CP = -C2 / P;
-
-  vec3 w0 = vec3(1.0 - smoothstep(0.0, m, x));
-  vec3 w2 = vec3(step(m + l0, x));
-  vec3 w1 = vec3(1.0 - w0 - w2);
-
-  vec3 T = vec3(m * pow(x / m, vec3(c)) + b);
-  vec3 S = vec3(P - (P - S1) * exp(CP * (x - S0)));
-  vec3 L = vec3(m + a * (x - m));
-
-  return T * w0 + L * w1 + S * w2;
-}
-vec3 uchimura(vec3 x) {
-  const float P = 1.0;  // max display brightness
-  const float a = 1.0;  // contrast
-  const float m = 0.22; // linear section start
-  const float l = 0.4;  // linear section length
-  const float c = 1.33; // black
-  const float b = 0.0;  // pedestal
-
-  return uchimura(x, P, a, m, l, c, b);
-}
-
-//Uncharted2 ToneMapping
-vec3 uncharted2Tonemap(vec3 x) {
-  float A = 0.15;
-  float B = 0.50;
-  float C = 0.10;
-  float D = 0.20;
-  float E = 0.02;
-  float F = 0.30;
-  float W = 11.2;
-  return ((x * (A * x + C * B) + D * E) / (x * (A * x + B) + D * F)) - E / F;
-}
-vec3 uncharted2(vec3 color) {
-  const float W = 11.2;
-  float exposureBias = 2.0;
-  vec3 curr = uncharted2Tonemap(exposureBias * color);
-  vec3 whiteScale = 1.0 / uncharted2Tonemap(vec3(W));
-  return curr * whiteScale;
-}
-
-// Unreal 3, Documentation: "Color Grading"
-// Adapted to be close to Tonemap_ACES, with similar range
-// Gamma 2.2 correction is baked in, don't use with sRGB conversion!
-vec3 unreal(vec3 x) {
-  return x / (x + 0.155) * 1.019;
+    // Texel centers of the first & last texels along each axis hold the ends of the range.
+    float size = float(textureSize(toneMappingLUT, 0).x);
+    vec3 uvw = clamp((log2(max(color, vec3(1e-6))) - toneMappingRange.x) / (toneMappingRange.y - toneMappingRange.x), 0.0, 1.0);
+    return texture(toneMappingLUT, uvw * ((size - 1.0) / size) + 0.5 / size).rgb;
 }
 
 void main()
@@ -216,53 +115,10 @@ void main()
 
     //Add BlurTexture To The Screen Texture if Bloom Effect is Enabled.
     if(bloom > 0)
-        color += texture(blurTexture, TexCoord).rgb;
+        color += texture(blurTexture, TexCoord).rgb * bloomIntensity;
 
-    if(toneMapping == 0)
-    {
-        // Exposure tone mapping
-        color = exposureToneMapping(color);
-    }
-    else if(toneMapping == 1)
-    {
-        // Reinhard tone mapping
-        color = reinhard(color);
-    }
-    else if(toneMapping == 2)
-    {
-        // Reinhard 2 tone mapping
-        color = reinhard2(color);
-    }
-    else if(toneMapping == 3)
-    {
-        // Filmic Tone Mapping
-        color = filmic(color);
-    }
-    else if(toneMapping == 4)
-    {
-        // ACES Filmic Tone Mapping
-        color = aces(color);
-    }
-    else if(toneMapping == 5)
-    {
-        // Lottes Tone Mapping
-        color = lottes(color);
-    }
-    else if(toneMapping == 6)
-    {
-        // Uchimura Tone Mapping
-        color = uchimura(color);
-    }
-    else if(toneMapping == 7)
-    {
-        // Uncharted 2 Tone Mapping
-        color = uncharted2(color);
-    }
-    else if(toneMapping == 8)
-    {
-        // Unreal Tone Mapping
-        color = unreal(color);
-    }
+    //Tone Map With A Single Fetch From The Baked Table.
+    color = toneMap(color);
 
     FragColor = vec4(color, 1.0f);
 }  
\ No newline at end of file
@@ -3,7 +3,10 @@ out vec4 FragColor;
 in vec3 WorldPos;
 
 uniform samplerCube environmentMap;
+uniform float environmentResolution; // resolution of source cubemap (per face)
 uniform float roughness;
+uniform int mip;
+uniform uint sampleCounts[8]; // GGX samples per texel of each prefilter mip, from PrefilterSampleCounts()
 
 const float PI = 3.14159265359;
 // ----------------------------------------------------------------------------
@@ -69,7 +72,7 @@ void main()
     vec3 R = N;
     vec3 V = R;
 
-    const uint SAMPLE_COUNT = 1024u;
+    uint SAMPLE_COUNT = sampleCounts[mip];
     vec3 prefilteredColor = vec3(0.0);
     float totalWeight = 0.0;
     
@@ -89,8 +92,8 @@ void main()
             float HdotV = max(dot(H, V), 0.0);
             float pdf = D * NdotH / (4.0 * HdotV) + 0.0001; 
 
-            float resolution = 512.0; // resolution of source cubemap (per face)
-            float saTexel  = 4.0 * PI / (6.0 * resolution * resolution);
+            // filtered importance sampling: read the mip whose texels cover the solid angle of one sample.
+            float saTexel  = 4.0 * PI / (6.0 * environmentResolution * environmentResolution);
             float saSample = 1.0 / (float(SAMPLE_COUNT) * pdf + 0.0001);
 
             float mipLevel = roughness == 0.0 ? 0.0 : 0.5 * log2(saSample / saTexel); 
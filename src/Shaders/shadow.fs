@@ -1,16 +1,7 @@
 #version 420 core
-in vec4 FragPos;
-
-uniform vec3 lightPos;
-uniform float far_plane;
 
+// Depth only: the hardware depth of the face projection is stored as is, so early depth testing stays on.
+// deferredLighting.fs & shadowFilter.fs turn it back into linear depth with the light's near & far planes.
 void main()
 {
-    float lightDistance = length(FragPos.xyz - lightPos);
-    
-    // map to [0;1] range by dividing by far_plane
-    lightDistance = lightDistance / far_plane;
-    
-    // write this as modified depth
-    gl_FragDepth = lightDistance;
 }
\ No newline at end of file
@@ -2,8 +2,9 @@
 layout(location = 0) in vec3 pos;
 
 uniform mat4 model;
+uniform mat4 shadowMatrix; // projection * view of the cubemap face being rendered.
 
 void main()
 {
-    gl_Position = model * vec4(pos, 1.0);
+    gl_Position = shadowMatrix * model * vec4(pos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#version 420 core
+layout (location = 0) out float FilteredDepth;
+
+// Prefilters one face of a point shadow cubemap for exponential shadow maps: a box filter of exp(exponent * depth), stored
+// as its log / exponent so it fits a 16-bit float. 'depth' is the linear view depth / far plane of the face, reconstructed from
+// the hardware depth the shadow pass stored. Taps are taken along the face's plane, ones past its edge land on the
+// neighbouring faces, so the filter is seamless.
+layout (binding = 0) uniform samplerCubeArray shadowDepth;
+
+uniform int cubemap;
+uniform int face;
+uniform float faceSize;
+uniform float exponent;
+uniform float nearPlane;
+uniform float farPlane;
+
+#define FILTER_RADIUS 2
+
+// Direction of face coordinates 'uv' in [-1;1] (GL cubemap face layout).
+vec3 FaceDirection(vec2 uv)
+{
+    if(face == 0) return vec3( 1.0, -uv.y, -uv.x);
+    if(face == 1) return vec3(-1.0, -uv.y,  uv.x);
+    if(face == 2) return vec3( uv.x,  1.0,  uv.y);
+    if(face == 3) return vec3( uv.x, -1.0, -uv.y);
+    if(face == 4) return vec3( uv.x, -uv.y,  1.0);
+    return vec3(-uv.x, -uv.y, -1.0);
+}
+
+// Linear view depth / far plane of the stored hardware depth, inverting the face projection.
+float LinearDepth(float depth)
+{
+    float ndc = depth * 2.0 - 1.0;
+    return 2.0 * nearPlane / ((farPlane + nearPlane) - ndc * (farPlane - nearPlane));
+}
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / faceSize * 2.0 - 1.0;
+    float texel = 2.0 / faceSize;
+
+    float depths[(2 * FILTER_RADIUS + 1) * (2 * FILTER_RADIUS + 1)];
+    float maxDepth = 0.0;
+    int tap = 0;
+    for(int y = -FILTER_RADIUS; y <= FILTER_RADIUS; ++y)
+    {
+        for(int x = -FILTER_RADIUS; x <= FILTER_RADIUS; ++x)
+        {
+            depths[tap] = LinearDepth(texture(shadowDepth, vec4(FaceDirection(uv + vec2(x, y) * texel), cubemap)).r);
+            maxDepth = max(maxDepth, depths[tap++]);
+        }
+    }
+
+    // relative to the largest depth so no exponential overflows.
+    float sum = 0.0;
+    for(int i = 0; i < tap; ++i)
+        sum += exp(exponent * (depths[i] - maxDepth));
+    FilteredDepth = maxDepth + log(sum / float(tap)) / exponent;
+}
@@ -3,11 +3,18 @@
 in vec3 TexCoord;
 out vec4 FragmentColor;
 
-uniform samplerCube skybox;
+layout (binding = 0) uniform samplerCube skybox;
+//Environment Faded Out While A Newly Baked One Fades In.
+layout (binding = 1) uniform samplerCube previousSkybox;
+uniform float environmentBlend;
+uniform float environmentIntensity;
 
 void main()
 {
     vec3 envColor = texture(skybox, TexCoord).rgb;
+    if (environmentBlend < 1.0)
+        envColor = mix(texture(previousSkybox, TexCoord).rgb, envColor, environmentBlend);
+    envColor *= environmentIntensity;
 
     // Gamma Correction
     envColor = pow(envColor, vec3(1.0/2.2));
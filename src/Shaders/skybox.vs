@@ -4,11 +4,12 @@ layout(location = 0) in vec3 pos;
 out vec3 TexCoord;
 
 uniform mat4 viewProjection;
+uniform mat3 environmentRotation;
 
 void main()
 {
     //TexCoord = vec3(pos.x, -pos.y, pos.z);
-    TexCoord = pos;
+    TexCoord = environmentRotation * pos;
     vec4 position = viewProjection * vec4(pos, 1.0);
     gl_Position = position.xyww;
 }
\ No newline at end of file
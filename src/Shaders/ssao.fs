@@ -3,58 +3,84 @@ out float FragColor;
 
 in vec2 TexCoord;
 
-uniform sampler2D gPosition;
-uniform sampler2D gLinearDepth;
-uniform sampler2D gNormal;
+// one 2x2 deinterleaved quarter resolution layer of the half resolution linear depth & view space normals (see ssaoDownsample.fs),
+// every tap reads the same layer.
+uniform sampler2DArray linearDepth;
+uniform sampler2DArray viewNormal;
 uniform sampler2D texNoise;
+uniform int layer;
 
 uniform vec3 samples[16];
 
+// samples per frame, every (16 / kernelSize)th from kernelOffset, & a rotation of the noise in turns. With temporal
+// accumulation a frame takes part of the kernel & the rotation changes every frame.
+uniform int kernelSize = 16;
+uniform int kernelOffset = 0;
+uniform float rotation = 0.0;
+
 // parameters (you'd probably want to use them as uniforms to more easily tweak the effect)
-int kernelSize = 16;
 uniform float radius = 0.1;
 uniform float bias = 0.01;
 uniform float strength = 4.0f;
 
-// tile noise texture over screen based on screen dimensions divided by noise size
-uniform vec2 noiseScale = vec2(1280.0/4.0, 720.0/4.0);
-
-uniform mat4 view;
 uniform mat4 projection;
+uniform vec2 fullResolution;
+
+// half resolution pixel offset of the layer's texels.
+ivec2 LayerOffset()
+{
+    return ivec2(layer & 1, layer >> 1);
+}
+
+// view space position of the surface at 'uv' with linear depth 'depth'.
+vec3 ViewPosition(vec2 uv, float depth)
+{
+    return vec3((uv * 2.0 - 1.0) / vec2(projection[0][0], projection[1][1]) * depth, -depth);
+}
 
 void main()
 {
-    // get input for SSAO algorithm
-    vec3 fragPos = texture(gPosition, TexCoord).xyz;
-    vec3 normal = vec3(normalize(view * vec4(texture(gNormal, TexCoord).rgb, 0.0f)));
-    vec3 randomVec = normalize(texture(texNoise, TexCoord * noiseScale).xyz);
+    // get input for SSAO algorithm, in view space
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    ivec2 halfPixel = 2 * texel + LayerOffset();
+    vec2 uv = (vec2(halfPixel) * 2.0 + 1.0) / fullResolution;
+    float depth = texelFetch(linearDepth, ivec3(texel, layer), 0).r;
+    vec3 fragPos = ViewPosition(uv, depth);
+    vec3 normal = normalize(texelFetch(viewNormal, ivec3(texel, layer), 0).xyz);
+    // the 4x4 rotations tile the half resolution image.
+    vec3 randomVec = normalize(texelFetch(texNoise, halfPixel & 3, 0).xyz);
 
     // create TBN change-of-basis matrix: from tangent-space to view-space
     vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
     vec3 bitangent = cross(normal, tangent);
+    float angle = rotation * 6.28318531;
+    tangent = tangent * cos(angle) + bitangent * sin(angle);
+    bitangent = cross(normal, tangent);
     mat3 TBN = mat3(tangent, bitangent, normal);
 
     // iterate over the sample kernel and calculate occlusion factor
     float occlusion = 0.0;
-
-    float fragPosDepth = (view * vec4(fragPos, 1.0f)).z;
+    ivec2 maxTexel = textureSize(linearDepth, 0).xy - 1;
+    int kernelStride = 16 / kernelSize;
     for(int i = 0; i < kernelSize; ++i)
     {
         // project sample position (to sample texture) (to get position on screen/texture)
-        vec4 samplePos = view * vec4(fragPos + TBN * samples[i] * radius, 1.0f);
+        vec3 samplePos = fragPos + TBN * samples[i * kernelStride + kernelOffset] * radius;
 
-        vec4 offset = projection * samplePos; // from view to clip-space
-        offset.xyz /= offset.w; // perspective divide
-        offset.xyz = offset.xyz * 0.5 + 0.5; // transform to range 0.0 - 1.0
+        vec4 offset = projection * vec4(samplePos, 1.0); // from view to clip-space
+        offset.xy /= offset.w; // perspective divide
+        offset.xy = offset.xy * 0.5 + 0.5; // transform to range 0.0 - 1.0
 
-        // get depth value of kernel sample
-        float sampleDepth = (view * vec4(texture(gPosition, offset.xy).xyz, 1.0f)).z;
+        // linear depth of the layer's texel nearest to the sample
+        vec2 sampleHalfPixel = offset.xy * fullResolution * 0.5;
+        ivec2 sampleTexel = clamp(ivec2(floor((sampleHalfPixel - vec2(LayerOffset()) + 0.5) * 0.5)), ivec2(0), maxTexel);
+        float sampleDepth = texelFetch(linearDepth, ivec3(sampleTexel, layer), 0).r;
 
         // range check & accumulate
-        float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPosDepth - sampleDepth));
-        occlusion += (sampleDepth >= samplePos.z + bias ? 1.0 : 0.0) * rangeCheck;   
+        float rangeCheck = smoothstep(0.0, 1.0, radius / abs(depth - sampleDepth));
+        occlusion += (sampleDepth <= -samplePos.z - bias ? 1.0 : 0.0) * rangeCheck;
     }
     occlusion = 1.0 - (occlusion / kernelSize);
     
     FragColor = pow(occlusion, strength);
-}
\ No newline at end of file
+}
@@ -1,22 +1,132 @@
 #version 420 core
-out float FragColor;
+// Separable depth & normal aware bilateral blur of the half resolution occlusion, one tap fetch each besides the occlusion.
+//
+// Compile time feature DEINTERLEAVED_INPUT: the horizontal pass, reads the 2x2 deinterleaved occlusion of ssao.fs & the view normals
+// & depth of ssaoDownsample.fs & writes the blurred occlusion, depth & octahedral normal. Without it the vertical pass, reads that
+// & writes occlusion & depth.
+// Compile time feature BENT_NORMALS: also blurs the bent normals of gtao.fs, with the same weights.
+#ifdef DEINTERLEAVED_INPUT
+layout (location = 0) out vec4 FragColor;
+uniform sampler2DArray occlusion;
+uniform sampler2DArray viewNormal;
+#else
+layout (location = 0) out vec2 FragColor;
+uniform sampler2D occlusion;
+#endif
+
+#ifdef BENT_NORMALS
+layout (location = 1) out vec4 BlurredBentNormal;
+#ifdef DEINTERLEAVED_INPUT
+uniform sampler2DArray bentNormal;
+#else
+uniform sampler2D bentNormal;
+#endif
+#endif
 
 in vec2 TexCoord;
 
-uniform sampler2D ssaoInput;
+// taps on each side & the gaussian's standard deviation, in half resolution pixels.
+const int BLUR_RADIUS = 4;
+const float BLUR_SIGMA = 2.0;
+// a tap's weight falls linearly to 0 at this depth difference relative to the center's depth.
+const float DEPTH_FALLOFF = 0.1;
+
+vec2 OctahedronWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+vec2 EncodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return n.z >= 0.0 ? n.xy : OctahedronWrap(n.xy);
+}
+
+vec3 DecodeNormal(vec2 encoded)
+{
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
 
-void main() 
+// occlusion, view normal & linear depth of a half resolution pixel.
+void Tap(ivec2 pixel, out float ao, out vec3 normal, out float depth)
 {
-    //Blur SSAO 16 Times.
-    vec2 texelSize = 1.0 / vec2(textureSize(ssaoInput, 0));
-    float result = 0.0;
-    for (int x = -2; x < 2; ++x) 
+#ifdef DEINTERLEAVED_INPUT
+    ivec3 deinterleaved = ivec3(pixel >> 1, (pixel.x & 1) + 2 * (pixel.y & 1));
+    ao = texelFetch(occlusion, deinterleaved, 0).r;
+    vec4 normalDepth = texelFetch(viewNormal, deinterleaved, 0);
+    normal = normalDepth.xyz;
+    depth = normalDepth.w;
+#else
+    vec4 blurred = texelFetch(occlusion, pixel, 0);
+    ao = blurred.r;
+    depth = blurred.g;
+    normal = DecodeNormal(blurred.ba);
+#endif
+}
+
+#ifdef BENT_NORMALS
+vec3 BentNormalTap(ivec2 pixel)
+{
+#ifdef DEINTERLEAVED_INPUT
+    return texelFetch(bentNormal, ivec3(pixel >> 1, (pixel.x & 1) + 2 * (pixel.y & 1)), 0).xyz * 2.0 - 1.0;
+#else
+    return texelFetch(bentNormal, pixel, 0).xyz * 2.0 - 1.0;
+#endif
+}
+#endif
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+#ifdef DEINTERLEAVED_INPUT
+    ivec2 direction = ivec2(1, 0);
+    ivec2 maxPixel = textureSize(viewNormal, 0).xy * 2 - 1;
+#else
+    ivec2 direction = ivec2(0, 1);
+    ivec2 maxPixel = textureSize(occlusion, 0) - 1;
+#endif
+    float centerOcclusion, centerDepth;
+    vec3 centerNormal;
+    Tap(pixel, centerOcclusion, centerNormal, centerDepth);
+
+    float depthScale = 1.0 / (centerDepth * DEPTH_FALLOFF);
+
+    // gaussian weights scaled down across depth & normal discontinuities, so occlusion doesn't bleed over edges.
+    float result = centerOcclusion;
+    float weights = 1.0;
+#ifdef BENT_NORMALS
+    vec3 bentResult = BentNormalTap(pixel);
+#endif
+    for (int i = -BLUR_RADIUS; i <= BLUR_RADIUS; i++)
     {
-        for (int y = -2; y < 2; ++y) 
-        {
-            vec2 offset = vec2(float(x), float(y)) * texelSize;
-            result += texture(ssaoInput, TexCoord + offset).r;
-        }
+        if (i == 0)
+            continue;
+        float ao, depth;
+        vec3 normal;
+        ivec2 tapPixel = clamp(pixel + direction * i, ivec2(0), maxPixel);
+        Tap(tapPixel, ao, normal, depth);
+        // the cosine between the normals to the 8th.
+        float normalWeight = max(dot(normal, centerNormal), 0.0);
+        normalWeight *= normalWeight;
+        normalWeight *= normalWeight;
+        normalWeight *= normalWeight;
+        float weight = exp(-float(i * i) / (2.0 * BLUR_SIGMA * BLUR_SIGMA));
+        weight *= max(1.0 - abs(depth - centerDepth) * depthScale, 0.0) * normalWeight;
+        result += ao * weight;
+        weights += weight;
+#ifdef BENT_NORMALS
+        bentResult += BentNormalTap(tapPixel) * weight;
+#endif
     }
-    FragColor = result / (4.0 * 4.0);
-}  
\ No newline at end of file
+#ifdef DEINTERLEAVED_INPUT
+    FragColor = vec4(result / weights, centerDepth, EncodeNormal(centerNormal));
+#else
+    FragColor = vec2(result / weights, centerDepth);
+#endif
+#ifdef BENT_NORMALS
+    BlurredBentNormal = vec4(normalize(bentResult) * 0.5 + 0.5, 1.0);
+#endif
+}
@@ -0,0 +1,27 @@
+#version 420 core
+// One level of the hierarchical linear depth the horizon based occlusion (gtao.fs) searches: level 0 puts the deinterleaved half
+// resolution depth of ssaoDownsample.fs back together, every other level keeps the closest of 2x2 texels of the level before.
+out float LinearDepth;
+
+in vec2 TexCoord;
+
+uniform sampler2DArray deinterleavedDepth;
+// the pyramid with only the level before this one in its base to max level range.
+uniform sampler2D previousLevel;
+uniform int level;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    if (level == 0)
+    {
+        LinearDepth = texelFetch(deinterleavedDepth, ivec3(pixel >> 1, (pixel.x & 1) + 2 * (pixel.y & 1)), 0).r;
+        return;
+    }
+
+    ivec2 maxTexel = textureSize(previousLevel, 0) - 1;
+    float closest = texelFetch(previousLevel, min(2 * pixel, maxTexel), 0).r;
+    for (int i = 1; i < 4; i++)
+        closest = min(closest, texelFetch(previousLevel, min(2 * pixel + ivec2(i & 1, i >> 1), maxTexel), 0).r);
+    LinearDepth = closest;
+}
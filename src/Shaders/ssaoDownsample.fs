@@ -0,0 +1,56 @@
+#version 420 core
+// Half resolution linear depth & view space normals (depth in alpha, for the blur) for the SSAO, deinterleaved: layer (x & 1) + 2 (y & 1) of the quarter
+// resolution arrays holds the half resolution pixels with that parity. Each half resolution pixel takes the closest of its
+// 2x2 full resolution pixels.
+layout (location = 0) out float LinearDepth[4];
+layout (location = 4) out vec4 ViewNormal[4];
+
+in vec2 TexCoord;
+
+uniform sampler2D gDepth;
+uniform sampler2D gNormal;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// inverse of the octahedral normal encoding of the geometry pass.
+vec3 DecodeNormal(vec2 encoded)
+{
+    encoded = encoded * 2.0 - 1.0;
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// distance along the view direction, inverting the perspective projection of the depth.
+float LinearizeDepth(float depth)
+{
+    return projection[3][2] / (depth * 2.0 - 1.0 + projection[2][2]);
+}
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    ivec2 maxPixel = textureSize(gDepth, 0) - 1;
+    for (int layer = 0; layer < 4; layer++)
+    {
+        ivec2 halfPixel = 2 * texel + ivec2(layer & 1, layer >> 1);
+
+        ivec2 closest = min(2 * halfPixel, maxPixel);
+        float closestDepth = texelFetch(gDepth, closest, 0).r;
+        for (int i = 1; i < 4; i++)
+        {
+            ivec2 pixel = min(2 * halfPixel + ivec2(i & 1, i >> 1), maxPixel);
+            float depth = texelFetch(gDepth, pixel, 0).r;
+            if (depth < closestDepth)
+            {
+                closestDepth = depth;
+                closest = pixel;
+            }
+        }
+
+        LinearDepth[layer] = LinearizeDepth(closestDepth);
+        ViewNormal[layer] = vec4(normalize(mat3(view) * DecodeNormal(texelFetch(gNormal, closest, 0).rg)), LinearDepth[layer]);
+    }
+}
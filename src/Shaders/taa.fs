@@ -0,0 +1,117 @@
+#version 420 core
+// Temporal anti-aliasing resolve: blends the current, jittered frame into the history reprojected by the camera's motion, after
+// clipping the history to the current frame's 3x3 neighbourhood.
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D currentColor;
+uniform sampler2D currentDepth;
+uniform sampler2D history;
+
+// this frame's clip space to the last frame's, both unjittered.
+uniform mat4 reprojection;
+// weight of the history, 0 takes the current frame as is.
+uniform float feedback = 0.9;
+
+// standard deviations around the neighbourhood's mean the history is clipped to, within the neighbourhood's bounds.
+const float VARIANCE_CLIP_GAMMA = 1.25;
+
+// the neighbourhood box fits the colors tighter in YCoCg than in RGB, luma on its own axis.
+vec3 RGBToYCoCg(vec3 c)
+{
+    return vec3(dot(c, vec3(0.25, 0.5, 0.25)), dot(c, vec3(0.5, 0.0, -0.5)), dot(c, vec3(-0.25, 0.5, -0.25)));
+}
+
+vec3 YCoCgToRGB(vec3 c)
+{
+    return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+// Moves 'history' towards the box's center until it's inside the box (Playdead, INSIDE TAA), keeping its hue where clamping each
+// axis wouldn't.
+vec3 ClipToBox(vec3 history, vec3 boxMin, vec3 boxMax)
+{
+    vec3 center = 0.5 * (boxMax + boxMin);
+    vec3 extents = 0.5 * (boxMax - boxMin) + 1e-5;
+    vec3 offset = history - center;
+    vec3 units = abs(offset / extents);
+    float maxUnit = max(units.x, max(units.y, units.z));
+    return maxUnit > 1.0 ? center + offset / maxUnit : history;
+}
+
+// Catmull-Rom filtered history from 5 bilinear fetches of the 4x4 texels around 'uv' (the corner ones are dropped, they weigh
+// little), bilinear filtering alone would soften the history a little more every frame the camera moves.
+vec3 SampleHistory(vec2 uv)
+{
+    vec2 size = vec2(textureSize(history, 0));
+    vec2 position = uv * size;
+    vec2 center = floor(position - 0.5) + 0.5;
+    vec2 f = position - center;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+    // the middle two texels of each axis in one bilinear fetch.
+    vec2 w12 = w1 + w2;
+    vec2 uv0 = (center - 1.0) / size;
+    vec2 uv12 = (center + w2 / w12) / size;
+    vec2 uv3 = (center + 2.0) / size;
+
+    vec3 result = texture(history, vec2(uv12.x, uv0.y)).rgb * w12.x * w0.y;
+    result += texture(history, vec2(uv0.x, uv12.y)).rgb * w0.x * w12.y;
+    result += texture(history, uv12).rgb * w12.x * w12.y;
+    result += texture(history, vec2(uv3.x, uv12.y)).rgb * w3.x * w12.y;
+    result += texture(history, vec2(uv12.x, uv3.y)).rgb * w12.x * w3.y;
+    float weight = w12.x * w0.y + w0.x * w12.y + w12.x * w12.y + w3.x * w12.y + w12.x * w3.y;
+    return max(result / weight, vec3(0.0));
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 maxPixel = textureSize(currentColor, 0) - 1;
+
+    // the neighbourhood's color moments & its closest depth, so the edges of foreground objects reproject with them.
+    vec3 current = vec3(0.0);
+    vec3 mean = vec3(0.0);
+    vec3 meanSquared = vec3(0.0);
+    vec3 boxMin = vec3(1e9);
+    vec3 boxMax = vec3(-1e9);
+    float depth = 1.0;
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            ivec2 neighbour = clamp(pixel + ivec2(x, y), ivec2(0), maxPixel);
+            vec3 color = RGBToYCoCg(max(texelFetch(currentColor, neighbour, 0).rgb, vec3(0.0)));
+            if (x == 0 && y == 0)
+                current = color;
+            mean += color;
+            meanSquared += color * color;
+            boxMin = min(boxMin, color);
+            boxMax = max(boxMax, color);
+            depth = min(depth, texelFetch(currentDepth, neighbour, 0).r);
+        }
+    }
+    mean /= 9.0;
+    vec3 deviation = sqrt(max(meanSquared / 9.0 - mean * mean, vec3(0.0)));
+    boxMin = max(boxMin, mean - VARIANCE_CLIP_GAMMA * deviation);
+    boxMax = min(boxMax, mean + VARIANCE_CLIP_GAMMA * deviation);
+
+    // where the surface was last frame, off screen there's no history.
+    vec4 previousClip = reprojection * vec4(TexCoord * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec2 previousUV = previousClip.xy / previousClip.w * 0.5 + 0.5;
+    float historyWeight = all(greaterThanEqual(previousUV, vec2(0.0))) && all(lessThanEqual(previousUV, vec2(1.0))) ? feedback : 0.0;
+
+    // without history the texture isn't read at all, it may not hold anything yet.
+    vec3 previous = historyWeight > 0.0 ? ClipToBox(RGBToYCoCg(SampleHistory(previousUV)), boxMin, boxMax) : current;
+
+    // weighted by 1 / (1 + luma) (Karis 2014), so a sample far brighter than its neighbours doesn't flicker through the average.
+    float currentWeight = (1.0 - historyWeight) / (1.0 + current.x);
+    historyWeight /= 1.0 + previous.x;
+    vec3 result = (current * currentWeight + previous * historyWeight) / (currentWeight + historyWeight);
+
+    FragColor = vec4(max(YCoCgToRGB(result), vec3(0.0)), 1.0);
+}
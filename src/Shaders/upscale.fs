@@ -0,0 +1,60 @@
+#version 420 core
+// Upscales the post processed image from the render resolution to the window's & sharpens it, AMD FidelityFX CAS's scaling mode:
+// each of the 2x2 texels around the pixel is sharpened against its 4 direct neighbours, backing off where the neighbourhood is
+// close to black or white so edges don't ring or clip, & the 4 are blended bilinearly. 12 fetches cover all of them.
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// display encoded, read with texelFetch.
+uniform sampler2D image;
+// 0 sharpens the least, 1 the most.
+uniform float sharpness = 0.5;
+
+ivec2 maxTexel;
+
+vec3 Fetch(ivec2 texel)
+{
+    return texelFetch(image, clamp(texel, ivec2(0), maxTexel), 0).rgb;
+}
+
+// 'center' sharpened against its cross of neighbours.
+vec3 Sharpen(vec3 center, vec3 up, vec3 left, vec3 right, vec3 down)
+{
+    vec3 minimum = min(center, min(min(up, down), min(left, right)));
+    vec3 maximum = max(center, max(max(up, down), max(left, right)));
+    // how much room the neighbourhood leaves before black or white, relative to its brightest.
+    vec3 amount = sqrt(clamp(min(minimum, 1.0 - maximum) / max(maximum, vec3(1e-4)), 0.0, 1.0));
+    vec3 weight = -amount / mix(8.0, 5.0, sharpness);
+    return clamp((center + (up + left + right + down) * weight) / (1.0 + 4.0 * weight), 0.0, 1.0);
+}
+
+void main()
+{
+    vec2 size = vec2(textureSize(image, 0));
+    maxTexel = ivec2(size) - 1;
+    vec2 position = TexCoord * size - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 f = position - floor(position);
+
+    //      b c
+    //    e f g h
+    //    i j k l
+    //      n o
+    vec3 b = Fetch(base + ivec2(0, -1));
+    vec3 c = Fetch(base + ivec2(1, -1));
+    vec3 e = Fetch(base + ivec2(-1, 0));
+    vec3 fc = Fetch(base);
+    vec3 g = Fetch(base + ivec2(1, 0));
+    vec3 h = Fetch(base + ivec2(2, 0));
+    vec3 i = Fetch(base + ivec2(-1, 1));
+    vec3 j = Fetch(base + ivec2(0, 1));
+    vec3 k = Fetch(base + ivec2(1, 1));
+    vec3 l = Fetch(base + ivec2(2, 1));
+    vec3 n = Fetch(base + ivec2(0, 2));
+    vec3 o = Fetch(base + ivec2(1, 2));
+
+    vec3 top = mix(Sharpen(fc, b, e, g, j), Sharpen(g, c, fc, h, k), f.x);
+    vec3 bottom = mix(Sharpen(j, fc, i, k, n), Sharpen(k, g, j, l, o), f.x);
+    FragColor = vec4(mix(top, bottom, f.y), 1.0);
+}
@@ -0,0 +1,250 @@
+// Headless IBL baker: bakes HDR environments on the CPU into the cache files the runtime loads, so asset pipelines and
+// build machines without a GPU can ship pre-baked maps.
+//
+// Usage: IBLBake [options] <environment.hdr>...
+//   --output <directory>   cache directory (defaults to the runtime's cache directory).
+//   --no-irradiance        skip the irradiance map, the runtime uses spherical harmonics instead.
+//   --brdf                 also bake the BRDF LUT.
+//   --threads <count>      worker threads (defaults to all cores).
+//   --compare              don't write anything, compare the CPU bake with the existing (GPU baked) cache files instead.
+//   --prefilter-error      don't write anything, measure the prefilter map's sample schedule against the brute force bake
+//                          (PREFILTER_BRUTE_FORCE_SAMPLES samples at every roughness), per mip.
+//   --tolerance <value>    largest mean relative error --compare & --prefilter-error accept (default 0.01).
+#define STB_IMAGE_IMPLEMENTATION
+#include "../../vendor/stb/stb_image.h"
+
+#include "../Scripts/IBLBakerCPU.h"
+#include "../Scripts/IBLCache.h"
+#include "../Scripts/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const char* MAP_NAMES[] = { "environment", "irradiance", "prefilter" };
+
+	struct Options
+	{
+		std::string outputDirectory = PROJECT_DIR"/src/Assets/EnvironmentMaps/Cache";
+		bool withIrradiance = true;
+		bool brdf = false;
+		bool compare = false;
+		bool prefilterError = false;
+		unsigned int threads = std::max(std::thread::hardware_concurrency(), 1u);
+		double tolerance = 0.01;
+		std::vector<std::string> inputs;
+	};
+
+	void PrintUsage()
+	{
+		std::cout << "Usage: IBLBake [--output <directory>] [--no-irradiance] [--brdf] [--threads <count>] [--compare] [--prefilter-error] [--tolerance <value>] <environment.hdr>..." << std::endl;
+	}
+
+	bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::string argument = argv[i];
+			bool hasValue = i + 1 < argc;
+			if (argument == "--output" && hasValue)
+				options.outputDirectory = argv[++i];
+			else if (argument == "--no-irradiance")
+				options.withIrradiance = false;
+			else if (argument == "--brdf")
+				options.brdf = true;
+			else if (argument == "--compare")
+				options.compare = true;
+			else if (argument == "--prefilter-error")
+				options.prefilterError = true;
+			else if (argument == "--threads" && hasValue)
+				options.threads = std::max(std::atoi(argv[++i]), 1);
+			else if (argument == "--tolerance" && hasValue)
+				options.tolerance = std::atof(argv[++i]);
+			else if (argument.compare(0, 2, "--") == 0)
+				return false;
+			else
+				options.inputs.push_back(argument);
+		}
+		return !options.inputs.empty() || options.brdf;
+	}
+
+	double Milliseconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Mean & max of |cpu - gpu| / (|gpu| + 0.01) over a range of half floats. The offset keeps near black texels from dominating.
+	struct Difference
+	{
+		double sum = 0.0;
+		double max = 0.0;
+		size_t count = 0;
+
+		void Add(const uint16_t* cpu, const uint16_t* gpu, size_t values)
+		{
+			for (size_t i = 0; i < values; i++)
+			{
+				float reference = HalfToFloat(gpu[i]);
+				double error = std::fabs(HalfToFloat(cpu[i]) - reference) / (std::fabs(reference) + 0.01);
+				sum += error;
+				max = std::max(max, error);
+			}
+			count += values;
+		}
+		double Mean() const { return count ? sum / count : 0.0; }
+	};
+
+	bool Report(const char* name, const Difference& difference, double tolerance)
+	{
+		bool passed = difference.Mean() <= tolerance;
+		std::cout << "  " << name << ": mean relative error " << difference.Mean() << ", max " << difference.max << (passed ? "" : "  FAILED") << std::endl;
+		return passed;
+	}
+
+	// Bakes the prefilter map with the sample schedule & by brute force from the same environment, returns false if they differ by
+	// more than the tolerance.
+	bool MeasurePrefilterError(const EquirectangularImage& source, const Options& options, const IBLBakeSettings& settings, ThreadPool& pool)
+	{
+		CubemapImage environment = BakeEnvironmentCubemap(source, settings, pool);
+
+		std::vector<uint32_t> sampleCounts = PrefilterSampleCounts(settings);
+		CubemapImage scheduled(settings.prefilterSize, settings.prefilterMipLevels);
+		auto start = std::chrono::steady_clock::now();
+		PrefilterGGX(environment, scheduled, sampleCounts, pool);
+		double scheduledMilliseconds = Milliseconds(start);
+
+		CubemapImage bruteForce(settings.prefilterSize, settings.prefilterMipLevels);
+		start = std::chrono::steady_clock::now();
+		PrefilterGGX(environment, bruteForce, std::vector<uint32_t>(settings.prefilterMipLevels, PREFILTER_BRUTE_FORCE_SAMPLES), pool);
+		double bruteForceMilliseconds = Milliseconds(start);
+
+		std::cout << "  prefilter: " << scheduledMilliseconds << " ms, brute force " << bruteForceMilliseconds << " ms" << std::endl;
+		bool passed = true;
+		for (unsigned int mip = 0; mip < settings.prefilterMipLevels; mip++)
+		{
+			// compared at half float precision, like the maps end up in the cache.
+			size_t values = (size_t)scheduled.Size(mip) * scheduled.Size(mip) * 3;
+			Difference difference;
+			for (unsigned int face = 0; face < 6; face++)
+			{
+				std::vector<uint16_t> scheduledHalfs(values), bruteForceHalfs(values);
+				FloatsToHalfs(scheduled.Face(face, mip), scheduledHalfs.data(), values);
+				FloatsToHalfs(bruteForce.Face(face, mip), bruteForceHalfs.data(), values);
+				difference.Add(scheduledHalfs.data(), bruteForceHalfs.data(), values);
+			}
+			std::string name = "mip " + std::to_string(mip) + " (" + std::to_string(sampleCounts[mip]) + " samples)";
+			passed = Report(name.c_str(), difference, options.tolerance) && passed;
+		}
+		return passed;
+	}
+
+	// Returns false if baking failed or, with --compare, if the bake doesn't match the cache file.
+	bool BakeEnvironment(const std::string& path, const Options& options, const IBLBakeSettings& settings, ThreadPool& pool)
+	{
+		auto start = std::chrono::steady_clock::now();
+		int width, height, channels;
+		float* pixels = stbi_loadf(path.c_str(), &width, &height, &channels, 0);
+		if (!pixels || channels < 3)
+		{
+			std::cout << "Failed to load HDR image " << path << std::endl;
+			stbi_image_free(pixels);
+			return false;
+		}
+
+		if (options.prefilterError)
+		{
+			std::cout << path << ":" << std::endl;
+			bool passed = MeasurePrefilterError({ pixels, width, height, channels }, options, settings, pool);
+			stbi_image_free(pixels);
+			return passed;
+		}
+
+		std::vector<uint16_t> data = BakeIBLCPU({ pixels, width, height, channels }, settings, options.withIrradiance, pool);
+		stbi_image_free(pixels);
+		std::cout << path << ": baked in " << Milliseconds(start) << " ms" << std::endl;
+
+		uint64_t key = IBLCacheKey(path.c_str(), settings);
+		std::string cachePath = IBLCachePath(options.outputDirectory, key);
+		if (!options.compare)
+			return WriteIBLCacheFile(cachePath, key, settings, data.data(), data.size(), options.withIrradiance);
+
+		std::vector<uint16_t> reference;
+		bool referenceIrradiance = false;
+		if (!ReadIBLCacheFile(cachePath, key, settings, reference, referenceIrradiance))
+		{
+			std::cout << "  no cache file to compare with at " << cachePath << std::endl;
+			return false;
+		}
+
+		// compare the maps both bakes have, the reference may have been stored with or without irradiance.
+		std::vector<IBLCacheLevel> layout = IBLCacheLayout(settings, options.withIrradiance);
+		std::vector<IBLCacheLevel> referenceLayout = IBLCacheLayout(settings, referenceIrradiance);
+		Difference differences[3];
+		for (const IBLCacheLevel& level : layout)
+		{
+			for (const IBLCacheLevel& referenceLevel : referenceLayout)
+			{
+				if (referenceLevel.map == level.map && referenceLevel.face == level.face && referenceLevel.mip == level.mip)
+					differences[level.map].Add(data.data() + level.offset, reference.data() + referenceLevel.offset, (size_t)level.size * level.size * 3);
+			}
+		}
+
+		bool passed = true;
+		for (int map = 0; map < 3; map++)
+			if (differences[map].count)
+				passed = Report(MAP_NAMES[map], differences[map], options.tolerance) && passed;
+		return passed;
+	}
+
+	bool BakeBRDFLUT(const Options& options, const IBLBakeSettings& settings, ThreadPool& pool)
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::vector<uint16_t> data = FloatsToHalfs(IntegrateBRDFLUT(settings.brdfLUTSize, pool));
+		std::cout << "BRDF LUT: baked in " << Milliseconds(start) << " ms" << std::endl;
+
+		std::string path = BRDFLUTCachePath(options.outputDirectory, settings);
+		if (!options.compare)
+			return WriteBRDFLUTCacheFile(path, settings, data.data(), data.size());
+
+		std::vector<uint16_t> reference;
+		if (!ReadBRDFLUTCacheFile(path, settings, reference))
+		{
+			std::cout << "  no BRDF LUT to compare with at " << path << std::endl;
+			return false;
+		}
+		Difference difference;
+		difference.Add(data.data(), reference.data(), data.size());
+		return Report("BRDF LUT", difference, options.tolerance);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// same orientation as the runtime's LoadHDRTexture.
+	stbi_set_flip_vertically_on_load(true);
+
+	// the calling thread works too.
+	ThreadPool pool(options.threads - 1);
+	const IBLBakeSettings settings;
+
+	bool succeeded = true;
+	if (options.brdf)
+		succeeded = BakeBRDFLUT(options, settings, pool) && succeeded;
+	for (const std::string& input : options.inputs)
+		succeeded = BakeEnvironment(input, options, settings, pool) && succeeded;
+	return succeeded ? 0 : 1;
+}